@@ -0,0 +1,390 @@
+#include "CollisionDetector.hpp"
+#include "Ensemble.hpp"
+#include "ForceSolver.hpp"
+#include "GridMesh.hpp"
+#include "GridWarp.hpp"
+#include "Integrator.hpp"
+#include "Precision.hpp"
+#include "Scenarios.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Times the physics and grid hot paths over a sweep of body counts and
+// thread counts. Every case runs once to warm up, then repeats until
+// --min-time has passed; a benchmark stops growing N once a single run takes
+// longer than --max-time, so the O(N^2) paths do not stall the sweep.
+
+namespace {
+    struct Result {
+        std::string name;
+        size_t n = 0;
+        size_t threads = 0;
+        size_t iterations = 0;
+        double seconds = 0.0;     // per iteration
+        double perItem = 0.0;     // ns per body, vertex or source
+        double perPair = 0.0;     // ns per pairwise interaction, 0 if not meaningful
+        std::string unit;         // what perItem counts
+    };
+
+    struct Options {
+        size_t maxN = 1000000;
+        std::vector<size_t> threads;
+        std::string filter;
+        double minTime = 0.2;
+        double maxTime = 5.0;
+        std::string jsonPath;
+    };
+
+    // Accelerations stay zero, so integrator benchmarks time only the
+    // integrator's own loops.
+    class NullSolver : public ForceSolver {
+    public:
+        const char* name() const override { return "null"; }
+        void computeAccelerations(BodySystem& bodies, ThreadPool&) override {
+            std::fill(bodies.ax.begin(), bodies.ax.end(), 0.0f);
+            std::fill(bodies.ay.begin(), bodies.ay.end(), 0.0f);
+            std::fill(bodies.az.begin(), bodies.az.end(), 0.0f);
+        }
+    };
+
+    // One case: set up for (n, pool) once, then return the function to time.
+    struct Benchmark {
+        std::string name;
+        bool parallel;             // sweep thread counts, or run single-threaded only
+        const char* unit;
+        bool pairwise;             // also report ns per unordered pair
+        std::function<std::function<void()>(size_t n, ThreadPool& pool)> prepare;
+    };
+
+    double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    void makeBodies(size_t n, BodySystem& bodies, ThreadPool& pool) {
+        ScenarioConfig config;
+        config.name = "plummer";
+        config.bodyCount = n;
+        config.seed = 2024;
+        Scenarios::generate(config, bodies, pool);
+    }
+
+    // Scalar one-sided direct sum under one precision policy.
+    template <class Policy>
+    Benchmark precisionBenchmark() {
+        return { std::string("force/precision-") + Policy::name(), true, "body", true,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                auto bodies = std::make_shared<BodySystem>();
+                makeBodies(n, *bodies, pool);
+                typedef AlignedVector<typename Policy::Position> Positions;
+                auto x = std::make_shared<Positions>(bodies->x.begin(), bodies->x.end());
+                auto y = std::make_shared<Positions>(bodies->y.begin(), bodies->y.end());
+                auto z = std::make_shared<Positions>(bodies->z.begin(), bodies->z.end());
+                return [bodies, x, y, z, &pool]() {
+                    const size_t count = bodies->size();
+                    pool.parallelFor((count + 63) / 64, [&](size_t chunk, size_t) {
+                        PrecisionKernels::accumulateRows<Policy>(x->data(), y->data(), z->data(), bodies->mass.data(), count,
+                                                                 chunk * 64, std::min(count, (chunk + 1) * 64),
+                                                                 bodies->ax.data(), bodies->ay.data(), bodies->az.data());
+                    });
+                };
+            } };
+    }
+
+    std::vector<Benchmark> benchmarks() {
+        std::vector<Benchmark> list;
+
+        const char* solvers[] = { "direct", "barnes-hut", "fmm" };
+        for (const char* solverName : solvers) {
+            bool direct = std::strcmp(solverName, "direct") == 0;
+            list.push_back({ std::string("force/") + solverName, true, "body", direct,
+                [solverName](size_t n, ThreadPool& pool) -> std::function<void()> {
+                    auto bodies = std::make_shared<BodySystem>();
+                    makeBodies(n, *bodies, pool);
+                    SolverConfig config;
+                    config.name = solverName;
+                    std::shared_ptr<ForceSolver> solver(createForceSolver(config).release());
+                    return [bodies, solver, &pool]() { solver->computeAccelerations(*bodies, pool); };
+                } });
+        }
+
+        // Direct sum under each softening law, eps of one unit.
+        const char* laws[] = { "plummer", "spline" };
+        for (const char* law : laws) {
+            list.push_back({ std::string("force/direct-") + law, true, "body", true,
+                [law](size_t n, ThreadPool& pool) -> std::function<void()> {
+                    auto bodies = std::make_shared<BodySystem>();
+                    makeBodies(n, *bodies, pool);
+                    SolverConfig config;
+                    config.softening = law;
+                    config.softeningLength = 1.0f;
+                    std::shared_ptr<ForceSolver> solver(createForceSolver(config).release());
+                    return [bodies, solver, &pool]() { solver->computeAccelerations(*bodies, pool); };
+                } });
+        }
+
+        list.push_back(precisionBenchmark<FloatPrecision>());
+        list.push_back(precisionBenchmark<DoublePrecision>());
+        list.push_back(precisionBenchmark<KahanPrecision>());
+        list.push_back(precisionBenchmark<MixedPrecision>());
+
+        list.push_back({ "collisions", true, "body", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                auto bodies = std::make_shared<BodySystem>();
+                makeBodies(n, *bodies, pool);
+                auto detector = std::make_shared<CollisionDetector>();
+                auto contacts = std::make_shared<std::vector<ContactPair>>();
+                return [bodies, detector, contacts, &pool]() { detector->findContacts(*bodies, pool, *contacts); };
+            } });
+
+        // Continuous test over one frame of motion.
+        list.push_back({ "collisions/swept", true, "body", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                auto bodies = std::make_shared<BodySystem>();
+                makeBodies(n, *bodies, pool);
+                auto start = std::make_shared<std::vector<float>>(3 * n);
+                for (size_t i = 0; i < n; ++i) {
+                    (*start)[i] = bodies->x[i] - bodies->vx[i] * Constants::TIME_STEP;
+                    (*start)[n + i] = bodies->y[i] - bodies->vy[i] * Constants::TIME_STEP;
+                    (*start)[2 * n + i] = bodies->z[i] - bodies->vz[i] * Constants::TIME_STEP;
+                }
+                auto detector = std::make_shared<CollisionDetector>();
+                auto contacts = std::make_shared<std::vector<ContactPair>>();
+                return [bodies, start, detector, contacts, n, &pool]() {
+                    const float* s = start->data();
+                    detector->findContacts(*bodies, s, s + n, s + 2 * n, pool, *contacts);
+                };
+            } });
+
+        // n copies of the default three-body scene, one leapfrog step each;
+        // unit is members. Lanes steps them side by side, sequential one
+        // system at a time through the regular solver and integrator.
+        list.push_back({ "ensemble/lanes", true, "member", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                BodySystem base;
+                Scenarios::loadDefault(base);
+                EnsembleConfig config;
+                config.members = n;
+                auto ensemble = std::make_shared<Ensemble>(pool.size());
+                ensemble->configure(config);
+                ensemble->populate(base);
+                return [ensemble]() { ensemble->step(); };
+            } });
+        list.push_back({ "ensemble/sequential", false, "member", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                auto members = std::make_shared<std::vector<BodySystem>>(n);
+                auto integrators = std::make_shared<std::vector<std::unique_ptr<Integrator>>>();
+                IntegratorConfig config;
+                config.name = "leapfrog";
+                for (BodySystem& member : *members) {
+                    Scenarios::loadDefault(member);
+                    integrators->push_back(createIntegrator(config));
+                }
+                std::shared_ptr<ForceSolver> solver(createForceSolver(SolverConfig()).release());
+                return [members, integrators, solver, &pool]() {
+                    for (size_t m = 0; m < members->size(); ++m) {
+                        (*integrators)[m]->step((*members)[m], *solver, pool, []() {});
+                    }
+                };
+            } });
+
+        const char* integrators[] = { "euler", "leapfrog", "verlet", "yoshida4" };
+        for (const char* integratorName : integrators) {
+            list.push_back({ std::string("integrate/") + integratorName, false, "body", false,
+                [integratorName](size_t n, ThreadPool& pool) -> std::function<void()> {
+                    auto bodies = std::make_shared<BodySystem>();
+                    makeBodies(n, *bodies, pool);
+                    IntegratorConfig config;
+                    config.name = integratorName;
+                    std::shared_ptr<Integrator> integrator(createIntegrator(config).release());
+                    auto solver = std::make_shared<NullSolver>();
+                    return [bodies, integrator, solver, &pool]() {
+                        integrator->step(*bodies, *solver, pool, []() {});
+                    };
+                } });
+        }
+
+        // Warp of a uniform 512 x 512 grid by n bodies; unit is vertices.
+        list.push_back({ "warp/grid", true, "vertex", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                BodySystem bodies;
+                makeBodies(n, bodies, pool);
+                auto mesh = std::make_shared<GridMesh>();
+                mesh->build(20000.0f, 511, 0, 0.0f, std::vector<GridAnchor>());
+                std::vector<WarpSource> sources;
+                for (size_t i = 0; i < bodies.size(); ++i) {
+                    float rs = Constants::SCHWARZSCHILD_PER_KG * bodies.mass[i];
+                    sources.push_back(WarpSource{ bodies.x[i], bodies.z[i], rs, 1e5f * rs });
+                }
+                auto warper = std::make_shared<GridWarper>();
+                warper->setSources(sources);
+                auto displacement = std::make_shared<std::vector<float>>(mesh->vertexCount());
+                return [mesh, warper, displacement, &pool]() {
+                    warper->evaluate(mesh->x.data(), mesh->z.data(), mesh->vertexCount(), displacement->data(), pool);
+                };
+            } });
+
+        // Adaptive grid rebuild around n anchors; unit is anchors.
+        list.push_back({ "mesh/grid", false, "anchor", false,
+            [](size_t n, ThreadPool& pool) -> std::function<void()> {
+                BodySystem bodies;
+                makeBodies(n, bodies, pool);
+                auto anchors = std::make_shared<std::vector<GridAnchor>>();
+                for (size_t i = 0; i < bodies.size(); ++i) anchors->push_back(GridAnchor{ bodies.x[i], bodies.z[i] });
+                auto mesh = std::make_shared<GridMesh>();
+                return [mesh, anchors]() { mesh->build(20000.0f, 64, 4, 3.0f, *anchors); };
+            } });
+
+        return list;
+    }
+
+    // For a benchmark whose unit is not bodies, perItem is divided by that
+    // count instead.
+    size_t itemCount(const Benchmark& benchmark, size_t n) {
+        return std::strcmp(benchmark.unit, "vertex") == 0 ? 512 * 512 : n;
+    }
+
+    bool parseList(const char* text, std::vector<size_t>& values) {
+        values.clear();
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            size_t value = std::strtoul(item.c_str(), nullptr, 10);
+            if (value == 0) return false;
+            values.push_back(value);
+        }
+        return !values.empty();
+    }
+
+    void writeJson(std::ostream& out, const std::vector<Result>& results) {
+        out.precision(6);
+        out << "{\n  \"version\": 1,\n";
+        out << "  \"hardware_threads\": " << std::max(1u, std::thread::hardware_concurrency()) << ",\n";
+        out << "  \"isa\": \"" << DirectKernels::isaName(DirectKernels::detectIsa()) << "\",\n";
+        out << "  \"results\": [\n";
+        for (size_t r = 0; r < results.size(); ++r) {
+            const Result& result = results[r];
+            out << "    {\"name\": \"" << result.name << "\", \"n\": " << result.n
+                << ", \"threads\": " << result.threads << ", \"iterations\": " << result.iterations
+                << ", \"seconds_per_iteration\": " << result.seconds
+                << ", \"ns_per_" << result.unit << "\": " << result.perItem;
+            if (result.perPair > 0.0) out << ", \"ns_per_interaction\": " << result.perPair;
+            out << "}" << (r + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+    }
+
+    void printUsage(const char* program) {
+        std::cerr << "Usage: " << program << " [--max-n N] [--threads 1,2,4] [--filter NAME]"
+                  << " [--min-time S] [--max-time S] [--json results.json]" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--max-n") == 0 && hasValue) {
+            options.maxN = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            if (!parseList(argv[++i], options.threads)) {
+                printUsage(argv[0]);
+                return -1;
+            }
+        } else if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+            options.minTime = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--max-time") == 0 && hasValue) {
+            options.maxTime = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--json") == 0 && hasValue) {
+            options.jsonPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+    if (options.threads.empty()) {
+        // Powers of two up to the hardware, plus the hardware count itself.
+        size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t t = 1; t < hardware; t *= 2) options.threads.push_back(t);
+        options.threads.push_back(hardware);
+    }
+
+    std::vector<Result> results;
+    std::cout << "benchmark               N  threads     ms/iter       ns/item   ns/interaction" << std::endl;
+    for (const Benchmark& benchmark : benchmarks()) {
+        if (!options.filter.empty() && benchmark.name.find(options.filter) == std::string::npos) continue;
+
+        for (size_t threads : options.threads) {
+            if (!benchmark.parallel && threads != options.threads.front()) continue;
+            ThreadPool pool(benchmark.parallel ? threads : 1);
+
+            for (size_t n = 10; n <= options.maxN; n *= 10) {
+                std::function<void()> run = benchmark.prepare(n, pool);
+
+                double start = now();
+                run();
+                double warmup = now() - start;
+
+                size_t iterations = 0;
+                double elapsed = 0.0;
+                if (warmup <= options.maxTime) {
+                    start = now();
+                    do {
+                        run();
+                        ++iterations;
+                        elapsed = now() - start;
+                    } while (elapsed < options.minTime);
+                } else {
+                    iterations = 1;
+                    elapsed = warmup;
+                }
+
+                Result result;
+                result.name = benchmark.name;
+                result.n = n;
+                result.threads = pool.size();
+                result.iterations = iterations;
+                result.seconds = elapsed / static_cast<double>(iterations);
+                result.unit = benchmark.unit;
+                result.perItem = result.seconds * 1e9 / static_cast<double>(itemCount(benchmark, n));
+                if (benchmark.pairwise) {
+                    result.perPair = result.seconds * 1e9 / (0.5 * static_cast<double>(n) * static_cast<double>(n - 1));
+                }
+                results.push_back(result);
+
+                std::printf("%-16s %8zu %8zu %11.4f %13.3f %16.4f\n", result.name.c_str(), n, result.threads,
+                            result.seconds * 1e3, result.perItem, result.perPair);
+                std::fflush(stdout);
+
+                if (warmup > options.maxTime) break;
+            }
+        }
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream out(options.jsonPath);
+        if (!out) {
+            std::cerr << "Failed to open JSON output: " << options.jsonPath << std::endl;
+            return -1;
+        }
+        writeJson(out, results);
+    } else {
+        writeJson(std::cout, results);
+    }
+    return 0;
+}
@@ -0,0 +1,488 @@
+#include "Physics.hpp"
+#include "PhysicsWorld.hpp"
+#include "Checkpoint.hpp"
+#include "Trajectory.hpp"
+#include "Scenarios.hpp"
+#include "Profiler.hpp"
+#include "StateIO.hpp"
+#include "Distributed.hpp"
+#include "Ensemble.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Candidates from the expected fastest to the most accurate.
+static const char* const kPrecisions[] = { "float", "mixed", "kahan", "double" };
+
+// Runs a few steps of every precision the integrator accepts on a copy of
+// the world and returns the fastest whose relative energy drift stays within
+// budget, or the one with the least drift if none does. Energy is summed
+// pairwise, so this costs O(N^2) per candidate.
+static std::string pickPrecision(const PhysicsWorld& world, unsigned long long steps, double budget) {
+    std::string best, leastDrift;
+    double bestSeconds = 0.0, smallestDrift = 0.0;
+    for (const char* precision : kPrecisions) {
+        IntegratorConfig config = world.integratorConfig();
+        config.precision = precision;
+        PhysicsWorld trial(world.threadCount());
+        if (!trial.setSolver(world.solverConfig()) || !trial.setIntegrator(config) ||
+            !trial.setCollisions(world.collisionConfig())) continue;
+        trial.bodies = world.bodies;
+
+        DirectKernels::Softening softening;
+        solverSoftening(world.solverConfig(), softening);
+        double before = Physics::totalEnergy(trial.bodies, softening);
+        auto start = std::chrono::steady_clock::now();
+        for (unsigned long long s = 0; s < steps; ++s) trial.step();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double drift = before != 0.0 ? std::fabs((Physics::totalEnergy(trial.bodies, softening) - before) / before) : 0.0;
+        std::cout << "  " << precision << ": drift " << drift << ", " << seconds << " s" << std::endl;
+
+        if (drift <= budget && (best.empty() || seconds < bestSeconds)) {
+            best = precision;
+            bestSeconds = seconds;
+        }
+        if (leastDrift.empty() || drift < smallestDrift) {
+            leastDrift = precision;
+            smallestDrift = drift;
+        }
+    }
+    return best.empty() ? leastDrift : best;
+}
+
+// One process of a --ranks run. Rank 0 builds the initial state, deals it
+// out and gathers the result; every rank steps its share.
+static int runDistributed(const TransportConfig& transportConfig, unsigned long long steps, const std::string& inputPath,
+                          const std::string& outputPath, const SolverConfig& solverConfig,
+                          const IntegratorConfig& integratorConfig, const ScenarioConfig& scenario, size_t threads,
+                          bool reportEnergy) {
+    std::unique_ptr<Transport> transport = createTransport(transportConfig);
+    if (!transport) {
+        std::cerr << "Rank " << transportConfig.rank << ": failed to join " << transportConfig.name
+                  << " transport at " << transportConfig.address << std::endl;
+        return -1;
+    }
+    const bool root = transport->rank() == 0;
+    DistributedWorld world(*transport, threads);
+    if (!world.setSolver(solverConfig)) {
+        if (root) std::cerr << "Invalid solver settings: " << solverConfig.name << "/" << solverConfig.kernel << std::endl;
+        return -1;
+    }
+    if (!world.setIntegrator(integratorConfig)) {
+        if (root) std::cerr << "Invalid integrator settings: " << integratorConfig.name
+                            << " (levels " << integratorConfig.blockLevels << ", block timesteps are not distributed)" << std::endl;
+        return -1;
+    }
+
+    BodySystem all;
+    bool loaded = true;
+    if (root) {
+        if (inputPath.empty()) {
+            loaded = Scenarios::generate(scenario, all, world.threadPool());
+            if (!loaded) std::cerr << "Unknown scenario: " << scenario.name << std::endl;
+        } else {
+            loaded = StateIO::load(inputPath, all);
+        }
+    }
+    // Every rank learns whether rank 0 has something to deal out.
+    std::vector<std::vector<char>> status;
+    if (!transport->allGather(std::vector<char>(1, loaded ? 1 : 0), status) || !status[0][0]) return -1;
+    DirectKernels::Softening softening;
+    solverSoftening(solverConfig, softening);
+    double initialEnergy = root && reportEnergy ? Physics::totalEnergy(all, softening) : 0.0;
+    if (!world.distribute(all)) return -1;
+
+    PROFILE_THREAD("main");
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long s = 0; s < steps; ++s) {
+        if (!world.step()) return -1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    size_t imported = world.forceSolver().importedSources();
+    if (!world.gather(all)) return -1;
+    if (!root) return 0;
+
+    std::cout << "Solver: " << world.forceSolver().name()
+              << ", integrator: " << world.integrator().name()
+              << ", transport: " << transport->name() << " x " << transport->size()
+              << ", bodies: " << all.size() << ", steps: " << steps
+              << ", time: " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << static_cast<double>(steps) / seconds << " steps/s)";
+    }
+    std::cout << std::endl;
+    std::cout << "Rebalances: " << world.rebalances << ", last imbalance: " << world.lastImbalance
+              << ", sources imported by rank 0: " << imported << std::endl;
+    if (reportEnergy) {
+        double finalEnergy = Physics::totalEnergy(all, softening);
+        std::cout << "Relative energy error: " << std::fabs((finalEnergy - initialEnergy) / initialEnergy) << std::endl;
+    }
+    return StateIO::save(outputPath, all, world.stepCount) ? 0 : -1;
+}
+
+// --ensemble: perturbed copies of the initial state stepped side by side.
+// Writes one summary row per member and member 0's final state.
+static int runEnsemble(const EnsembleConfig& config, unsigned long long steps, const std::string& inputPath,
+                       const std::string& outputPath, const std::string& summaryPath, const ScenarioConfig& scenario,
+                       size_t threads) {
+    Ensemble ensemble(threads);
+    if (!ensemble.configure(config)) {
+        std::cerr << "Invalid ensemble settings: " << config.members << " members, kernel " << config.kernel
+                  << " (softening " << config.softening << ", eps " << config.softeningLength
+                  << ", jitter " << config.positionJitter << ", dt " << config.timeStep << ")" << std::endl;
+        return -1;
+    }
+    BodySystem base;
+    if (inputPath.empty()) {
+        if (!Scenarios::generate(scenario, base, ensemble.threadPool())) {
+            std::cerr << "Unknown scenario: " << scenario.name << std::endl;
+            return -1;
+        }
+    } else if (!StateIO::load(inputPath, base)) {
+        return -1;
+    }
+    ensemble.populate(base);
+
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long s = 0; s < steps; ++s) ensemble.step();
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Ensemble: " << ensemble.memberCount() << " members x " << ensemble.bodyCount() << " bodies"
+              << ", kernel: " << DirectKernels::isaName(ensemble.isa())
+              << ", threads: " << ensemble.threadPool().size() << ", steps: " << steps << ", time: " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << static_cast<double>(steps) * ensemble.memberCount() / seconds << " member steps/s)";
+    }
+    std::cout << std::endl;
+
+    std::vector<MemberSummary> summaries;
+    ensemble.summarize(summaries);
+    size_t escaped = 0, touched = 0;
+    for (const MemberSummary& summary : summaries) {
+        if (summary.unbound > 0) ++escaped;
+        if (summary.closestApproach < 1.0f) ++touched;
+    }
+    std::cout << "Members with unbound bodies: " << escaped << ", with overlapping bodies: " << touched << std::endl;
+    if (!Ensemble::writeSummary(summaryPath, summaries)) return -1;
+    BodySystem reference;
+    ensemble.member(0, reference);
+    return StateIO::save(outputPath, reference, ensemble.stepCount) ? 0 : -1;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--steps N] [--input state.txt] [--output state.txt]"
+              << " [--solver direct|barnes-hut|fmm] [--theta T] [--order P] [--kernel auto|scalar|avx2|avx512]"
+              << " [--softening none|plummer|spline] [--eps L] [--collisions bounce|merge|fragment] [--restitution E]"
+              << " [--threads N] [--integrator euler|leapfrog|verlet|yoshida4] [--dt DT] [--levels L] [--eta E]"
+              << " [--precision float|double|kahan|mixed|auto] [--drift-budget D]"
+              << " [--energy] [--restore checkpoint.bin] [--checkpoint checkpoint.bin] [--checkpoint-every N]"
+              << " [--record trajectory.bin] [--record-every K] [--trace trace.json]"
+              << " [--ranks N] [--rank R] [--transport shm|socket] [--address A]"
+              << " [--ensemble M] [--jitter J] [--summary summary.csv]"
+              << " [--scenario default|plummer|disk|cube|clusters|planetary] [--bodies N] [--seed S] [--scale L]" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    unsigned long long steps = 1000;
+    std::string inputPath;
+    std::string outputPath = "final_state.txt";
+    SolverConfig solverConfig;
+    IntegratorConfig integratorConfig;
+    CollisionConfig collisionConfig;
+    size_t threads = 0;
+    bool reportEnergy = false;
+    std::string restorePath;
+    std::string checkpointPath;
+    unsigned long long checkpointEvery = 0;
+    std::string recordPath;
+    unsigned long long recordEvery = 1;
+    ScenarioConfig scenario;
+    bool autoPrecision = false;
+    double driftBudget = 1e-5;
+    std::string tracePath;
+    TransportConfig transportConfig;
+    bool joinRun = false;
+    EnsembleConfig ensembleConfig;
+    bool ensembleRun = false;
+    std::string summaryPath = "ensemble_summary.csv";
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--steps") == 0 && hasValue) {
+            steps = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--input") == 0 && hasValue) {
+            inputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--solver") == 0 && hasValue) {
+            solverConfig.name = argv[++i];
+        } else if (std::strcmp(argv[i], "--theta") == 0 && hasValue) {
+            solverConfig.theta = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--order") == 0 && hasValue) {
+            solverConfig.fmmOrder = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--kernel") == 0 && hasValue) {
+            solverConfig.kernel = argv[++i];
+        } else if (std::strcmp(argv[i], "--softening") == 0 && hasValue) {
+            solverConfig.softening = argv[++i];
+        } else if (std::strcmp(argv[i], "--eps") == 0 && hasValue) {
+            solverConfig.softeningLength = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--collisions") == 0 && hasValue) {
+            collisionConfig.response = argv[++i];
+        } else if (std::strcmp(argv[i], "--restitution") == 0 && hasValue) {
+            collisionConfig.restitution = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            threads = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--integrator") == 0 && hasValue) {
+            integratorConfig.name = argv[++i];
+        } else if (std::strcmp(argv[i], "--dt") == 0 && hasValue) {
+            integratorConfig.timeStep = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--levels") == 0 && hasValue) {
+            integratorConfig.blockLevels = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--eta") == 0 && hasValue) {
+            integratorConfig.eta = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--precision") == 0 && hasValue) {
+            integratorConfig.precision = argv[++i];
+            autoPrecision = integratorConfig.precision == "auto";
+            if (autoPrecision) integratorConfig.precision = "float";
+        } else if (std::strcmp(argv[i], "--drift-budget") == 0 && hasValue) {
+            driftBudget = std::strtod(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--energy") == 0) {
+            reportEnergy = true;
+        } else if (std::strcmp(argv[i], "--restore") == 0 && hasValue) {
+            restorePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--checkpoint") == 0 && hasValue) {
+            checkpointPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--checkpoint-every") == 0 && hasValue) {
+            checkpointEvery = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scenario") == 0 && hasValue) {
+            scenario.name = argv[++i];
+        } else if (std::strcmp(argv[i], "--bodies") == 0 && hasValue) {
+            scenario.bodyCount = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--seed") == 0 && hasValue) {
+            scenario.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--scale") == 0 && hasValue) {
+            scenario.scale = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--record") == 0 && hasValue) {
+            recordPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--record-every") == 0 && hasValue) {
+            recordEvery = std::max<unsigned long long>(1, std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--ranks") == 0 && hasValue) {
+            transportConfig.size = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--rank") == 0 && hasValue) {
+            transportConfig.rank = std::atoi(argv[++i]);
+            joinRun = true;
+        } else if (std::strcmp(argv[i], "--transport") == 0 && hasValue) {
+            transportConfig.name = argv[++i];
+        } else if (std::strcmp(argv[i], "--address") == 0 && hasValue) {
+            transportConfig.address = argv[++i];
+        } else if (std::strcmp(argv[i], "--ensemble") == 0 && hasValue) {
+            ensembleConfig.members = std::strtoull(argv[++i], nullptr, 10);
+            ensembleRun = true;
+        } else if (std::strcmp(argv[i], "--jitter") == 0 && hasValue) {
+            ensembleConfig.positionJitter = ensembleConfig.velocityJitter = std::strtof(argv[++i], nullptr);
+        } else if (std::strcmp(argv[i], "--summary") == 0 && hasValue) {
+            summaryPath = argv[++i];
+        } else {
+            printUsage(argv[0]);
+            return -1;
+        }
+    }
+
+    if (ensembleRun) {
+        // Always direct summation and leapfrog, without collisions.
+        const bool leapfrog = integratorConfig.name == IntegratorConfig().name || integratorConfig.name == "leapfrog";
+        if (!restorePath.empty() || !checkpointPath.empty() || !recordPath.empty() || !tracePath.empty() ||
+            transportConfig.size > 1 || joinRun || solverConfig.name != "direct" || !leapfrog ||
+            integratorConfig.blockLevels > 0 || integratorConfig.precision != IntegratorConfig().precision ||
+            collisionConfig.response != CollisionConfig().response) {
+            std::cerr << "--ensemble runs direct summation with fixed-step leapfrog and no collisions; it does not"
+                      << " support --restore, --checkpoint, --record, --trace, --ranks, --solver, --integrator,"
+                      << " --levels, --precision or --collisions" << std::endl;
+            return -1;
+        }
+        ensembleConfig.seed = scenario.seed;
+        ensembleConfig.timeStep = integratorConfig.timeStep;
+        ensembleConfig.kernel = solverConfig.kernel;
+        ensembleConfig.softening = solverConfig.softening;
+        ensembleConfig.softeningLength = solverConfig.softeningLength;
+        return runEnsemble(ensembleConfig, steps, inputPath, outputPath, summaryPath, scenario, threads);
+    }
+    if (transportConfig.size > 1 || joinRun) {
+        if (!restorePath.empty() || !checkpointPath.empty() || !recordPath.empty() || autoPrecision ||
+            !tracePath.empty() || collisionConfig.response != CollisionConfig().response) {
+            std::cerr << "--ranks does not support --restore, --checkpoint, --record, --trace, --collisions"
+                      << " or --precision auto" << std::endl;
+            return -1;
+        }
+        if (transportConfig.size < 1 || transportConfig.rank < 0 || transportConfig.rank >= transportConfig.size) {
+            std::cerr << "Invalid rank " << transportConfig.rank << " of " << transportConfig.size << std::endl;
+            return -1;
+        }
+        if (joinRun) {
+            // Launched by hand or a script: every process gets the same address.
+            if (transportConfig.address.empty()) {
+                std::cerr << "--rank needs --address" << std::endl;
+                return -1;
+            }
+            return runDistributed(transportConfig, steps, inputPath, outputPath, solverConfig, integratorConfig,
+                                  scenario, threads, reportEnergy);
+        }
+        if (transportConfig.address.empty()) {
+            transportConfig.address = std::string(transportConfig.name == "socket" ? "/tmp" : "") + "/gravity-" +
+                                      std::to_string(getpid());
+        }
+        // The processes share the cores unless told otherwise.
+        if (threads == 0) {
+            threads = std::max<size_t>(1, std::thread::hardware_concurrency() / transportConfig.size);
+        }
+        // Fork before any thread pool exists; this process stays rank 0.
+        std::vector<pid_t> children;
+        for (int r = 1; r < transportConfig.size; ++r) {
+            pid_t child = fork();
+            if (child == 0) {
+                transportConfig.rank = r;
+                std::exit(runDistributed(transportConfig, steps, inputPath, outputPath, solverConfig,
+                                         integratorConfig, scenario, threads, reportEnergy) == 0 ? 0 : 1);
+            }
+            if (child < 0) {
+                std::cerr << "fork failed; started " << children.size() + 1 << " of " << transportConfig.size
+                          << " processes" << std::endl;
+                break;
+            }
+            children.push_back(child);
+        }
+        transportConfig.rank = 0;
+        int result = -1;
+        if (children.size() + 1 == static_cast<size_t>(transportConfig.size)) {
+            result = runDistributed(transportConfig, steps, inputPath, outputPath, solverConfig, integratorConfig,
+                                    scenario, threads, reportEnergy);
+        } else {
+            for (pid_t child : children) kill(child, SIGTERM);
+        }
+        for (pid_t child : children) {
+            int status = 0;
+            if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) result = -1;
+        }
+        return result;
+    }
+
+    PhysicsWorld world(threads);
+    if (!world.setSolver(solverConfig)) {
+        std::cerr << "Invalid solver settings: " << solverConfig.name << "/" << solverConfig.kernel
+                  << " (softening " << solverConfig.softening << ", eps " << solverConfig.softeningLength << ")" << std::endl;
+        return -1;
+    }
+    if (!world.setIntegrator(integratorConfig)) {
+        std::cerr << "Invalid integrator settings: " << integratorConfig.name
+                  << " (dt " << integratorConfig.timeStep << ", levels " << integratorConfig.blockLevels
+                  << ", precision " << integratorConfig.precision << ")" << std::endl;
+        return -1;
+    }
+    if (!world.setCollisions(collisionConfig)) {
+        std::cerr << "Invalid collision settings: " << collisionConfig.response
+                  << " (restitution " << collisionConfig.restitution << ")" << std::endl;
+        return -1;
+    }
+    if (!restorePath.empty()) {
+        // Solver, integrator and collision settings come from the checkpoint.
+        if (!Checkpoint::load(restorePath, world)) return -1;
+        std::cout << "Restored step " << world.stepCount << " (t = " << world.simulationTime << ")" << std::endl;
+    } else if (inputPath.empty()) {
+        auto generateStart = std::chrono::steady_clock::now();
+        if (!Scenarios::generate(scenario, world.bodies, world.threadPool())) {
+            std::cerr << "Unknown scenario: " << scenario.name << std::endl;
+            return -1;
+        }
+        double generateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - generateStart).count();
+        if (scenario.name != "default") std::cout << "Scenario: " << scenario.name << ", bodies: " << world.bodies.size()
+                  << ", generated in " << generateSeconds << " s" << std::endl;
+    } else if (!StateIO::load(inputPath, world.bodies)) {
+        return -1;
+    }
+
+    if (autoPrecision) {
+        const unsigned long long kCalibrationSteps = 100;
+        std::cout << "Calibrating precision over " << std::min(steps, kCalibrationSteps)
+                  << " steps, drift budget " << driftBudget << ":" << std::endl;
+        IntegratorConfig config = world.integratorConfig();
+        config.precision = pickPrecision(world, std::min(steps, kCalibrationSteps), driftBudget);
+        world.setIntegrator(config);
+        std::cout << "Precision: " << config.precision << std::endl;
+    }
+
+    DirectKernels::Softening softening;
+    solverSoftening(world.solverConfig(), softening);
+    double initialEnergy = reportEnergy ? Physics::totalEnergy(world.bodies, softening) : 0.0;
+
+    CheckpointWriter checkpoints;
+    TrajectoryRecorder recorder;
+    if (!recordPath.empty()) {
+        if (!recorder.open(recordPath, static_cast<uint32_t>(recordEvery))) return -1;
+        recorder.record(world.bodies, world.stepCount, world.simulationTime);
+    }
+    PROFILE_THREAD("main");
+    auto start = std::chrono::steady_clock::now();
+    for (unsigned long long s = 0; s < steps; ++s) {
+        world.step();
+        if (!recordPath.empty() && world.stepCount % recordEvery == 0) {
+            recorder.record(world.bodies, world.stepCount, world.simulationTime);
+        }
+        if (!checkpointPath.empty() && checkpointEvery > 0 && world.stepCount % checkpointEvery == 0) {
+            checkpoints.save(checkpointPath, world);
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Solver: " << world.forceSolver().name()
+              << ", integrator: " << world.integrator().name()
+              << ", threads: " << world.threadCount()
+              << ", bodies: " << world.bodies.size() << ", steps: " << steps
+              << ", time: " << seconds << " s";
+    if (seconds > 0.0) {
+        std::cout << " (" << static_cast<double>(steps) / seconds << " steps/s)";
+    }
+    std::cout << std::endl;
+    std::cout << "Force evaluations per body: "
+              << static_cast<double>(world.integrator().bodyEvaluations) / std::max<size_t>(world.bodies.size(), 1) << std::endl;
+    if (!tracePath.empty()) {
+#ifdef GRAVITY_PROFILE
+        const char* stages[] = { "physics.step", "physics.forces", "physics.collisions" };
+        for (const char* stage : stages) {
+            ProfileStats stats = Profiler::stats(stage, Profiler::kRingSize);
+            if (stats.count == 0) continue;
+            std::cout << stage << ": p50 " << stats.p50 << " ms, p99 " << stats.p99 << " ms over " << stats.count << std::endl;
+        }
+        if (!Profiler::writeChromeTrace(tracePath)) return -1;
+#else
+        std::cerr << "--trace needs a build with GRAVITY_PROFILE; no trace written" << std::endl;
+#endif
+    }
+    if (reportEnergy) {
+        double finalEnergy = Physics::totalEnergy(world.bodies, softening);
+        std::cout << "Relative energy error: " << std::fabs((finalEnergy - initialEnergy) / initialEnergy) << std::endl;
+    }
+
+    if (!checkpoints.wait() || !recorder.close()) {
+        return -1;
+    }
+    if (!checkpointPath.empty() && !Checkpoint::save(checkpointPath, world)) {
+        return -1;
+    }
+    if (!StateIO::save(outputPath, world.bodies, world.stepCount)) {
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef BARNES_HUT_HPP
+#define BARNES_HUT_HPP
+
+#include "ForceSolver.hpp"
+#include "Octree.hpp"
+
+// O(N log N) approximation: an octree is rebuilt over the bodies every call
+// and a cell is treated as a point mass when size / distance < theta and
+// the body is outside it. The tree is built on the calling thread and
+// walked in parallel. The walk is instantiated per softening law; softened
+// pairs only differ from the bare law inside the softening length, so cell
+// approximations are unaffected.
+class BarnesHutSolver : public ForceSolver {
+public:
+    float theta;
+    size_t leafCapacity;
+    DirectKernels::Softening softening;
+
+    explicit BarnesHutSolver(float openingAngle = 0.5f, size_t maxLeafBodies = 8);
+
+    const char* name() const override { return "barnes-hut"; }
+    void computeAccelerations(BodySystem& bodies, ThreadPool& pool) override;
+    void computeAccelerationsFor(BodySystem& bodies, ThreadPool& pool, const std::vector<uint32_t>& targets) override;
+
+private:
+    Octree tree;
+
+    // targets == nullptr means bodies [0, count).
+    void accelerationsFor(BodySystem& bodies, ThreadPool& pool, const uint32_t* targets, size_t count);
+    template <DirectKernels::SofteningLaw L>
+    void walk(BodySystem& bodies, ThreadPool& pool, const uint32_t* targets, size_t count);
+    template <DirectKernels::SofteningLaw L>
+    void accelerationAt(const DirectKernels::SofteningCoefficients& c, const BodySystem& bodies, uint32_t i,
+                        float& accX, float& accY, float& accZ) const;
+};
+
+#endif
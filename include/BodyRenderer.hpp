@@ -0,0 +1,66 @@
+#ifndef BODY_RENDERER_HPP
+#define BODY_RENDERER_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+#include "Object.hpp"
+#include "SlotMap.hpp"
+#include "Shader.hpp"
+#include "RenderQueue.hpp"
+
+// Draws bodies instanced from a few shared indexed unit spheres of rising
+// tessellation. Each frame bodies outside the view frustum are dropped and
+// every other body picks the coarsest sphere whose silhouette edges stay
+// under kEdgePixels on screen; bodies under kImpostorPixels in radius are
+// drawn as camera-facing quads that ray-cast the sphere instead. Each level
+// is one instanced call; position, radius, color and glow travel in a
+// per-level instance buffer that is refilled each frame.
+class BodyRenderer {
+public:
+    BodyRenderer() {}
+    ~BodyRenderer();
+
+    BodyRenderer(const BodyRenderer&) = delete;
+    BodyRenderer& operator=(const BodyRenderer&) = delete;
+
+    // Needs a current GL context.
+    void setupOpenGLResources();
+    // Uploads the instance buffers and queues one draw per non-empty level.
+    // viewportHeight is in pixels and sets the projected size of each body.
+    void submit(RenderQueue& queue, const SlotMap<Object>& objects,
+                const glm::mat4& view, const glm::mat4& projection, int viewportHeight);
+
+    static constexpr int kLevels = 4;
+    // Bodies drawn at each level by the last submit.
+    size_t levelCount(int level) const { return levels[level].instances.size() / kInstanceFloats; }
+    size_t impostorCount() const { return impostors.instances.size() / kInstanceFloats; }
+    size_t culledCount() const { return culled; }
+
+private:
+    // Per-instance layout: position.xyz, radius, color.rgba, glow.
+    static constexpr int kInstanceFloats = 9;
+
+    // Level k has kCoarsestSectors * 2^k sectors and half as many stacks.
+    static constexpr int kCoarsestSectors = 8;
+    static constexpr float kEdgePixels = 6.0f;
+    static constexpr float kImpostorPixels = 4.0f;
+
+    struct Level {
+        GLuint VAO = 0, VBO = 0, EBO = 0, instanceVBO = 0;
+        GLsizei indexCount = 0;
+        std::vector<float> instances;
+    };
+
+    Level levels[kLevels];
+    Level impostors;             // unit quad instead of a sphere
+    Shader* shader = nullptr;
+    Shader* impostorShader = nullptr;
+    size_t culled = 0;
+
+    void setupLevel(Level& level, const std::vector<float>& vertices, const std::vector<GLuint>& indices);
+    void submitLevel(RenderQueue& queue, Level& level, const Shader* program);
+    static void releaseLevel(Level& level);
+};
+
+#endif
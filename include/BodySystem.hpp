@@ -0,0 +1,33 @@
+#ifndef BODY_SYSTEM_HPP
+#define BODY_SYSTEM_HPP
+
+#include <cstddef>
+#include "AlignedAllocator.hpp"
+
+// Physics state of launched bodies, independent of any rendering resources.
+// Stored as parallel 64-byte aligned arrays so force and integration loops
+// touch only the fields they need and can load them straight into SIMD
+// registers.
+class BodySystem {
+public:
+    AlignedVector<float> x, y, z;
+    AlignedVector<float> vx, vy, vz;
+    AlignedVector<float> ax, ay, az;
+    AlignedVector<float> mass;
+    AlignedVector<float> radius;
+
+    size_t size() const { return mass.size(); }
+    bool empty() const { return mass.empty(); }
+
+    void clear();
+    void reserve(size_t count);
+    // New bodies are zeroed; generators fill them in place.
+    void resize(size_t count);
+    size_t add(float px, float py, float pz,
+               float velX, float velY, float velZ,
+               float m, float r);
+    // O(1): the last body moves into slot i.
+    void swapRemove(size_t i);
+};
+
+#endif
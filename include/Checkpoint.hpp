@@ -0,0 +1,69 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "PhysicsWorld.hpp"
+
+// Binary snapshot of a PhysicsWorld: step count, simulation time, solver,
+// integrator and collision settings, the integrator's carried-over state,
+// the collision sweep start and every body array. A fixed header is
+// followed by raw native-endian arrays, each at a 64-byte aligned offset, so
+// a restore maps the file and copies the arrays straight into place without
+// parsing anything.
+namespace Checkpoint {
+    static constexpr uint32_t kVersion = 4;
+
+    // Writes synchronously through a temporary file renamed over path.
+    bool save(const std::string& path, const PhysicsWorld& world);
+    // Replaces world's bodies, solver, integrator, step count and time.
+    // Returns false and leaves world untouched if the file is missing,
+    // truncated, from another version or byte order, or names an unknown
+    // solver, integrator or collision response.
+    bool load(const std::string& path, PhysicsWorld& world);
+}
+
+// Saves checkpoints without holding up the step loop: save() copies the
+// world into a staging buffer laid out like the file and returns, and a
+// background thread writes and renames it. save() never waits for the disk:
+// while one snapshot is being written the newest one waits behind it, and
+// an older waiting snapshot is dropped in its favour.
+class CheckpointWriter {
+public:
+    CheckpointWriter() {}
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    void save(const std::string& path, const PhysicsWorld& world);
+    bool busy() const;
+    // Snapshots replaced by a newer one before they were written.
+    unsigned long long droppedSnapshots() const;
+    // Blocks until every saved snapshot is written or dropped; false if a
+    // write failed since the last call.
+    bool wait();
+
+private:
+    std::thread worker;
+    mutable std::mutex mutex;
+    std::condition_variable wake; // a snapshot is waiting, or stopping
+    std::condition_variable idle; // nothing waiting or being written
+    std::vector<char> staging;    // stepping thread only
+    std::vector<char> waiting;    // newest snapshot not yet taken by the worker
+    std::vector<char> writing;    // worker only
+    std::string waitingPath;
+    bool hasWaiting = false;
+    bool inFlight = false;
+    bool stopping = false;
+    bool failed = false;
+    unsigned long long droppedCount = 0;
+
+    void run();
+};
+
+#endif
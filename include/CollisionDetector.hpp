@@ -0,0 +1,62 @@
+#ifndef COLLISION_DETECTOR_HPP
+#define COLLISION_DETECTOR_HPP
+
+#include <cstdint>
+#include <vector>
+#include "BodySystem.hpp"
+#include "ThreadPool.hpp"
+
+struct ContactPair {
+    uint32_t a, b;   // a < b
+    float toi = 0.0f; // fraction of the sweep at first touch; 0 if already overlapping at its start
+};
+
+// Broadphase on a uniform spatial hash followed by the exact sphere test.
+// The cell size is twice the mean body diameter; every body is entered into
+// the cells its bounding box touches and only bodies sharing a cell become
+// candidates, so the cost stays close to O(N + contacts). The few bodies
+// spanning more than kMaxCellSpan cells per axis (a star among debris) skip
+// the grid and are tested against everyone.
+//
+// Given start positions, the test is continuous: every body is swept along
+// the segment from its start to its current position, the boxes cover the
+// whole sweep, and a pair is reported if the spheres touch anywhere along
+// it, so fast bodies cannot pass through each other between two calls.
+class CollisionDetector {
+public:
+    static const int kMaxCellSpan = 4;
+
+    // Replaces contacts with every overlapping pair.
+    void findContacts(const BodySystem& bodies, ThreadPool& pool, std::vector<ContactPair>& contacts);
+    // Replaces contacts with every pair that touched while moving from
+    // (startX, startY, startZ)[i] to the current positions.
+    void findContacts(const BodySystem& bodies, const float* startX, const float* startY, const float* startZ,
+                      ThreadPool& pool, std::vector<ContactPair>& contacts);
+
+    // Pairs that reached the exact test in the last call.
+    size_t candidateCount() const { return candidates; }
+
+private:
+    struct Entry {
+        int32_t cell[3];
+        uint32_t body;
+    };
+
+    float cellSize = 1.0f;
+    const float* sweepX = nullptr; // start positions of the current call, or nullptr
+    const float* sweepY = nullptr;
+    const float* sweepZ = nullptr;
+    std::vector<int32_t> cellBounds; // lo/hi per axis, 6 per body
+    std::vector<uint32_t> largeBodies;
+    std::vector<Entry> entries, sortedEntries;
+    std::vector<uint32_t> bucketStart;
+    std::vector<std::vector<ContactPair>> workerContacts;
+    std::vector<size_t> workerCandidates;
+    size_t candidates = 0;
+
+    // Exact swept test; sets toi on contact.
+    bool touches(const BodySystem& bodies, uint32_t i, uint32_t j, float& toi) const;
+    void testBucket(const BodySystem& bodies, uint32_t bucket, std::vector<ContactPair>& found, size_t& tested) const;
+};
+
+#endif
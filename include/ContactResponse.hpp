@@ -0,0 +1,77 @@
+#ifndef CONTACT_RESPONSE_HPP
+#define CONTACT_RESPONSE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "BodySystem.hpp"
+#include "CollisionDetector.hpp"
+
+// What happens to a pair of bodies that touch:
+//   bounce   - inelastic impulse along the line of centres with the given
+//              restitution, plus a mass-weighted push out of any overlap;
+//   merge    - the lighter body joins the heavier one, conserving mass,
+//              momentum and volume;
+//   fragment - an impact faster than fragmentSpeed times the mutual escape
+//              speed shatters the lighter body into fragmentCount pieces,
+//              slower ones merge.
+struct CollisionConfig {
+    std::string response = "bounce";
+    float restitution = 0.2f;
+    int fragmentCount = 4;           // 2..8
+    float fragmentSpeed = 2.0f;      // multiple of the mutual escape speed
+    float fragmentMinMass = 1e18f;   // lighter pieces merge instead; positive, so shattering ends
+};
+
+// Bodies added and removed by the last resolve, in the order applyEdits made
+// them: first one body appended per spawnedFrom entry (its value is the index
+// of the body it broke off from, before any removal), then one swapRemove per
+// removed entry. Anyone keeping per-body data in step with the system (ids)
+// replays the same edits.
+struct BodyEdits {
+    std::vector<uint32_t> spawnedFrom;
+    std::vector<uint32_t> removed; // descending
+
+    bool empty() const { return spawnedFrom.empty() && removed.empty(); }
+    void clear() { spawnedFrom.clear(); removed.clear(); }
+};
+
+// Applies a CollisionConfig to the contacts of one step. Contacts are handled
+// in order of time of impact; with start positions, both bodies of a swept
+// contact are first moved back to where they touched. Merges and fragments
+// only mark bodies; applyEdits() then changes the body count in one go, so
+// indices stay valid while contacts are resolved.
+class ContactResolver {
+public:
+    // Returns false and keeps the current settings if config is invalid.
+    bool configure(const CollisionConfig& config);
+
+    // start positions may be nullptr; contacts is reordered.
+    void resolve(BodySystem& bodies, const float* startX, const float* startY, const float* startZ,
+                 std::vector<ContactPair>& contacts);
+    bool hasEdits() const { return !pending.empty() || !dead.empty(); }
+    // Appends fragments and removes merged bodies; records the edits.
+    void applyEdits(BodySystem& bodies, BodyEdits& edits);
+
+private:
+    enum class Response { Bounce, Merge, Fragment };
+
+    struct Piece {
+        uint32_t parent;
+        float x, y, z, vx, vy, vz, mass, radius;
+    };
+
+    Response response = Response::Bounce;
+    CollisionConfig settings;
+    std::vector<uint8_t> rewound;     // per body, moved back to its time of impact
+    std::vector<uint8_t> removedFlag; // per body, merged or shattered
+    std::vector<uint32_t> dead;       // bodies to remove at applyEdits()
+    std::vector<Piece> pending;       // bodies to append at applyEdits()
+
+    void bounce(BodySystem& bodies, uint32_t a, uint32_t b);
+    void merge(BodySystem& bodies, uint32_t a, uint32_t b);
+    // Returns false if the impact is too slow or the pieces too light.
+    bool fragment(BodySystem& bodies, uint32_t a, uint32_t b);
+};
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef DIRECT_KERNELS_HPP
+#define DIRECT_KERNELS_HPP
+
+#include <cstddef>
+#include <string>
+#include "BodySystem.hpp"
+#include "Softening.hpp"
+
+// Direct-sum gravity kernels over the BodySystem arrays. The SIMD variants
+// are compiled with per-function target attributes and picked at runtime,
+// so the binary still runs on CPUs without AVX. Every kernel is also
+// instantiated once per softening law (see Softening.hpp), so the pair loop
+// has no branch on it.
+namespace DirectKernels {
+    enum class Isa { Scalar, Avx2, Avx512 };
+
+    const char* softeningName(SofteningLaw law);
+    // Accepts "none", "plummer" and "spline".
+    bool parseSoftening(const std::string& name, SofteningLaw& law);
+
+    // Best instruction set supported by the running CPU.
+    Isa detectIsa();
+    const char* isaName(Isa isa);
+    // Accepts "auto", "scalar", "avx2" and "avx512".
+    bool parseIsa(const std::string& name, Isa& isa);
+
+    // Writes ax/ay/az of bodies [begin, end) from the pull of all bodies.
+    // An isa the CPU lacks falls back to the best supported one.
+    void computeRange(Isa isa, const Softening& softening, BodySystem& bodies, size_t begin, size_t end);
+
+    // One-sided sum over raw arrays: adds m_j * d / r^3 for j in
+    // [jBegin, jEnd) to acc[i] for i in [iBegin, iEnd). G is not applied.
+    void accumulateSources(Isa isa, const Softening& softening, const float* x, const float* y, const float* z, const float* m,
+                           size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                           float* accX, float* accY, float* accZ);
+
+    // Newton's third law form for one tile of the interaction matrix: every
+    // pair (i, j) with i in [iBegin, iEnd) and j in [jBegin, jEnd) is evaluated
+    // once and adds m_j * d / r^3 to acc[i] and subtracts m_i * d / r^3 from
+    // acc[j]. G is not applied. A diagonal tile (iBegin == jBegin) visits each
+    // unordered pair once.
+    void accumulateTile(Isa isa, const Softening& softening, const BodySystem& bodies,
+                        size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                        float* accX, float* accY, float* accZ);
+
+    // Ensemble form: kEnsembleLanes independent systems of bodyCount bodies
+    // side by side, one per SIMD lane. Every array holds body i of lane l at
+    // [i * kEnsembleLanes + l] and is 64-byte aligned. Overwrites ax/ay/az
+    // of every body in every lane, G applied. Also lowers nearest[l] to
+    // r^2 * pairWeights[k] of any pair in lane l closer than that, where k
+    // numbers the pairs (i, j > i) row by row.
+    const size_t kEnsembleLanes = 16;
+    void computeLanes(Isa isa, const Softening& softening, size_t bodyCount,
+                      const float* x, const float* y, const float* z, const float* m, const float* pairWeights,
+                      float* ax, float* ay, float* az, float* nearest);
+}
+
+#endif
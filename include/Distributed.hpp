@@ -0,0 +1,108 @@
+#ifndef DISTRIBUTED_HPP
+#define DISTRIBUTED_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "BodySystem.hpp"
+#include "ForceSolver.hpp"
+#include "Integrator.hpp"
+#include "Octree.hpp"
+#include "ThreadPool.hpp"
+#include "Transport.hpp"
+
+// ForceSolver for the bodies one process owns in a distributed run. Before
+// every evaluation the processes swap the bounding boxes of their bodies;
+// each then walks an octree of its own bodies against every other box and
+// sends that process its locally essential tree: a cell that passes the
+// Barnes-Hut test for every point of the box travels as one point mass,
+// anything nearer is opened down to single bodies. The sources received are
+// appended behind the local bodies and the inner solver computes the
+// accelerations of the local ones. theta 0 ships every body, which makes the
+// result the inner solver's on the whole system.
+class DistributedSolver : public ForceSolver {
+public:
+    DistributedSolver(Transport& link, std::unique_ptr<ForceSolver> innerSolver, float openingAngle);
+
+    const char* name() const override { return inner->name(); }
+    void computeAccelerations(BodySystem& bodies, ThreadPool& pool) override;
+
+    // True once an exchange failed; accelerations are then local-only.
+    bool failed() const { return linkFailed; }
+    // Seconds spent in the inner solver since the last call.
+    double takeWork();
+    // Sources received from the other processes in the last evaluation.
+    size_t importedSources() const { return imported; }
+
+private:
+    Transport& transport;
+    std::unique_ptr<ForceSolver> inner;
+    float theta;
+    Octree tree;
+    BodySystem combined; // local bodies followed by the imported sources
+    std::vector<uint32_t> targets;
+    std::vector<std::vector<char>> outgoing, incoming;
+    double work = 0.0;
+    size_t imported = 0;
+    bool linkFailed = false;
+
+    void collectEssential(const BodySystem& bodies, const float* box, std::vector<char>& out) const;
+};
+
+// One process's share of a simulation split across processes. Bodies are
+// ordered along a Morton curve through the global bounding box and each
+// process owns a contiguous stretch of it, so its bodies fill a compact
+// region and the essential trees it exchanges stay small. Stretches are
+// cut by measured force time per body: every rebalanceInterval steps the
+// processes compare their time, and if the slowest is more than
+// imbalanceTolerance above the mean the curve is cut again and bodies
+// migrate. Collisions are not resolved in this mode.
+//
+// Every method below is collective: all processes call it together.
+class DistributedWorld {
+public:
+    BodySystem bodies;         // owned by this process
+    std::vector<uint64_t> ids; // index of each body in the input
+    unsigned long long stepCount = 0;
+    double simulationTime = 0.0;
+    unsigned rebalanceInterval = 10; // 0 keeps the first decomposition
+    float imbalanceTolerance = 0.1f;
+    unsigned rebalances = 0;
+    double lastImbalance = 0.0; // slowest / mean - 1 at the last check
+
+    // threadCount 0 uses every hardware thread.
+    explicit DistributedWorld(Transport& link, size_t threadCount = 0);
+
+    // Returns false if config is rejected by createForceSolver; theta also
+    // sets the opening angle of the essential trees.
+    bool setSolver(const SolverConfig& config);
+    // Also rejects block timesteps, with which processes would evaluate
+    // forces a different number of times per step.
+    bool setIntegrator(const IntegratorConfig& config);
+    const Integrator& integrator() const { return *timeIntegrator; }
+    const DistributedSolver& forceSolver() const { return *solver; }
+    ThreadPool& threadPool() { return *pool; }
+
+    // Rank 0 passes every body, the others an empty system; ends with a
+    // decomposition. Fails on every rank if there are fewer bodies than
+    // processes.
+    bool distribute(const BodySystem& all);
+    // Returns false if a peer process is gone.
+    bool step();
+    // Rank 0 receives every body in input order, the others nothing.
+    bool gather(BodySystem& all);
+
+private:
+    Transport& transport;
+    std::unique_ptr<ThreadPool> pool;
+    SolverConfig solverCfg;
+    IntegratorConfig integratorCfg;
+    std::unique_ptr<DistributedSolver> solver;
+    std::unique_ptr<Integrator> timeIntegrator;
+    double workSinceCheck = 0.0;
+
+    // Recuts the curve with every local body weighing secondsPerBody (1 if 0).
+    bool rebalance(double secondsPerBody);
+};
+
+#endif
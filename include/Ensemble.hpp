@@ -0,0 +1,88 @@
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AlignedAllocator.hpp"
+#include "BodySystem.hpp"
+#include "DirectKernels.hpp"
+#include "ThreadPool.hpp"
+#include "constants.hpp"
+
+struct EnsembleConfig {
+    size_t members = 1024;
+    uint64_t seed = 1;
+    float positionJitter = 1e-3f;  // standard deviation, in RMS distances from the centre of mass
+    float velocityJitter = 1e-3f;  // standard deviation, in RMS speeds about the centre of mass
+    float timeStep = Constants::TIME_STEP;
+    std::string kernel = "auto";   // "auto", "scalar", "avx2" or "avx512"
+    std::string softening = "none"; // "none", "plummer" or "spline"
+    float softeningLength = 0.0f;
+};
+
+// What is left of one member after a run.
+struct MemberSummary {
+    double initialEnergy = 0.0;
+    double finalEnergy = 0.0;
+    float closestApproach = 0.0f; // smallest distance between two bodies after any step (the initial state excluded), in sums of their radii; below 1 they overlapped
+    float maxRadius = 0.0f;       // largest distance of a body from the centre of mass at the end
+    uint32_t unbound = 0;         // bodies whose kinetic energy about the centre of mass exceeds their binding energy
+};
+
+// Many copies of one small system with perturbed initial conditions,
+// stepped together with kick-drift-kick leapfrog. Member m sits in SIMD
+// lane m % 16 of block m / 16; a block keeps body i of all its lanes next
+// to each other, so the direct sum runs one system per lane with no
+// horizontal sums, and the thread pool takes whole blocks. Member 0 is the
+// unperturbed system. Bodies never collide or merge: the body count is
+// fixed by the lane layout.
+class Ensemble {
+public:
+    unsigned long long stepCount = 0;
+    double simulationTime = 0.0;
+
+    // threadCount 0 uses every hardware thread.
+    explicit Ensemble(size_t threadCount = 0);
+
+    // Returns false for an unknown kernel or softening, no members, a
+    // negative jitter or a non-positive time step.
+    bool configure(const EnsembleConfig& config);
+    const EnsembleConfig& config() const { return settings; }
+    DirectKernels::Isa isa() const { return kernelIsa; }
+    ThreadPool& threadPool() { return *pool; }
+
+    // Fills every member from base, then computes the first accelerations.
+    void populate(const BodySystem& base);
+    void step();
+
+    size_t memberCount() const { return settings.members; }
+    size_t bodyCount() const { return bodies; }
+    // Copies member m out as an ordinary system.
+    void member(size_t m, BodySystem& out) const;
+    // O(N^2) per member.
+    void summarize(std::vector<MemberSummary>& out);
+
+    // One CSV row per member.
+    static bool writeSummary(const std::string& path, const std::vector<MemberSummary>& summaries);
+
+private:
+    std::unique_ptr<ThreadPool> pool;
+    EnsembleConfig settings;
+    DirectKernels::Isa kernelIsa = DirectKernels::Isa::Scalar;
+    DirectKernels::Softening softeningLaw;
+    size_t bodies = 0;
+    size_t blocks = 0;
+    AlignedVector<float> x, y, z, vx, vy, vz, ax, ay, az, mass; // blocks * bodies * 16, block-major
+    std::vector<float> radius;          // per body, shared by every member
+    std::vector<float> pairWeights;     // 1 / (r_i + r_j)^2 per pair (i, j > i)
+    std::vector<float> closest;         // per lane slot, squared and in units of the pair's weight
+    std::vector<double> initialEnergy;  // per member
+
+    size_t offset(size_t m, size_t i) const;
+    void computeBlock(size_t block);
+    void stepBlock(size_t block);
+};
+
+#endif
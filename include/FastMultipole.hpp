@@ -0,0 +1,92 @@
+#ifndef FAST_MULTIPOLE_HPP
+#define FAST_MULTIPOLE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "ForceSolver.hpp"
+#include "Octree.hpp"
+
+// Fast multipole method with Cartesian Taylor expansions truncated at total
+// order `order`. Two cells interact through M2L once
+// (r_A + r_B) < theta * |c_A - c_B|; otherwise the larger one is split until
+// leaf pairs are summed directly (P2P). Work is O(N) for a fixed order and
+// theta, and the error is tuned with both: higher order or smaller theta is
+// more accurate and slower.
+//
+// Every pass runs on the pool. P2M/M2M run bottom-up one tree level at a
+// time, L2L runs top-down the same way, and L2P runs per leaf. The M2L/P2P
+// traversal is split by target cell, so each task only writes expansions
+// and accelerations inside its own subtree.
+class FmmSolver : public ForceSolver {
+public:
+    static const int kMaxOrder = 10;
+    static const size_t kMaxTerms = (kMaxOrder + 1) * (kMaxOrder + 2) * (kMaxOrder + 3) / 6;
+
+    explicit FmmSolver(int expansionOrder = 4, float openingAngle = 0.5f, size_t maxLeafBodies = 64);
+
+    int order() const { return expansionOrder; }
+    float theta() const { return openingAngle; }
+
+    // Applied to the near-field (P2P) pairs; the expansions are Newtonian,
+    // which holds as long as the softening length is below the leaf size.
+    DirectKernels::Softening softening;
+
+    const char* name() const override { return "fmm"; }
+    void computeAccelerations(BodySystem& bodies, ThreadPool& pool) override;
+
+private:
+    // Coefficient-weighted index triple used by the translation operators.
+    struct Term {
+        uint16_t out, in, other;
+        double coef;
+    };
+
+    int expansionOrder;
+    float openingAngle;
+    size_t leafCapacity;
+    DirectKernels::Isa isa;
+
+    // Multi-index bookkeeping: terms with a + b + c <= order.
+    size_t termCount = 0;
+    std::vector<int> termIndex;            // (order + 1)^3 lookup, -1 above order
+    std::vector<uint8_t> termA, termB, termC;
+    std::vector<double> termFactorial;     // a! b! c!
+    // Per term, the indices of k - e_i and k - 2e_i (0 where absent, with a
+    // zero weight), precomputed so the recurrences run without lookups.
+    struct Recurrence {
+        uint16_t down1[3], down2[3];
+        double weight1[3], weight2[3];
+        uint16_t monomialParent;
+        uint8_t monomialAxis;
+        double monomialScale;
+    };
+    std::vector<Recurrence> recurrences;
+    std::vector<Term> m2mTerms, m2lTerms, l2lTerms;
+
+    Octree tree;
+    std::vector<uint32_t> parent;
+    std::vector<double> centers;           // 3 per node: expansion center (center of mass)
+    std::vector<double> radii;             // bound on |body - center| per node
+    std::vector<double> multipoles, locals; // termCount per node
+    std::vector<std::vector<uint32_t>> levels;
+    std::vector<uint32_t> leaves;
+    std::vector<uint32_t> taskCells;
+
+    // Bodies gathered in tree order so every node is a contiguous range.
+    AlignedVector<float> sortedX, sortedY, sortedZ, sortedMass;
+    AlignedVector<float> sortedAccX, sortedAccY, sortedAccZ;
+
+    int index(int a, int b, int c) const { return termIndex[(a * (expansionOrder + 1) + b) * (expansionOrder + 1) + c]; }
+    void buildTables();
+    void monomials(double dx, double dy, double dz, double* out) const;
+    void taylorCoefficients(double dx, double dy, double dz, double* out) const;
+
+    void prepareTree(const BodySystem& bodies, size_t workerCount);
+    void upward(uint32_t node);
+    void interact(uint32_t target, uint32_t source);
+    void multipoleToLocal(uint32_t target, uint32_t source);
+    void localToLocal(uint32_t child);
+    void localToBodies(uint32_t leaf);
+};
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef FORCE_SOLVER_HPP
+#define FORCE_SOLVER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include "BodySystem.hpp"
+#include "DirectKernels.hpp"
+#include "ThreadPool.hpp"
+
+// Computes gravitational accelerations into bodies.ax/ay/az, spreading the
+// work over the given pool.
+class ForceSolver {
+public:
+    virtual ~ForceSolver() {}
+    virtual const char* name() const = 0;
+    virtual void computeAccelerations(BodySystem& bodies, ThreadPool& pool) = 0;
+
+    // Same, but only the listed bodies need fresh accelerations; the others
+    // may be left alone or overwritten. Used by block timesteps, where few
+    // bodies are active per substep. The default evaluates every body.
+    virtual void computeAccelerationsFor(BodySystem& bodies, ThreadPool& pool, const std::vector<uint32_t>& targets) {
+        (void)targets;
+        computeAccelerations(bodies, pool);
+    }
+};
+
+// Exact O(N^2) pairwise sum; the reference every other solver is checked against.
+// Runs the widest SIMD kernel the CPU supports unless told otherwise.
+// The interaction matrix is cut into square tiles and only tiles on or above
+// the diagonal are evaluated, so each unordered pair is computed once and
+// applied to both bodies. Every worker accumulates into its own arrays, which
+// are summed per body afterwards; no step needs a lock or an atomic add.
+class DirectSumSolver : public ForceSolver {
+public:
+    DirectKernels::Isa isa;
+    DirectKernels::Softening softening;
+
+    explicit DirectSumSolver(DirectKernels::Isa kernelIsa = DirectKernels::detectIsa(),
+                             DirectKernels::Softening law = DirectKernels::Softening())
+        : isa(kernelIsa), softening(law) {}
+
+    const char* name() const override { return "direct"; }
+    void computeAccelerations(BodySystem& bodies, ThreadPool& pool) override;
+    void computeAccelerationsFor(BodySystem& bodies, ThreadPool& pool, const std::vector<uint32_t>& targets) override;
+
+private:
+    struct Accumulator {
+        AlignedVector<float> x, y, z;
+        bool used = false;
+    };
+
+    std::vector<Accumulator> accumulators;
+    std::vector<std::pair<uint32_t, uint32_t>> tiles;
+    size_t tileSize = 0;
+    size_t tileBodyCount = 0;
+
+    void planTiles(size_t bodyCount, size_t workerCount);
+};
+
+struct SolverConfig {
+    std::string name = "direct"; // "direct", "barnes-hut" or "fmm"
+    float theta = 0.5f;          // Barnes-Hut / FMM opening angle
+    int fmmOrder = 4;            // FMM expansion order
+    std::string kernel = "auto"; // direct-sum instruction set: auto, scalar, avx2, avx512
+    std::string softening = "none"; // none, plummer or spline
+    float softeningLength = 0.0f;   // eps in visual units, for plummer and spline
+};
+
+// Softening law and length named by config; false for an unknown law, or
+// plummer/spline without a positive length.
+bool solverSoftening(const SolverConfig& config, DirectKernels::Softening& softening);
+
+// Returns nullptr for an unknown solver or kernel name, or invalid softening.
+std::unique_ptr<ForceSolver> createForceSolver(const SolverConfig& config);
+
+#endif
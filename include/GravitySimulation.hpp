@@ -6,18 +6,28 @@
 #include <glm/glm.hpp>
 #include <vector>
 #include <string>
+#include <unordered_map>
 
 #include "Shader.hpp"
 #include "Camera.hpp"
 #include "Object.hpp"
+#include "SlotMap.hpp"
 #include "Grid.hpp"
+#include "BodyRenderer.hpp"
+#include "RenderQueue.hpp"
+#include "PhysicsThread.hpp"
+#include "Trajectory.hpp"
 
 class GravitySimulation {
 public:
     GLFWwindow* window = nullptr; 
     bool running = true;         
 
-    GravitySimulation(int width, int height, const char* title);
+    // With a replayPath the window plays back a recorded trajectory instead
+    // of simulating: P pauses, held Left/Right scrub, Up/Down change speed.
+    // Builds with GRAVITY_PROFILE show per-stage frame times in the title bar
+    // and write gravity_trace.json on T.
+    GravitySimulation(int width, int height, const char* title, const std::string& replayPath = "");
     ~GravitySimulation();
 
     GravitySimulation(const GravitySimulation&) = delete;
@@ -37,8 +47,18 @@ public:
 private:
     Shader* mainShader = nullptr; 
     Camera camera;
-    std::vector<Object> objects;
+    SlotMap<Object> objects;
+    PhysicsThread physics;             // body ids are handles into objects
+    BodySnapshot previousSnapshot;     // the snapshot before physics.snapshot(), for interpolation
+    SolverConfig solverConfig;
+    IntegratorConfig integratorConfig;
+    CollisionConfig collisionConfig;
+    unsigned long long commandsSent = 0;
+    unsigned long long snapshotsTaken = 0;
+    std::unordered_map<uint32_t, SlotHandle> fragments; // objects of spawned bodies, by id index
     Grid grid; 
+    BodyRenderer bodyRenderer;
+    RenderQueue renderQueue;
 
     bool paused = true;
     float deltaTime = 0.0f;
@@ -47,7 +67,20 @@ private:
     float lastMouseX = 400.0f, lastMouseY = 300.0f; 
     bool firstMouse = true;
 
-    bool isCreatingObject = false;
+    SlotHandle creating;               // body being sized and placed, not yet launched
+    std::vector<SlotHandle> unsentLaunches; // launches the full command queue turned away, retried every frame
+    std::vector<SlotHandle> unsentRemovals; // likewise for removals; the object stays until the physics is told
+
+    std::string windowTitle;
+    double statsShownAt = 0.0;
+
+    TrajectoryReader replay;
+    bool replaying = false;
+    bool replayPaused = false;
+    float replayFrame = 0.0f;   // fractional frame index of the playhead
+    float replaySpeed = 1.0f;   // 1 plays at the simulated rate
+    std::vector<float> replayX, replayY, replayZ, replayNextX, replayNextY, replayNextZ;
+    std::vector<SlotHandle> replayBodies; // objects of the replayed bodies, in file order
 
     bool initGLFW(int width, int height, const char* title);
     bool initGLEW();
@@ -56,7 +89,18 @@ private:
 
     void processInput();
     void update();
-    void render(const glm::mat4& projection);
+    bool send(const PhysicsCommand& command);
+    // Hands the object to the physics; if the command queue is full it stays
+    // unlaunched and is sent again next frame.
+    void launch(SlotHandle handle);
+    void destroy(SlotHandle handle);
+    void retryUnsent();
+    // Object drawing body k of the current snapshot; creates one for a new fragment.
+    Object* objectOf(const BodySnapshot& snapshot, size_t k);
+    void applySnapshot();
+    void updateReplay();
+    void render(const glm::mat4& projection, int viewportHeight);
+    void showFrameStats();
 };
 
 #endif
\ No newline at end of file
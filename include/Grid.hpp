@@ -6,17 +6,36 @@
 #include <vector>
 #include "Shader.hpp"  
 #include "Object.hpp"    
+#include "SlotMap.hpp"
 #include "constants.hpp"
+#include "GridMesh.hpp"
+#include "GridWarp.hpp"
+#include "ThreadPool.hpp"
+#include "RenderQueue.hpp"
 
 class Grid {
 public:
-    GLuint VAO = 0, VBO = 0;
-    size_t vertexCount = 0;
+    // Cpu evaluates every vertex height each frame with GridWarper (SIMD
+    // across vertices, on a thread pool, distant body groups aggregated) and
+    // re-uploads the VBO.
+    // Gpu keeps the VBO static and displaces vertices in the vertex shader
+    // from a texture buffer holding one texel per body, so only the body
+    // list is uploaded per frame.
+    enum class WarpMode { Cpu, Gpu };
+
+    GLuint VAO = 0, VBO = 0, EBO = 0;
+    size_t vertexCount = 0; // floats in vertices, 3 per vertex
+    size_t indexCount = 0;
     float gridSize;
     int divisions;
+    int refineLevels;       // extra halvings of the cell size near massive bodies
     float initialYPlane;
+    WarpMode warpMode;
 
-    Grid(float size = 20000.0f, int divs = 25);
+    // The mesh is indexed and, with refineLevels > 0, refined around bodies
+    // carrying at least kAnchorFraction of the strongest warp; it is rebuilt
+    // once one of them has moved a quarter of a base cell.
+    Grid(float size = 20000.0f, int divs = 25, WarpMode mode = WarpMode::Cpu, int refine = 0);
     ~Grid();
 
     Grid(const Grid&) = delete;
@@ -25,12 +44,34 @@ public:
     Grid& operator=(Grid&&) = delete;
 
     void setupOpenGLResources(); 
-    void updateAndWarp(const std::vector<Object>& objects);
-    void draw(Shader& shader);
+    void setWarpMode(WarpMode mode);
+    void updateAndWarp(const SlotMap<Object>& objects);
+    // shader is used in Cpu mode; Gpu mode draws with the grid's own program.
+    void submit(RenderQueue& queue, const Shader& shader);
 
 private:
+    static constexpr float kAnchorFraction = 1e-3f;
+    static constexpr float kRefineReach = 3.0f;
+
     std::vector<float> vertices; 
-    void generateInitialVertices();
+    GridMesh mesh;
+    GridWarper warper;
+    ThreadPool pool;
+    std::vector<GridAnchor> builtAnchors;
+    std::vector<WarpSource> sources;
+    std::vector<float> displacement;
+
+    void generateInitialVertices(const std::vector<GridAnchor>& anchors);
+    bool anchorsMoved(const std::vector<GridAnchor>& anchors) const;
+    void uploadMesh();
+
+    float planeY = 0.0f;           // undisplaced height after the center-of-mass shift
+    std::vector<float> bodyTexels; // x, z, Schwarzschild radius (m), strength per body
+    GLuint bodyBuffer = 0, bodyTexture = 0;
+    Shader* warpShader = nullptr;
+    GLint warpColorLocation = -1, warpBodyCountLocation = -1, warpPlaneYLocation = -1;
+
+    void uploadBodies();
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,39 @@
+#ifndef GRID_MESH_HPP
+#define GRID_MESH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Point the grid refines around, in plane coordinates.
+struct GridAnchor {
+    float x, z;
+};
+
+// Line lattice of the spacetime grid with shared vertices and GL_LINES
+// index pairs. The square of side `size` centred on the origin is cut into
+// divisions^2 cells; a cell is split in four while an anchor lies within
+// refineRatio cell sizes of it, at most refineLevels times. Where a coarse cell meets finer ones its edge is split at their
+// corners, so no segment is drawn twice. Vertices are stored in Morton order
+// of their lattice position, so consecutive vertices are spatial neighbours.
+class GridMesh {
+public:
+    std::vector<float> x, z;
+    std::vector<uint32_t> lines; // two vertex indices per segment
+
+    size_t vertexCount() const { return x.size(); }
+
+    void build(float size, int divisions, int refineLevels, float refineRatio, const std::vector<GridAnchor>& anchors);
+
+private:
+    struct Edge {
+        uint32_t line, begin, end; // lattice units; line is z for horizontal edges, x for vertical
+    };
+
+    std::vector<Edge> horizontal, vertical;
+
+    void refine(uint32_t i, uint32_t j, uint32_t span, int level, float unit, float halfSize,
+                int refineLevels, float refineRatio, const std::vector<GridAnchor>& anchors);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef GRID_WARP_HPP
+#define GRID_WARP_HPP
+
+#include <cstdint>
+#include <vector>
+#include "DirectKernels.hpp"
+#include "ThreadPool.hpp"
+
+// One body as seen by the grid: plane position, Schwarzschild radius in
+// metres and strength = warp factor * rs. A vertex at horizontal distance d
+// (metres, at least one unit) is pulled down by strength / d unless d <= rs.
+struct WarpSource {
+    float x, z, rs, strength;
+};
+
+// Evaluates the grid displacement for many vertices. Vertices are processed
+// in chunks of kChunk consecutive entries, which should be spatially compact
+// (GridMesh stores them in Morton order). For every chunk the sources are
+// walked in a 2D tree and groups whose extent plus the chunk's is below
+// theta times their distance are replaced by one aggregate at their
+// strength-weighted centroid. Sources are converted to visual units when
+// set, so the per-vertex math has no unit factor. Chunks run on the pool, and each chunk's
+// interaction list is applied across vertices with the widest SIMD the CPU
+// has.
+class GridWarper {
+public:
+    static constexpr size_t kChunk = 256;
+
+    explicit GridWarper(float openingAngle = 0.5f, DirectKernels::Isa kernelIsa = DirectKernels::detectIsa());
+
+    float theta;
+    DirectKernels::Isa isa;
+
+    void setSources(const std::vector<WarpSource>& sources);
+
+    // Writes the (non-positive) displacement of each vertex.
+    void evaluate(const float* x, const float* z, size_t count, float* displacement, ThreadPool& pool);
+
+private:
+    static constexpr uint32_t kLeafSize = 8;
+
+    struct Node {
+        float minX, minZ, maxX, maxZ;
+        float centerX, centerZ, strength, radius;
+        uint32_t begin, end;
+        int32_t left, right; // -1 for leaves
+    };
+
+    struct InteractionList {
+        std::vector<float> x, z, rs, strength;
+        void clear() { x.clear(); z.clear(); rs.clear(); strength.clear(); }
+        void add(float px, float pz, float r, float s) { x.push_back(px); z.push_back(pz); rs.push_back(r); strength.push_back(s); }
+    };
+
+    std::vector<WarpSource> sorted;
+    std::vector<Node> nodes;
+    std::vector<InteractionList> lists;
+
+    int32_t buildNode(uint32_t begin, uint32_t end);
+    void gather(const float* x, const float* z, size_t begin, size_t end, InteractionList& list) const;
+};
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef INTEGRATOR_HPP
+#define INTEGRATOR_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BodySystem.hpp"
+#include "ForceSolver.hpp"
+#include "ThreadPool.hpp"
+#include "constants.hpp"
+
+// What an integrator carries between frames besides the bodies' own
+// accelerations; saved in checkpoints so a restored run continues exactly.
+struct IntegratorState {
+    bool primed = false;
+    std::vector<uint8_t> level;                // leapfrog block levels
+    AlignedVector<float> prevAx, prevAy, prevAz; // leapfrog accelerations at each body's last level update
+};
+
+// Advances the bodies by one frame. Apart from the legacy Euler step, the
+// integrators keep the accelerations of the previous frame, so reset() must
+// be called whenever bodies are added, removed or moved from outside.
+class Integrator {
+public:
+    // Runs once per frame at a point where velocities and positions belong
+    // to the same time; PhysicsWorld resolves collisions here.
+    typedef std::function<void()> ContactStage;
+
+    // Accelerations computed so far, counted per body.
+    unsigned long long bodyEvaluations = 0;
+
+    virtual ~Integrator() {}
+    virtual const char* name() const = 0;
+    virtual void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) = 0;
+
+    void reset() { primed = false; }
+
+    virtual void saveState(IntegratorState& state) const { state = IntegratorState(); state.primed = primed; }
+    // Returns false if state does not fit bodyCount bodies; the integrator is
+    // then reset.
+    virtual bool restoreState(const IntegratorState& state, size_t) { primed = state.primed; return true; }
+
+protected:
+    bool primed = false;
+
+    void evaluateAll(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool);
+};
+
+// The original frame step: semi-implicit Euler with the acceleration divided
+// by VELOCITY_STEP_RATIO and the velocity by POSITION_STEP_RATIO. Not
+// symplectic (the two ratios differ), kept so old scenes behave as before.
+class EulerIntegrator : public Integrator {
+public:
+    const char* name() const override { return "euler"; }
+    void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) override;
+};
+
+// Kick-drift-kick leapfrog with power-of-two block timesteps. Body i moves
+// with step timeStep / 2^level[i], level in [0, maxLevel]; a frame is
+// 2^maxLevel ticks and at every tick only the bodies finishing a step have
+// their accelerations evaluated. Levels follow eta * |a| / |da/dt|, with the
+// derivative taken over the body's last step: a body may move to a finer
+// level at the end of any step and one level coarser once the coarser step
+// is aligned. maxLevel 0 is plain leapfrog with one evaluation per frame.
+class LeapfrogIntegrator : public Integrator {
+public:
+    static constexpr int kMaxLevels = 20;
+
+    LeapfrogIntegrator(float frameStep, int blockLevels = 0, float accuracy = 0.02f);
+
+    const char* name() const override { return "leapfrog"; }
+    void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) override;
+
+    void saveState(IntegratorState& state) const override;
+    bool restoreState(const IntegratorState& state, size_t bodyCount) override;
+
+    int maxLevel() const { return levelCount; }
+    // Bodies per level after the last frame.
+    std::vector<size_t> levelHistogram() const;
+
+private:
+    float timeStep;
+    int levelCount;
+    float eta;
+    std::vector<uint8_t> level;
+    AlignedVector<float> prevAx, prevAy, prevAz;
+    std::vector<uint32_t> active;
+
+    void updateLevel(const BodySystem& bodies, uint32_t i, uint32_t tick);
+};
+
+// Velocity Verlet: drift with the old acceleration, evaluate, then kick with
+// the mean of the old and new ones. Same trajectory as leapfrog up to round-off.
+class VelocityVerletIntegrator : public Integrator {
+public:
+    explicit VelocityVerletIntegrator(float frameStep) : timeStep(frameStep) {}
+
+    const char* name() const override { return "verlet"; }
+    void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) override;
+
+private:
+    float timeStep;
+    AlignedVector<float> oldAx, oldAy, oldAz;
+};
+
+// Yoshida's fourth-order composition of three leapfrog steps with weights
+// w1, w0, w1. Three evaluations per frame; the error falls as dt^4.
+class YoshidaIntegrator : public Integrator {
+public:
+    explicit YoshidaIntegrator(float frameStep) : timeStep(frameStep) {}
+
+    const char* name() const override { return "yoshida4"; }
+    void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) override;
+
+private:
+    float timeStep;
+};
+
+struct IntegratorConfig {
+    std::string name = "euler";          // "euler", "leapfrog", "verlet" or "yoshida4"
+    float timeStep = Constants::TIME_STEP; // frame step of the symplectic integrators
+    int blockLevels = 0;                 // leapfrog only: finest step is timeStep / 2^blockLevels
+    float eta = 0.02f;                   // leapfrog block timestep accuracy
+    // "float" (the integrators above), or "double", "kahan" or "mixed" for a
+    // PrecisionLeapfrogIntegrator (leapfrog without block levels only).
+    std::string precision = "float";
+};
+
+// Returns nullptr for an unknown name or precision, a non-positive step,
+// block levels asked of an integrator other than leapfrog, or a precision
+// other than float asked of anything but single-level leapfrog.
+std::unique_ptr<Integrator> createIntegrator(const IntegratorConfig& config);
+
+#endif
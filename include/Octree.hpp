@@ -0,0 +1,39 @@
+#ifndef OCTREE_HPP
+#define OCTREE_HPP
+
+#include <cstdint>
+#include <vector>
+#include "BodySystem.hpp"
+
+// Octree over a BodySystem, rebuilt from scratch every step. Bodies are
+// counting-sorted into octants so each node owns a contiguous range of
+// bodyOrder. Children of a node are stored next to each other and always
+// after their parent, so a reverse sweep over nodes visits children first.
+class Octree {
+public:
+    static const int kMaxDepth = 32;
+
+    struct Node {
+        float centerX, centerY, centerZ, halfSize;
+        float comX, comY, comZ, mass;
+        uint32_t begin, end;     // range in bodyOrder
+        int32_t firstChild = -1; // -1 for leaves
+        uint8_t childCount = 0;
+        uint8_t depth = 0;
+
+        bool isLeaf() const { return firstChild < 0; }
+    };
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> bodyOrder;
+
+    // Nodes holding more than leafCapacity bodies are split until kMaxDepth.
+    void build(const BodySystem& bodies, size_t leafCapacity);
+
+private:
+    std::vector<uint32_t> scratchOrder;
+
+    void buildNode(const BodySystem& bodies, size_t leafCapacity, uint32_t nodeIndex);
+};
+
+#endif
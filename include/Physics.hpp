@@ -0,0 +1,24 @@
+#ifndef PHYSICS_HPP
+#define PHYSICS_HPP
+
+#include "BodySystem.hpp"
+#include "Softening.hpp"
+#include "constants.hpp"
+
+namespace Physics {
+    float visualRadius(float mass, float density, float sizeRatio = Constants::DEFAULT_SIZE_RATIO);
+
+    void kick(BodySystem& bodies, float timeStepRatio = Constants::VELOCITY_STEP_RATIO);
+    void drift(BodySystem& bodies, float timeStepRatio = Constants::POSITION_STEP_RATIO);
+
+    // 1/r for the bare law, or its softened counterpart: the potential of a
+    // unit mass at distance dist, over -G.
+    double inverseDistance(double dist, const DirectKernels::Softening& softening);
+
+    // Kinetic plus pairwise potential energy, summed exactly in double. O(N^2);
+    // meant for checking integrator drift, not for every step. The potential
+    // is the one whose gradient the given softening law applies.
+    double totalEnergy(const BodySystem& bodies, const DirectKernels::Softening& softening = DirectKernels::Softening());
+}
+
+#endif
@@ -0,0 +1,98 @@
+#ifndef PHYSICS_THREAD_HPP
+#define PHYSICS_THREAD_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "PhysicsWorld.hpp"
+#include "SlotMap.hpp"
+#include "SpscQueue.hpp"
+#include "TripleBuffer.hpp"
+#include "constants.hpp"
+
+// State the renderer draws from, copied out after every tick.
+struct BodySnapshot {
+    unsigned long long stepCount = 0;
+    unsigned long long commandsApplied = 0; // commands taken from the queue so far
+    double publishedAt = 0.0; // PhysicsThread::clockSeconds() at publication
+    bool paused = true;
+    std::vector<SlotHandle> ids; // caller-chosen id of each body, or a spawned id (see kSpawnedBit)
+    std::vector<float> x, y, z, mass, radius;
+};
+
+struct PhysicsCommand {
+    enum class Type { AddBody, RemoveBody, SetPaused, SetSolver, SetIntegrator, SetCollisions };
+
+    Type type = Type::SetPaused;
+    SlotHandle id; // AddBody and RemoveBody
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+    float vx = 0.0f, vy = 0.0f, vz = 0.0f;
+    float mass = 0.0f, radius = 0.0f;
+    bool paused = true;
+    SolverConfig solver;
+    IntegratorConfig integrator;
+    CollisionConfig collisions;
+};
+
+// Runs a PhysicsWorld on its own thread at a fixed tick rate, one step per
+// tick, so the simulated time no longer depends on the frame rate. Commands
+// from the owning thread arrive through a lock-free queue and are applied
+// between ticks, in order; after every tick the state is published through
+// a triple buffer the owner reads without locking. When the thread falls more
+// than kMaxCatchUpTicks behind it drops the backlog instead of spiralling.
+// Bodies merged away disappear from the snapshot; fragments appear in it
+// under ids of their own.
+class PhysicsThread {
+public:
+    static constexpr unsigned kMaxCatchUpTicks = 8;
+    // Set in the index of ids the physics gives to fragments; caller ids
+    // must leave it clear.
+    static constexpr uint32_t kSpawnedBit = 0x80000000u;
+
+    // workerThreads is forwarded to PhysicsWorld (0 uses every hardware thread).
+    explicit PhysicsThread(double ticksPerSecond = 1.0 / Constants::TIME_STEP, size_t workerThreads = 0);
+    ~PhysicsThread();
+
+    PhysicsThread(const PhysicsThread&) = delete;
+    PhysicsThread& operator=(const PhysicsThread&) = delete;
+
+    void start();
+    void stop();
+
+    // Owner thread only. Returns false when the queue is full.
+    bool send(const PhysicsCommand& command);
+
+    // Owner thread only. snapshotPending() tells whether acquireSnapshot()
+    // would replace snapshot(); snapshot() stays valid until then.
+    bool snapshotPending() const { return snapshots.pending(); }
+    bool acquireSnapshot() { return snapshots.acquire(); }
+    const BodySnapshot& snapshot() const { return snapshots.front(); }
+
+    double tickInterval() const { return interval; }
+
+    static double clockSeconds();
+
+private:
+    PhysicsWorld world;
+    std::vector<SlotHandle> ids;      // per body
+    std::vector<uint32_t> bodyOfSlot; // body index by ids[i].index, for O(1) removal; caller ids only
+    uint32_t spawnedCount = 0;
+    unsigned long long commandsApplied = 0;
+    bool paused = true;
+    double interval;
+
+    SpscQueue<PhysicsCommand, 1024> commands;
+    TripleBuffer<BodySnapshot> snapshots;
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    void loop();
+    bool applyCommands();
+    // Brings ids in step with the bodies the last world.step() added and removed.
+    void applyEdits();
+    void setBodyOf(SlotHandle id, uint32_t body);
+    void publish();
+};
+
+#endif
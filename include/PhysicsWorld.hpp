@@ -0,0 +1,85 @@
+#ifndef PHYSICS_WORLD_HPP
+#define PHYSICS_WORLD_HPP
+
+#include <memory>
+#include <vector>
+#include "BodySystem.hpp"
+#include "CollisionDetector.hpp"
+#include "ContactResponse.hpp"
+#include "ForceSolver.hpp"
+#include "Integrator.hpp"
+#include "ThreadPool.hpp"
+
+// Steps the n-body system without any window or GL context.
+class PhysicsWorld {
+public:
+    BodySystem bodies;
+    unsigned long long stepCount = 0;
+    double simulationTime = 0.0; // advances by the integrator's timeStep per step
+
+    // threadCount 0 uses every hardware thread.
+    explicit PhysicsWorld(size_t threadCount = 0);
+
+    // Returns false and keeps the current solver if config names an unknown one.
+    bool setSolver(const SolverConfig& config);
+    const SolverConfig& solverConfig() const { return config; }
+    ForceSolver& forceSolver() { return *solver; }
+
+    // Returns false and keeps the current integrator if config is rejected by
+    // createIntegrator.
+    bool setIntegrator(const IntegratorConfig& config);
+    const IntegratorConfig& integratorConfig() const { return integratorCfg; }
+    Integrator& integrator() { return *timeIntegrator; }
+    const Integrator& integrator() const { return *timeIntegrator; }
+
+    // Returns false and keeps the current settings if config is rejected by
+    // ContactResolver::configure.
+    bool setCollisions(const CollisionConfig& config);
+    const CollisionConfig& collisionConfig() const { return collisionCfg; }
+
+    // Call after editing bodies from outside; the integrator drops the
+    // accelerations it carried over from the previous step, and the next
+    // contact test sweeps from the positions at the start of the step.
+    void bodiesChanged() { timeIntegrator->reset(); sweepX.clear(); }
+    // Call after replacing bodies together with the integrator state saved
+    // for them (see Checkpoint); the integrator keeps that state.
+    void bodiesRestored() { integratedBodies = bodies.size(); markSweepStart(); }
+
+    // Positions the next contact test sweeps the bodies from; false when it
+    // will sweep from the start of the step. Checkpoints save them so a
+    // restored run finds the same contacts.
+    bool sweepStart(const float*& startX, const float*& startY, const float*& startZ) const;
+    // Call after bodiesRestored() with arrays of bodies.size() positions.
+    void restoreSweepStart(const float* startX, const float* startY, const float* startZ);
+
+    void setThreadCount(size_t threadCount);
+    size_t threadCount() const { return pool->size(); }
+    ThreadPool& threadPool() { return *pool; }
+
+    // Pairs that touched during the last step.
+    const std::vector<ContactPair>& lastContacts() const { return contacts; }
+    // Bodies merged away or spawned by the last step; see BodyEdits.
+    const BodyEdits& lastEdits() const { return edits; }
+
+    void step();
+
+private:
+    SolverConfig config;
+    std::unique_ptr<ForceSolver> solver;
+    IntegratorConfig integratorCfg;
+    std::unique_ptr<Integrator> timeIntegrator;
+    size_t integratedBodies = 0;
+    std::unique_ptr<ThreadPool> pool;
+    CollisionDetector collisionDetector;
+    std::vector<ContactPair> contacts;
+    CollisionConfig collisionCfg;
+    ContactResolver resolver;
+    BodyEdits edits;
+    // Positions at the last contact stage; each contact test sweeps the
+    // bodies from there, so none can tunnel through another in one step.
+    std::vector<float> sweepX, sweepY, sweepZ;
+
+    void markSweepStart();
+};
+
+#endif
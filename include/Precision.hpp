@@ -0,0 +1,110 @@
+#ifndef PRECISION_HPP
+#define PRECISION_HPP
+
+#include <cstddef>
+#include "BodySystem.hpp"
+#include "Integrator.hpp"
+
+// Compile-time precision policies for the direct-sum force loop and the
+// leapfrog update. Each policy names
+//   Position  - type positions and velocities are kept in between steps,
+//   Real      - type of the pairwise force math (deltas, r^2, 1/r^3),
+//   Sum       - accumulator for the per-body force sums,
+//   kCompensated - whether position and velocity updates carry a Kahan term.
+// The loops are instantiated once per policy, so none of them branch on the
+// precision at run time.
+
+template <typename T>
+struct PlainSum {
+    T sum = T(0);
+    void add(T value) { sum += value; }
+    T value() const { return sum; }
+};
+
+// Kahan-Babuska-Neumaier: the carry keeps the low bits lost by each add.
+template <typename T>
+struct CompensatedSum {
+    T sum = T(0);
+    T carry = T(0);
+    void add(T value) {
+        T total = sum + value;
+        if ((sum < T(0) ? -sum : sum) >= (value < T(0) ? -value : value)) carry += (sum - total) + value;
+        else carry += (value - total) + sum;
+        sum = total;
+    }
+    T value() const { return sum + carry; }
+};
+
+struct FloatPrecision {
+    typedef float Position;
+    typedef float Real;
+    typedef PlainSum<float> Sum;
+    static constexpr bool kCompensated = false;
+    static const char* name() { return "float"; }
+};
+
+struct DoublePrecision {
+    typedef double Position;
+    typedef double Real;
+    typedef PlainSum<double> Sum;
+    static constexpr bool kCompensated = false;
+    static const char* name() { return "double"; }
+};
+
+// Float math throughout, compensated force sums and state updates.
+struct KahanPrecision {
+    typedef float Position;
+    typedef float Real;
+    typedef CompensatedSum<float> Sum;
+    static constexpr bool kCompensated = true;
+    static const char* name() { return "kahan"; }
+};
+
+// Double positions and velocities; deltas are rounded to float before the
+// force math, which is where most of the pair cost is.
+struct MixedPrecision {
+    typedef double Position;
+    typedef float Real;
+    typedef PlainSum<float> Sum;
+    static constexpr bool kCompensated = false;
+    static const char* name() { return "mixed"; }
+};
+
+namespace PrecisionKernels {
+    // Writes ax/ay/az[i] (G applied) for i in [begin, end) from the pull of
+    // all n bodies, one-sided, with positions of the policy's type.
+    template <class Policy>
+    void accumulateRows(const typename Policy::Position* x, const typename Policy::Position* y,
+                        const typename Policy::Position* z, const float* mass, size_t n,
+                        size_t begin, size_t end, float* ax, float* ay, float* az);
+}
+
+// Kick-drift-kick leapfrog whose state lives in Policy::Position between
+// steps; BodySystem keeps the rounded floats for the renderer, collisions and
+// the tree solvers. With the unsoftened direct solver the forces come from
+// PrecisionKernels on the full-precision positions, otherwise from the solver
+// on the rounded ones. Velocities changed by the contact stage are picked up
+// again after it. Only the primed flag goes into checkpoints; a restored run
+// restarts the high-precision state from the stored floats.
+template <class Policy>
+class PrecisionLeapfrogIntegrator : public Integrator {
+public:
+    explicit PrecisionLeapfrogIntegrator(float frameStep) : timeStep(frameStep) {}
+
+    const char* name() const override { return "leapfrog"; }
+    void step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) override;
+
+private:
+    typedef typename Policy::Position Position;
+
+    float timeStep;
+    AlignedVector<Position> x, y, z, vx, vy, vz;
+    AlignedVector<Position> carryX, carryY, carryZ, carryVx, carryVy, carryVz; // compensated policies only
+
+    void seed(const BodySystem& bodies);
+    void evaluate(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool);
+    void kick(const BodySystem& bodies, Position dt);
+    void drift(Position dt);
+};
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Scoped CPU profiler. PROFILE_ZONE("name") times the enclosing block and
+// appends one event to a ring buffer owned by the calling thread, so
+// recording never takes a lock; readers copy the rings on demand. Zone names
+// must be string literals (only the pointer is stored).
+//
+// The macros expand to nothing unless GRAVITY_PROFILE is defined (the
+// GRAVITY_PROFILE CMake option, always on in Debug builds), so zones can stay
+// in the hot paths of release builds.
+
+struct ProfileEvent {
+    const char* name = nullptr;
+    uint64_t start = 0; // Profiler::now() at zone entry
+    uint64_t end = 0;
+};
+
+// Durations of recent events with one name, in milliseconds.
+struct ProfileStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double p50 = 0.0;
+    double p99 = 0.0;
+};
+
+class Profiler {
+public:
+    static constexpr size_t kRingSize = 1 << 14; // events kept per thread
+
+    class Zone {
+    public:
+        explicit Zone(const char* zoneName) : name(zoneName), start(Profiler::now()) {}
+        ~Zone() { Profiler::record(name, start, Profiler::now()); }
+
+        Zone(const Zone&) = delete;
+        Zone& operator=(const Zone&) = delete;
+
+    private:
+        const char* name;
+        uint64_t start;
+    };
+
+    // Monotonic nanoseconds.
+    static uint64_t now();
+    static void record(const char* name, uint64_t start, uint64_t end);
+    // Labels the calling thread in exported traces.
+    static void setThreadName(const char* name);
+
+    // Durations of the latest `window` events called `name` across all threads.
+    static ProfileStats stats(const char* name, size_t window = 256);
+
+    // Writes every buffered event as Chrome trace JSON (chrome://tracing,
+    // ui.perfetto.dev). Returns false if the file cannot be written.
+    static bool writeChromeTrace(const std::string& path);
+
+private:
+    struct ThreadEvents {
+        std::string threadName;
+        uint32_t threadId;
+        std::vector<ProfileEvent> events;
+    };
+    static void collect(std::vector<ThreadEvents>& threads);
+};
+
+#ifdef GRAVITY_PROFILE
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_THREAD(name) Profiler::setThreadName(name)
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_THREAD(name) ((void)0)
+#endif
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "Shader.hpp"
+
+enum class BlendMode : uint8_t { Opaque, Alpha };
+
+struct DrawCall {
+    const Shader* shader = nullptr;
+    GLuint vao = 0;
+    GLuint bufferTexture = 0;       // bound to texture unit 0 as GL_TEXTURE_BUFFER
+    BlendMode blend = BlendMode::Opaque;
+    GLenum primitive = GL_TRIANGLES;
+    GLsizei count = 0;              // vertices, or indices when indexed
+    bool indexed = false;           // GL_UNSIGNED_INT elements from the VAO's EBO
+    GLsizei instances = 1;
+    std::function<void()> uniforms; // per-draw uniforms, run with shader bound
+};
+
+// Collects a frame's draws and issues them sorted by blend mode, program,
+// VAO and texture, so consecutive draws that share state skip the rebind.
+// Opaque draws go first so translucent ones blend over them. View and
+// projection live in one uniform buffer (block "Frame", see Shader) shared
+// by every program instead of being set per draw.
+class RenderQueue {
+public:
+    RenderQueue() {}
+    ~RenderQueue();
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    // Needs a current GL context.
+    void setupOpenGLResources();
+    void setFrame(const glm::mat4& view, const glm::mat4& projection);
+    void submit(DrawCall call);
+    void flush();
+
+    // State changes issued by the last flush, for profiling.
+    size_t programBinds() const { return programChanges; }
+    size_t vaoBinds() const { return vaoChanges; }
+
+private:
+    GLuint frameBuffer = 0;
+    std::vector<DrawCall> calls;
+    std::vector<uint32_t> order;
+    size_t programChanges = 0;
+    size_t vaoChanges = 0;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SCENARIOS_HPP
+#define SCENARIOS_HPP
+
+#include <cstdint>
+#include <string>
+#include "BodySystem.hpp"
+#include "ThreadPool.hpp"
+
+struct ScenarioConfig {
+    std::string name = "default"; // "default", "plummer", "disk", "cube", "clusters" or "planetary"
+    size_t bodyCount = 10000;     // ignored by "default"
+    uint64_t seed = 1;
+    float scale = 5000.0f;        // Plummer radius, disk scale length, cube half-size or outer orbit
+    float totalMass = 1.989e25f;  // of the whole system, central bodies included
+    float density = 5515.0f;      // sets each body's radius through Physics::visualRadius
+};
+
+namespace Scenarios {
+    // The star with two planets that the viewer starts with.
+    void loadDefault(BodySystem& bodies);
+
+    // Replaces bodies with config's scenario, filled in parallel straight
+    // into the body arrays. Bodies are generated in fixed blocks, each with
+    // its own random stream derived from the seed and the block index, so
+    // the result depends only on config and not on the thread count.
+    // Returns false and leaves bodies untouched for an unknown name.
+    //   plummer   - Plummer sphere in virial equilibrium (Aarseth, Henon and
+    //               Wielen sampling), radii capped at 10 scale lengths.
+    //   disk      - exponential disk on near-circular orbits around a
+    //               central bulge body holding a fifth of the mass.
+    //   cube      - uniform cold cube of equal masses.
+    //   clusters  - two Plummer spheres 6 scale lengths apart, falling
+    //               towards each other on a bound orbit.
+    //   planetary - one star and bodyCount - 1 planetesimals on slightly
+    //               eccentric, inclined orbits between 0.2 and 1 scale.
+    bool generate(const ScenarioConfig& config, BodySystem& bodies, ThreadPool& pool);
+}
+
+#endif
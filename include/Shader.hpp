@@ -4,9 +4,14 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 #include <string>
+#include <unordered_map>
 
 class Shader {
 public:
+    // Uniform block "Frame" (view, projection) is bound to this binding point
+    // in every program that declares it; RenderQueue fills the buffer.
+    static constexpr GLuint kFrameBinding = 0;
+
     GLuint ID;
 
     Shader(const char* vertexSource, const char* fragmentSource);
@@ -18,6 +23,11 @@ public:
     Shader& operator=(Shader&&) = delete;
 
     void use() const;
+
+    // Locations are read once after linking; -1 for unknown names, which GL
+    // ignores like it does for glGetUniformLocation misses.
+    GLint uniformLocation(const std::string& name) const;
+
     void setBool(const std::string& name, bool value) const;
     void setInt(const std::string& name, int value) const;
     void setFloat(const std::string& name, float value) const;
@@ -25,7 +35,17 @@ public:
     void setVec4(const std::string& name, const glm::vec4& value) const;
     void setMat4(const std::string& name, const glm::mat4& mat) const;
 
+    void setBool(GLint location, bool value) const;
+    void setInt(GLint location, int value) const;
+    void setFloat(GLint location, float value) const;
+    void setVec3(GLint location, const glm::vec3& value) const;
+    void setVec4(GLint location, const glm::vec4& value) const;
+    void setMat4(GLint location, const glm::mat4& mat) const;
+
 private:
+    std::unordered_map<std::string, GLint> uniformLocations;
+
+    void cacheUniformLocations();
     GLuint compileShader(GLenum type, const char* source);
     void linkProgram(GLuint vertexShader, GLuint fragmentShader);
     void checkCompileErrors(GLuint shader, std::string type);
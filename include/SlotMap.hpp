@@ -0,0 +1,168 @@
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Names one element of a SlotMap. The generation changes every time the slot
+// is freed, so a handle to an erased element never resolves again, even once
+// the slot holds something else.
+struct SlotHandle {
+    static constexpr uint32_t kNone = 0xFFFFFFFFu;
+
+    uint32_t index = kNone;
+    uint32_t generation = 0;
+
+    bool valid() const { return index != kNone; }
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+// Pool of T addressed by generational handles. Elements are constructed in
+// place in fixed pages that are never moved, so pointers and references stay
+// valid until the element itself is erased, however many are added later.
+// erase() is O(1): it destroys the element and parks its slot. Parked slots
+// join the free list only at compact(), which the owner calls at a step
+// boundary; it also re-sorts the iteration order by slot so a walk over the
+// pool reads the pages front to back. Iteration visits live elements only.
+template <typename T, size_t PageSize = 1024>
+class SlotMap {
+    struct Storage {
+        alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+public:
+    template <bool Const>
+    class Iterator {
+    public:
+        typedef typename std::conditional<Const, const SlotMap*, SlotMap*>::type Map;
+        typedef typename std::conditional<Const, const T&, T&>::type Reference;
+
+        Iterator(Map owner, size_t position) : map(owner), at(position) {}
+        Reference operator*() const { return map->value(map->live[at]); }
+        Iterator& operator++() { ++at; return *this; }
+        bool operator!=(const Iterator& other) const { return at != other.at; }
+        SlotHandle handle() const { return map->handleOf(map->live[at]); }
+
+    private:
+        Map map;
+        size_t at;
+    };
+
+    SlotMap() {}
+    ~SlotMap() { clear(); }
+
+    SlotMap(const SlotMap&) = delete;
+    SlotMap& operator=(const SlotMap&) = delete;
+
+    template <typename... Args>
+    SlotHandle insert(Args&&... args) {
+        uint32_t index;
+        if (!freeSlots.empty()) {
+            index = freeSlots.back();
+            freeSlots.pop_back();
+            outOfOrder = true; // a reused slot goes behind higher ones in live
+        } else {
+            index = static_cast<uint32_t>(generations.size());
+            if (index / PageSize >= pages.size()) pages.emplace_back(new Storage[PageSize]);
+            generations.push_back(0);
+            livePosition.push_back(0);
+        }
+        new (pages[index / PageSize][index % PageSize].bytes) T(std::forward<Args>(args)...);
+        ++generations[index]; // odd while live
+        livePosition[index] = static_cast<uint32_t>(live.size());
+        live.push_back(index);
+        return handleOf(index);
+    }
+
+    // Returns false for a stale or empty handle.
+    bool erase(SlotHandle handle) {
+        if (!contains(handle)) return false;
+        const uint32_t index = handle.index;
+        value(index).~T();
+        ++generations[index];
+        const uint32_t position = livePosition[index];
+        live[position] = live.back();
+        livePosition[live[position]] = position;
+        live.pop_back();
+        parkedSlots.push_back(index);
+        return true;
+    }
+
+    bool contains(SlotHandle handle) const {
+        return handle.index < generations.size() && generations[handle.index] == handle.generation &&
+               (handle.generation & 1u) != 0;
+    }
+
+    // nullptr for a stale or empty handle.
+    T* get(SlotHandle handle) { return contains(handle) ? &value(handle.index) : nullptr; }
+    const T* get(SlotHandle handle) const { return contains(handle) ? &value(handle.index) : nullptr; }
+
+    size_t size() const { return live.size(); }
+    bool empty() const { return live.empty(); }
+    size_t capacity() const { return pages.size() * PageSize; }
+
+    // Allocates pages and bookkeeping for count elements up front.
+    void reserve(size_t count) {
+        while (capacity() < count) pages.emplace_back(new Storage[PageSize]);
+        generations.reserve(count);
+        livePosition.reserve(count);
+        live.reserve(count);
+        freeSlots.reserve(count);
+        parkedSlots.reserve(count);
+    }
+
+    // Makes the slots erased since the last call reusable and puts the
+    // iteration order back into slot order.
+    void compact() {
+        // Fresh slots are appended in slot order, so only erases and reused
+        // slots make the sort below necessary.
+        if (parkedSlots.empty() && !outOfOrder) return;
+        outOfOrder = false;
+        freeSlots.insert(freeSlots.end(), parkedSlots.begin(), parkedSlots.end());
+        parkedSlots.clear();
+        // Pop the lowest free slots first, keeping live elements packed at the front.
+        std::sort(freeSlots.begin(), freeSlots.end(), [](uint32_t a, uint32_t b) { return a > b; });
+        std::sort(live.begin(), live.end());
+        for (size_t k = 0; k < live.size(); ++k) livePosition[live[k]] = static_cast<uint32_t>(k);
+    }
+
+    // Erases every element; pages stay allocated and old handles stay stale.
+    void clear() {
+        while (!live.empty()) erase(handleOf(live.back()));
+        compact();
+    }
+
+    Iterator<false> begin() { return Iterator<false>(this, 0); }
+    Iterator<false> end() { return Iterator<false>(this, live.size()); }
+    Iterator<true> begin() const { return Iterator<true>(this, 0); }
+    Iterator<true> end() const { return Iterator<true>(this, live.size()); }
+
+private:
+    std::vector<std::unique_ptr<Storage[]>> pages;
+    std::vector<uint32_t> generations;  // per slot; odd while live
+    std::vector<uint32_t> livePosition; // per live slot, its place in live
+    std::vector<uint32_t> live;         // live slots in iteration order
+    std::vector<uint32_t> freeSlots;    // reusable, lowest index last
+    std::vector<uint32_t> parkedSlots;  // erased since the last compact()
+    bool outOfOrder = false;            // live may not be in slot order
+
+    T& value(uint32_t index) { return *std::launder(reinterpret_cast<T*>(pages[index / PageSize][index % PageSize].bytes)); }
+    const T& value(uint32_t index) const {
+        return *std::launder(reinterpret_cast<const T*>(pages[index / PageSize][index % PageSize].bytes));
+    }
+    SlotHandle handleOf(uint32_t index) const {
+        SlotHandle handle;
+        handle.index = index;
+        handle.generation = generations[index];
+        return handle;
+    }
+};
+
+#endif
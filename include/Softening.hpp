@@ -0,0 +1,87 @@
+#ifndef SOFTENING_HPP
+#define SOFTENING_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "constants.hpp"
+
+namespace DirectKernels {
+    // How the force behaves near r = 0:
+    //   None    - bare 1/r^2, pairs closer than MIN_DISTANCE are skipped;
+    //   Plummer - m d / (r^2 + eps^2)^(3/2) everywhere;
+    //   Spline  - cubic-spline kernel (Monaghan & Lattanzio, as in GADGET),
+    //             exactly Newtonian beyond h = 2.8 eps.
+    enum class SofteningLaw { None, Plummer, Spline };
+
+    struct Softening {
+        SofteningLaw law = SofteningLaw::None;
+        float length = 0.0f; // eps in visual units; must be positive unless law is None
+    };
+
+    // Per-call constants of a law, computed once outside the pair loops.
+    struct SofteningCoefficients {
+        static constexpr float kSplineSupport = 2.8f; // h / eps
+
+        float eps2 = 0.0f;  // Plummer
+        float h2 = 0.0f;    // Spline
+        float invH = 0.0f;
+        float invH3 = 0.0f;
+
+        explicit SofteningCoefficients(const Softening& softening) {
+            if (softening.law == SofteningLaw::Plummer) {
+                eps2 = softening.length * softening.length;
+            } else if (softening.law == SofteningLaw::Spline && softening.length > 0.0f) {
+                float h = kSplineSupport * softening.length;
+                h2 = h * h;
+                invH = 1.0f / h;
+                invH3 = invH * invH * invH;
+            }
+        }
+    };
+
+    // invCube(r2) is the factor f with a = m * d * f: 1/r^3 for the bare law,
+    // the softened equivalent otherwise. Each law is a separate type, so a
+    // loop instantiated for one has no branch on the law; the selects below
+    // compile to blends. kTinyR2 keeps 1/sqrt(r^2) finite for coincident
+    // points, whose result is never the one selected.
+    template <SofteningLaw L> struct ScalarLaw;
+
+    constexpr float kTinyR2 = std::numeric_limits<float>::min();
+
+    template <> struct ScalarLaw<SofteningLaw::None> {
+        static float invCube(float r2, const SofteningCoefficients&) {
+            float invR = 1.0f / std::sqrt(std::max(r2, kTinyR2));
+            return r2 > Constants::MIN_DISTANCE2 ? invR * invR * invR : 0.0f;
+        }
+    };
+
+    template <> struct ScalarLaw<SofteningLaw::Plummer> {
+        static float invCube(float r2, const SofteningCoefficients& c) {
+            float invR = 1.0f / std::sqrt(r2 + c.eps2);
+            return invR * invR * invR;
+        }
+    };
+
+    // Polynomial coefficients of the kernel in units of 1/h^3 (Springel 2001),
+    // for u = r / h below 1/2 (inner) and between 1/2 and 1 (outer).
+    template <> struct ScalarLaw<SofteningLaw::Spline> {
+        static constexpr float kInnerC0 = 10.666666667f, kInnerC2 = -38.4f, kInnerC3 = 32.0f;
+        static constexpr float kOuterC0 = 21.333333333f, kOuterC1 = -48.0f, kOuterC2 = 38.4f, kOuterC3 = -10.666666667f;
+        static constexpr float kOuterCInv3 = -0.066666667f;
+
+        static float invCube(float r2, const SofteningCoefficients& c) {
+            float invR = 1.0f / std::sqrt(std::max(r2, kTinyR2));
+            float u = r2 * invR * c.invH;
+            float u2 = u * u, u3 = u2 * u;
+            float inner = kInnerC0 + u2 * (kInnerC2 + kInnerC3 * u);
+            float outer = kOuterC0 + kOuterC1 * u + kOuterC2 * u2 + kOuterC3 * u3;
+            // invH3 / u^3 is 1/r^3, so the outer inverse-cube term needs no divide.
+            float newton = invR * invR * invR;
+            float softened = u < 0.5f ? c.invH3 * inner : c.invH3 * outer + kOuterCInv3 * newton;
+            return r2 < c.h2 ? softened : newton;
+        }
+    };
+}
+
+#endif
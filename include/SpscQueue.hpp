@@ -0,0 +1,40 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Bounded lock-free queue for exactly one producer thread and one consumer
+// thread. Capacity must be a power of two. The head and tail counters grow
+// without wrapping and live on separate cache lines.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+    // Producer side; returns false when the queue is full.
+    bool push(T value) {
+        const size_t tail = tailCount.load(std::memory_order_relaxed);
+        if (tail - headCount.load(std::memory_order_acquire) == Capacity) return false;
+        slots[tail & (Capacity - 1)] = std::move(value);
+        tailCount.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side; returns false when the queue is empty.
+    bool pop(T& value) {
+        const size_t head = headCount.load(std::memory_order_relaxed);
+        if (head == tailCount.load(std::memory_order_acquire)) return false;
+        value = std::move(slots[head & (Capacity - 1)]);
+        headCount.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    T slots[Capacity];
+    alignas(64) std::atomic<size_t> headCount{0};
+    alignas(64) std::atomic<size_t> tailCount{0};
+};
+
+#endif
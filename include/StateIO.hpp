@@ -0,0 +1,14 @@
+#ifndef STATE_IO_HPP
+#define STATE_IO_HPP
+
+#include <string>
+#include "BodySystem.hpp"
+
+// Plain-text body state: one "x y z vx vy vz mass radius" line per body,
+// lines starting with '#' are comments.
+namespace StateIO {
+    bool load(const std::string& path, BodySystem& bodies);
+    bool save(const std::string& path, const BodySystem& bodies, unsigned long long stepCount);
+}
+
+#endif
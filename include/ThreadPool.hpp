@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers for data-parallel loops. Each parallelFor hands every
+// worker an equal slice of task indices; a worker that runs out steals half
+// of another worker's remaining slice. Slices are packed into one atomic word
+// per worker, so claiming and stealing never take a lock.
+class ThreadPool {
+public:
+    // 0 picks std::thread::hardware_concurrency(). The calling thread counts
+    // as worker 0, so ThreadPool(1) runs everything inline.
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workerCount; }
+
+    // Runs body(task, worker) for every task in [0, taskCount) and returns
+    // when all of them have finished. worker is in [0, size()).
+    void parallelFor(size_t taskCount, const std::function<void(size_t, size_t)>& body);
+
+private:
+    struct alignas(64) WorkRange {
+        std::atomic<uint64_t> range{0}; // begin in the low 32 bits, end in the high 32 bits
+    };
+
+    size_t workerCount;
+    std::vector<std::thread> threads;
+    std::unique_ptr<WorkRange[]> ranges;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    uint64_t generation = 0;
+    size_t activeWorkers = 0;
+    bool stopping = false;
+    const std::function<void(size_t, size_t)>* job = nullptr;
+
+    void workerLoop(size_t worker);
+    void runTasks(size_t worker);
+    bool popTask(size_t worker, uint32_t& task);
+    bool stealTasks(size_t worker);
+};
+
+#endif
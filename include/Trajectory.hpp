@@ -0,0 +1,111 @@
+#ifndef TRAJECTORY_HPP
+#define TRAJECTORY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BodySystem.hpp"
+#include "SpscQueue.hpp"
+
+// Trajectory files: a small header, then self-contained chunks of up to
+// framesPerChunk frames with a fixed body count. Inside a chunk the data is
+// columnar: step numbers, times, mass and radius of the first frame, then
+// every frame's x, then y, then z. Positions are quantized to 16 bits over
+// the chunk's bounding box, so the error is at most extent / 131070 per axis.
+// A run cut short leaves every completed chunk readable.
+struct TrajectoryFrame {
+    unsigned long long step = 0;
+    double time = 0.0;
+    std::vector<float> x, y, z, mass, radius;
+};
+
+// Records frames from the stepping thread and writes them on a background
+// I/O thread. record() copies the positions into a recycled frame and hands
+// it over through a lock-free queue; it never waits for the disk. When the
+// writer falls kQueueFrames behind, frames are dropped and counted.
+class TrajectoryRecorder {
+public:
+    static constexpr uint32_t kFramesPerChunk = 64;
+    static constexpr size_t kQueueFrames = 256;
+
+    TrajectoryRecorder() {}
+    ~TrajectoryRecorder() { close(); }
+
+    TrajectoryRecorder(const TrajectoryRecorder&) = delete;
+    TrajectoryRecorder& operator=(const TrajectoryRecorder&) = delete;
+
+    // stepStride is informational: the step count between recorded frames.
+    bool open(const std::string& path, uint32_t stepStride);
+    void record(const BodySystem& bodies, unsigned long long step, double time);
+    // Writes the last partial chunk and stops the I/O thread. Returns false
+    // if any write failed.
+    bool close();
+
+    unsigned long long droppedFrames() const { return dropped; }
+
+private:
+    typedef std::unique_ptr<TrajectoryFrame> FramePtr;
+
+    std::ofstream out;
+    std::thread writer;
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> failed{false};
+    SpscQueue<FramePtr, kQueueFrames> pending; // recorder -> writer
+    SpscQueue<FramePtr, kQueueFrames> spare;   // writer -> recorder, for reuse
+    unsigned long long dropped = 0;
+
+    std::vector<FramePtr> chunk;               // writer thread only
+    std::vector<char> encoded;
+
+    void writerLoop();
+    void flushChunk();
+};
+
+// Read-only view of a trajectory file through mmap. Chunks are indexed once
+// on open; reading a frame dequantizes one chunk column per axis.
+class TrajectoryReader {
+public:
+    TrajectoryReader() {}
+    ~TrajectoryReader() { close(); }
+
+    TrajectoryReader(const TrajectoryReader&) = delete;
+    TrajectoryReader& operator=(const TrajectoryReader&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    size_t frameCount() const { return frames.size(); }
+    uint32_t stepStride() const { return stride; }
+    size_t bodyCount(size_t frame) const;
+    unsigned long long step(size_t frame) const;
+    double time(size_t frame) const;
+    // Mass and radius as of the first frame of frame's chunk.
+    const float* mass(size_t frame) const;
+    const float* radius(size_t frame) const;
+    // Resizes and fills x, y and z with frame's positions.
+    void positions(size_t frame, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z) const;
+
+private:
+    struct ChunkView {
+        const char* base;
+        uint32_t frameCount;
+        uint64_t bodyCount;
+        float origin[3], scale[3];
+    };
+    struct FrameRef {
+        uint32_t chunk;
+        uint32_t index; // within the chunk
+    };
+
+    const char* mapping = nullptr;
+    size_t mappedSize = 0;
+    uint32_t stride = 0;
+    std::vector<ChunkView> chunks;
+    std::vector<FrameRef> frames;
+};
+
+#endif
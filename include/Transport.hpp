@@ -0,0 +1,102 @@
+#ifndef TRANSPORT_HPP
+#define TRANSPORT_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+struct TransportConfig {
+    std::string name = "shm";   // "shm" or "socket"
+    std::string address;        // shm: segment name ("/gravity-run"); socket: path prefix ("/tmp/gravity-run")
+    int rank = 0;
+    int size = 1;
+    size_t channelBytes = 1 << 20; // shm: ring size per ordered pair of processes
+    double timeoutSeconds = 30.0;  // for the other processes to show up
+};
+
+// Moves byte messages between the processes of one distributed run,
+// numbered 0..size()-1. The one primitive is exchange(): every process
+// hands over one message per peer, possibly empty, and gets one back from
+// each. All processes call it the same number of times in the same order,
+// so every call also acts as a barrier. Sends and receives make progress
+// together, so no exchange can deadlock on full buffers, however large.
+class Transport {
+public:
+    virtual ~Transport() {}
+    virtual const char* name() const = 0;
+
+    int rank() const { return self; }
+    int size() const { return count; }
+
+    // outgoing[p] goes to process p (outgoing[rank()] is copied locally) and
+    // incoming[p] receives what p sent here. Returns false if a peer is gone;
+    // the transport is unusable afterwards.
+    virtual bool exchange(const std::vector<std::vector<char>>& outgoing, std::vector<std::vector<char>>& incoming) = 0;
+
+    // all[p] is the message process p passed.
+    bool allGather(const std::vector<char>& mine, std::vector<std::vector<char>>& all);
+
+protected:
+    int self = 0;
+    int count = 1;
+};
+
+// Full mesh of Unix domain stream sockets. Process r listens on
+// "<address>.<r>.sock", connects to every lower rank and accepts every
+// higher one; the socket files are removed once the mesh is up.
+class SocketTransport : public Transport {
+public:
+    SocketTransport() {}
+    ~SocketTransport() override;
+
+    SocketTransport(const SocketTransport&) = delete;
+    SocketTransport& operator=(const SocketTransport&) = delete;
+
+    const char* name() const override { return "socket"; }
+    bool connect(const TransportConfig& config);
+    bool exchange(const std::vector<std::vector<char>>& outgoing, std::vector<std::vector<char>>& incoming) override;
+
+private:
+    std::vector<int> peers; // stream per rank, -1 for this process
+};
+
+// One POSIX shared memory segment with a single-producer single-consumer
+// byte ring for every ordered pair of processes. Rank 0 creates it and
+// unlinks the name once everyone has attached, so nothing is left behind.
+// A process stuck waiting checks about once a second whether the peers it
+// waits for still exist, so a crashed peer fails the exchange.
+class SharedMemoryTransport : public Transport {
+public:
+    SharedMemoryTransport() {}
+    ~SharedMemoryTransport() override;
+
+    SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+    SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+
+    const char* name() const override { return "shm"; }
+    bool connect(const TransportConfig& config);
+    bool exchange(const std::vector<std::vector<char>>& outgoing, std::vector<std::vector<char>>& incoming) override;
+
+private:
+    struct Channel {
+        alignas(64) std::atomic<uint64_t> written; // bytes ever produced
+        alignas(64) std::atomic<uint64_t> read;    // bytes ever consumed
+    };
+
+    void* mapping = nullptr;
+    size_t mappingBytes = 0;
+    size_t ringBytes = 0;
+
+    int32_t* processIds() const;
+    Channel& channel(int from, int to) const;
+    char* ring(int from, int to) const;
+};
+
+// Joins the run described by config; blocks until every process is
+// connected or the timeout passes. nullptr for an unknown name or failure.
+std::unique_ptr<Transport> createTransport(const TransportConfig& config);
+
+#endif
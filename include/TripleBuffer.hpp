@@ -0,0 +1,42 @@
+#ifndef TRIPLE_BUFFER_HPP
+#define TRIPLE_BUFFER_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// Hands the latest value from one writer thread to one reader thread. The
+// writer fills back() and publish() swaps it with the shared middle slot;
+// the reader's acquire() swaps the middle slot into front() when something
+// new was published. Each side touches a single atomic byte and neither can
+// block or overwrite the slot the other one is using.
+template <typename T>
+class TripleBuffer {
+public:
+    // Writer side.
+    T& back() { return slots[backIndex]; }
+    void publish() {
+        backIndex = middle.exchange(static_cast<uint8_t>(backIndex | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    // Reader side.
+    bool pending() const { return (middle.load(std::memory_order_acquire) & kFresh) != 0; }
+    // Returns false and keeps front() when nothing was published since the
+    // last call.
+    bool acquire() {
+        if (!pending()) return false;
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static constexpr uint8_t kFresh = 4;
+    static constexpr uint8_t kIndexMask = 3;
+
+    T slots[3];
+    alignas(64) std::atomic<uint8_t> middle{1};
+    alignas(64) uint8_t backIndex = 0;
+    alignas(64) uint8_t frontIndex = 2;
+};
+
+#endif
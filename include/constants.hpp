@@ -1,14 +1,34 @@
 #ifndef CONSTANTS_HPP
 #define CONSTANTS_HPP
 
-#include <cmath> 
+#include <cmath>
 
+// Every scale factor is folded at compile time, so the hot loops only see
+// ready-made constants in visual units.
 namespace Constants {
-    const double G = 6.6743e-11; 
-    const float C = 299792458.0f;
-    const float DEFAULT_INIT_MASS = static_cast<float>(std::pow(10, 22));
-    const float DEFAULT_SIZE_RATIO = 30000.0f;
-    const float PI = 3.14159265359f;
+    constexpr double G = 6.6743e-11;
+    constexpr float C = 299792458.0f;
+    constexpr float DEFAULT_INIT_MASS = 1e22f;
+    constexpr float DEFAULT_SIZE_RATIO = 30000.0f;
+    constexpr float PI = 3.14159265359f;
+    constexpr float DEFAULT_DENSITY = 3344.0f;
+    // One visual unit is one kilometre.
+    constexpr float METERS_PER_UNIT = 1000.0f;
+    constexpr float UNITS_PER_METER = static_cast<float>(1.0 / METERS_PER_UNIT);
+    // G with the unit conversion of both distance factors folded in, so that
+    // a = G_UNITS * m * d / |d|^3 for d in visual units.
+    constexpr float G_UNITS = static_cast<float>(G / (static_cast<double>(METERS_PER_UNIT) * METERS_PER_UNIT));
+    // Schwarzschild radius per kilogram, 2G / c^2, in metres.
+    constexpr float SCHWARZSCHILD_PER_KG = static_cast<float>(2.0 * G / (static_cast<double>(C) * C));
+    // Pairs closer than this exert no force unless a softening law is used.
+    constexpr float MIN_DISTANCE = 0.001f;
+    constexpr float MIN_DISTANCE2 = MIN_DISTANCE * MIN_DISTANCE;
+    // Per-step divisors applied to acceleration and velocity.
+    constexpr float VELOCITY_STEP_RATIO = 96.0f;
+    constexpr float POSITION_STEP_RATIO = 94.0f;
+    // Frame step of the symplectic integrators, between the two ratios above
+    // so scenes keep roughly their legacy pace.
+    constexpr float TIME_STEP = 1.0f / 95.0f;
 }
 
-#endif 
\ No newline at end of file
+#endif
@@ -3,9 +3,13 @@
 
 #include <glm/glm.hpp>
 #include <GL/glew.h>
+#include <vector>
 
 namespace Utils {
     glm::vec3 sphericalToCartesian(float r, float theta, float phi);
+    // Indexed unit sphere: one vertex per pole plus stacks-1 rings of sectors
+    // vertices, 2*sectors*(stacks-1) triangles. Positions double as normals.
+    void buildUnitSphere(int stacks, int sectors, std::vector<float>& vertices, std::vector<GLuint>& indices);
     void createVBOVAO(GLuint& VAO, GLuint& VBO, const float* vertices, size_t vertexCount, GLenum usage = GL_STATIC_DRAW);
 }
 
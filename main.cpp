@@ -1,8 +1,20 @@
 #include "GravitySimulation.hpp" 
 #include <iostream>              
+#include <cstring>
+#include <string>
 
-int main() {
-    GravitySimulation sim(1280, 720, "Gravity Simulation OOP");
+int main(int argc, char** argv) {
+    std::string replayPath;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--replay trajectory.bin]" << std::endl;
+            return -1;
+        }
+    }
+
+    GravitySimulation sim(1280, 720, "Gravity Simulation OOP", replayPath);
     
     if (!sim.running) { 
         std::cerr << "GravitySimulation initialization failed. Exiting." << std::endl;
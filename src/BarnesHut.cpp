@@ -0,0 +1,100 @@
+#include "BarnesHut.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+using DirectKernels::SofteningLaw;
+
+namespace {
+    const size_t kWalkChunk = 256;
+
+    template <SofteningLaw L>
+    inline void addPointMass(const DirectKernels::SofteningCoefficients& c, float dx, float dy, float dz, float m,
+                             float& accX, float& accY, float& accZ) {
+        float scale = Constants::G_UNITS * m * DirectKernels::ScalarLaw<L>::invCube(dx * dx + dy * dy + dz * dz, c);
+        accX += dx * scale;
+        accY += dy * scale;
+        accZ += dz * scale;
+    }
+}
+
+BarnesHutSolver::BarnesHutSolver(float openingAngle, size_t maxLeafBodies)
+    : theta(openingAngle), leafCapacity(maxLeafBodies > 0 ? maxLeafBodies : 1) {}
+
+void BarnesHutSolver::accelerationsFor(BodySystem& bodies, ThreadPool& pool, const uint32_t* targets, size_t count) {
+    switch (softening.law) {
+        case SofteningLaw::Plummer: walk<SofteningLaw::Plummer>(bodies, pool, targets, count); break;
+        case SofteningLaw::Spline: walk<SofteningLaw::Spline>(bodies, pool, targets, count); break;
+        default: walk<SofteningLaw::None>(bodies, pool, targets, count); break;
+    }
+}
+
+template <SofteningLaw L>
+void BarnesHutSolver::walk(BodySystem& bodies, ThreadPool& pool, const uint32_t* targets, size_t count) {
+    const DirectKernels::SofteningCoefficients c(softening);
+    pool.parallelFor((count + kWalkChunk - 1) / kWalkChunk, [&](size_t chunk, size_t) {
+        size_t end = std::min(count, (chunk + 1) * kWalkChunk);
+        for (size_t t = chunk * kWalkChunk; t < end; ++t) {
+            uint32_t i = targets ? targets[t] : static_cast<uint32_t>(t);
+            float accX = 0.0f, accY = 0.0f, accZ = 0.0f;
+            accelerationAt<L>(c, bodies, i, accX, accY, accZ);
+            bodies.ax[i] = accX;
+            bodies.ay[i] = accY;
+            bodies.az[i] = accZ;
+        }
+    });
+}
+
+void BarnesHutSolver::computeAccelerations(BodySystem& bodies, ThreadPool& pool) {
+    const size_t n = bodies.size();
+    if (n == 0) return;
+
+    tree.build(bodies, leafCapacity);
+    accelerationsFor(bodies, pool, nullptr, n);
+}
+
+void BarnesHutSolver::computeAccelerationsFor(BodySystem& bodies, ThreadPool& pool, const std::vector<uint32_t>& targets) {
+    if (bodies.size() == 0) return;
+
+    tree.build(bodies, leafCapacity);
+    accelerationsFor(bodies, pool, targets.data(), targets.size());
+}
+
+template <SofteningLaw L>
+void BarnesHutSolver::accelerationAt(const DirectKernels::SofteningCoefficients& c, const BodySystem& bodies, uint32_t i,
+                                     float& accX, float& accY, float& accZ) const {
+    const float px = bodies.x[i], py = bodies.y[i], pz = bodies.z[i];
+    const float theta2 = theta * theta;
+
+    uint32_t stack[Octree::kMaxDepth * 7 + 8];
+    int top = 0;
+    stack[top++] = 0;
+
+    while (top > 0) {
+        const Octree::Node& node = tree.nodes[stack[--top]];
+
+        if (node.isLeaf()) {
+            for (uint32_t k = node.begin; k < node.end; ++k) {
+                uint32_t j = tree.bodyOrder[k];
+                if (j == i) continue;
+                addPointMass<L>(c, bodies.x[j] - px, bodies.y[j] - py, bodies.z[j] - pz, bodies.mass[j], accX, accY, accZ);
+            }
+            continue;
+        }
+
+        float dx = node.comX - px, dy = node.comY - py, dz = node.comZ - pz;
+        float dist2 = dx * dx + dy * dy + dz * dz;
+        float size = 2.0f * node.halfSize;
+        // A cell around body i is always opened: above theta = 1/sqrt(3) its
+        // centre of mass can pass the test and i would pull on itself.
+        if (size * size < theta2 * dist2 &&
+            !(std::fabs(px - node.centerX) <= node.halfSize && std::fabs(py - node.centerY) <= node.halfSize &&
+              std::fabs(pz - node.centerZ) <= node.halfSize)) {
+            addPointMass<L>(c, dx, dy, dz, node.mass, accX, accY, accZ);
+        } else {
+            for (uint8_t c = 0; c < node.childCount; ++c) {
+                stack[top++] = static_cast<uint32_t>(node.firstChild + c);
+            }
+        }
+    }
+}
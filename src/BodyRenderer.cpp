@@ -0,0 +1,252 @@
+#include "BodyRenderer.hpp"
+#include "utils.hpp"
+#include "constants.hpp"
+
+namespace {
+    const char* kVertexShader = R"glsl(
+        #version 330 core
+        layout(location=0) in vec3 aPos;
+        layout(location=1) in vec4 instancePositionRadius;
+        layout(location=2) in vec4 instanceColor;
+        layout(location=3) in float instanceGlow;
+        layout(std140) uniform Frame {
+            mat4 view;
+            mat4 projection;
+        };
+        out float lightIntensity;
+        flat out vec4 objectColor;
+        flat out int glow;
+        void main() {
+            vec3 worldPos = instancePositionRadius.xyz + aPos * instancePositionRadius.w;
+            gl_Position = projection * view * vec4(worldPos, 1.0);
+            // aPos lies on the unit sphere, so it is also the normal.
+            vec3 normal = normalize(aPos);
+            vec3 dirToLight = normalize(-worldPos); // Light at origin
+            lightIntensity = max(dot(normal, dirToLight), 0.15); // Ambient term 0.15
+            objectColor = instanceColor;
+            glow = instanceGlow > 0.5 ? 1 : 0;
+        }
+    )glsl";
+
+    const char* kFragmentShader = R"glsl(
+        #version 330 core
+        in float lightIntensity;
+        flat in vec4 objectColor;
+        flat in int glow;
+        out vec4 FragColor;
+        void main() {
+            if (glow != 0) {
+                FragColor = vec4(objectColor.rgb * 2.0, objectColor.a); // Simple glow: brighten and keep alpha
+            } else {
+                float fade = smoothstep(0.0, 1.0, lightIntensity);
+                FragColor = vec4(objectColor.rgb * fade, objectColor.a);
+            }
+        }
+    )glsl";
+
+    // Camera-facing quad around the sphere, in view space. Half-size 1.5r
+    // covers the silhouette's off-axis stretch at any field of view we use;
+    // impostors are only drawn for bodies a few pixels across.
+    const char* kImpostorVertexShader = R"glsl(
+        #version 330 core
+        layout(location=0) in vec3 aPos;
+        layout(location=1) in vec4 instancePositionRadius;
+        layout(location=2) in vec4 instanceColor;
+        layout(location=3) in float instanceGlow;
+        layout(std140) uniform Frame {
+            mat4 view;
+            mat4 projection;
+        };
+        out vec3 viewPos;
+        flat out vec3 sphereCenter;
+        flat out float sphereRadius;
+        flat out vec3 lightPos;
+        flat out vec4 objectColor;
+        flat out int glow;
+        void main() {
+            sphereCenter = (view * vec4(instancePositionRadius.xyz, 1.0)).xyz;
+            sphereRadius = instancePositionRadius.w;
+            viewPos = sphereCenter + vec3(aPos.xy * 1.5 * sphereRadius, 0.0);
+            gl_Position = projection * vec4(viewPos, 1.0);
+            lightPos = (view * vec4(0.0, 0.0, 0.0, 1.0)).xyz; // Light at origin
+            objectColor = instanceColor;
+            glow = instanceGlow > 0.5 ? 1 : 0;
+        }
+    )glsl";
+
+    // Ray-casts the sphere from the eye, writes the hit's depth and lights it
+    // like the mesh shader, per pixel instead of per vertex.
+    const char* kImpostorFragmentShader = R"glsl(
+        #version 330 core
+        in vec3 viewPos;
+        flat in vec3 sphereCenter;
+        flat in float sphereRadius;
+        flat in vec3 lightPos;
+        flat in vec4 objectColor;
+        flat in int glow;
+        layout(std140) uniform Frame {
+            mat4 view;
+            mat4 projection;
+        };
+        out vec4 FragColor;
+        void main() {
+            vec3 rayDir = normalize(viewPos);
+            float b = dot(rayDir, sphereCenter);
+            float h = b * b - dot(sphereCenter, sphereCenter) + sphereRadius * sphereRadius;
+            if (h < 0.0) discard;
+            vec3 hit = rayDir * (b - sqrt(h));
+
+            vec4 clip = projection * vec4(hit, 1.0);
+            gl_FragDepth = 0.5 * (clip.z / clip.w) * (gl_DepthRange.far - gl_DepthRange.near)
+                         + 0.5 * (gl_DepthRange.far + gl_DepthRange.near);
+
+            if (glow != 0) {
+                FragColor = vec4(objectColor.rgb * 2.0, objectColor.a);
+            } else {
+                vec3 normal = (hit - sphereCenter) / sphereRadius;
+                float lightIntensity = max(dot(normal, normalize(lightPos - hit)), 0.15);
+                float fade = smoothstep(0.0, 1.0, lightIntensity);
+                FragColor = vec4(objectColor.rgb * fade, objectColor.a);
+            }
+        }
+    )glsl";
+
+    struct Frustum {
+        glm::vec4 planes[6];
+
+        // Planes of clip = projection * view, normals pointing inwards.
+        explicit Frustum(const glm::mat4& clip) {
+            glm::vec4 rows[4];
+            for (int i = 0; i < 4; ++i) rows[i] = glm::vec4(clip[0][i], clip[1][i], clip[2][i], clip[3][i]);
+            for (int i = 0; i < 3; ++i) {
+                planes[2 * i] = rows[3] + rows[i];
+                planes[2 * i + 1] = rows[3] - rows[i];
+            }
+            for (glm::vec4& plane : planes) {
+                plane /= glm::length(glm::vec3(plane.x, plane.y, plane.z));
+            }
+        }
+
+        bool intersects(const glm::vec3& center, float radius) const {
+            for (const glm::vec4& plane : planes) {
+                if (plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w < -radius) return false;
+            }
+            return true;
+        }
+    };
+}
+
+BodyRenderer::~BodyRenderer() {
+    for (Level& level : levels) releaseLevel(level);
+    releaseLevel(impostors);
+    delete shader;
+    delete impostorShader;
+}
+
+void BodyRenderer::releaseLevel(Level& level) {
+    if (level.VAO != 0) glDeleteVertexArrays(1, &level.VAO);
+    if (level.VBO != 0) glDeleteBuffers(1, &level.VBO);
+    if (level.EBO != 0) glDeleteBuffers(1, &level.EBO);
+    if (level.instanceVBO != 0) glDeleteBuffers(1, &level.instanceVBO);
+}
+
+void BodyRenderer::setupLevel(Level& level, const std::vector<float>& vertices, const std::vector<GLuint>& indices) {
+    Utils::createVBOVAO(level.VAO, level.VBO, vertices.data(), vertices.size());
+    level.indexCount = static_cast<GLsizei>(indices.size());
+
+    glBindVertexArray(level.VAO);
+    glGenBuffers(1, &level.EBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, level.EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+    glGenBuffers(1, &level.instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, level.instanceVBO);
+    const GLsizei stride = kInstanceFloats * sizeof(float);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride, (void*)0);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, (void*)(4 * sizeof(float)));
+    glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, stride, (void*)(8 * sizeof(float)));
+    for (GLuint attribute = 1; attribute <= 3; ++attribute) {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1);
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void BodyRenderer::setupOpenGLResources() {
+    if (shader) return;
+
+    std::vector<float> vertices;
+    std::vector<GLuint> indices;
+    for (int k = 0; k < kLevels; ++k) {
+        int sectors = kCoarsestSectors << k;
+        Utils::buildUnitSphere(sectors / 2, sectors, vertices, indices);
+        setupLevel(levels[k], vertices, indices);
+    }
+    setupLevel(impostors, { -1.0f, -1.0f, 0.0f,  1.0f, -1.0f, 0.0f,  1.0f, 1.0f, 0.0f,  -1.0f, 1.0f, 0.0f },
+               { 0, 1, 2, 0, 2, 3 });
+
+    shader = new Shader(kVertexShader, kFragmentShader);
+    impostorShader = new Shader(kImpostorVertexShader, kImpostorFragmentShader);
+}
+
+void BodyRenderer::submitLevel(RenderQueue& queue, Level& level, const Shader* program) {
+    if (level.instances.empty()) return;
+
+    glBindBuffer(GL_ARRAY_BUFFER, level.instanceVBO);
+    // Orphan last frame's storage rather than waiting for it to be consumed.
+    glBufferData(GL_ARRAY_BUFFER, level.instances.size() * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, level.instances.size() * sizeof(float), level.instances.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    DrawCall call;
+    call.shader = program;
+    call.vao = level.VAO;
+    call.count = level.indexCount;
+    call.indexed = true;
+    call.instances = static_cast<GLsizei>(level.instances.size() / kInstanceFloats);
+    queue.submit(std::move(call));
+}
+
+void BodyRenderer::submit(RenderQueue& queue, const SlotMap<Object>& objects,
+                          const glm::mat4& view, const glm::mat4& projection, int viewportHeight) {
+    if (!shader) return;
+
+    for (Level& level : levels) level.instances.clear();
+    impostors.instances.clear();
+    culled = 0;
+
+    const Frustum frustum(projection * view);
+    // Pixels per unit of radius at unit view depth.
+    const float pixelScale = projection[1][1] * 0.5f * static_cast<float>(viewportHeight);
+    for (const Object& obj : objects) {
+        float radius = obj.radius > 0.0f ? obj.radius : 0.001f;
+        if (!frustum.intersects(obj.position, radius)) {
+            ++culled;
+            continue;
+        }
+        float depth = -(view * glm::vec4(obj.position, 1.0f)).z;
+
+        Level* target = &levels[kLevels - 1];
+        if (depth > radius) {
+            float screenRadius = pixelScale * radius / depth;
+            if (screenRadius < kImpostorPixels) {
+                target = &impostors;
+            } else {
+                // A silhouette of n sectors has edges of 2*pi*r/n pixels.
+                float sectorsWanted = 2.0f * Constants::PI * screenRadius / kEdgePixels;
+                int k = 0;
+                while (k < kLevels - 1 && static_cast<float>(kCoarsestSectors << k) < sectorsWanted) ++k;
+                target = &levels[k];
+            }
+        }
+
+        target->instances.insert(target->instances.end(),
+                                 { obj.position.x, obj.position.y, obj.position.z, radius,
+                                   obj.color.x, obj.color.y, obj.color.z, obj.color.w,
+                                   obj.glow ? 1.0f : 0.0f });
+    }
+
+    for (Level& level : levels) submitLevel(queue, level, shader);
+    submitLevel(queue, impostors, impostorShader);
+}
@@ -0,0 +1,51 @@
+#include "BodySystem.hpp"
+
+void BodySystem::clear() {
+    x.clear(); y.clear(); z.clear();
+    vx.clear(); vy.clear(); vz.clear();
+    ax.clear(); ay.clear(); az.clear();
+    mass.clear();
+    radius.clear();
+}
+
+void BodySystem::reserve(size_t count) {
+    x.reserve(count); y.reserve(count); z.reserve(count);
+    vx.reserve(count); vy.reserve(count); vz.reserve(count);
+    ax.reserve(count); ay.reserve(count); az.reserve(count);
+    mass.reserve(count);
+    radius.reserve(count);
+}
+
+void BodySystem::resize(size_t count) {
+    x.resize(count); y.resize(count); z.resize(count);
+    vx.resize(count); vy.resize(count); vz.resize(count);
+    ax.resize(count); ay.resize(count); az.resize(count);
+    mass.resize(count);
+    radius.resize(count);
+}
+
+size_t BodySystem::add(float px, float py, float pz,
+                       float velX, float velY, float velZ,
+                       float m, float r) {
+    x.push_back(px); y.push_back(py); z.push_back(pz);
+    vx.push_back(velX); vy.push_back(velY); vz.push_back(velZ);
+    ax.push_back(0.0f); ay.push_back(0.0f); az.push_back(0.0f);
+    mass.push_back(m);
+    radius.push_back(r);
+    return mass.size() - 1;
+}
+
+namespace {
+    void swapRemoveFrom(AlignedVector<float>& values, size_t i) {
+        values[i] = values.back();
+        values.pop_back();
+    }
+}
+
+void BodySystem::swapRemove(size_t i) {
+    swapRemoveFrom(x, i); swapRemoveFrom(y, i); swapRemoveFrom(z, i);
+    swapRemoveFrom(vx, i); swapRemoveFrom(vy, i); swapRemoveFrom(vz, i);
+    swapRemoveFrom(ax, i); swapRemoveFrom(ay, i); swapRemoveFrom(az, i);
+    swapRemoveFrom(mass, i);
+    swapRemoveFrom(radius, i);
+}
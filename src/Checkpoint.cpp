@@ -0,0 +1,374 @@
+#include "Checkpoint.hpp"
+#include "Profiler.hpp"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kMagic[8] = { 'G', 'R', 'A', 'V', 'C', 'K', 'P', 'T' };
+    const uint32_t kByteOrderMark = 0x01020304u;
+    const size_t kAlignment = 64;
+
+    enum Array {
+        X, Y, Z, VX, VY, VZ, AX, AY, AZ, Mass, Radius,
+        Level, PrevAx, PrevAy, PrevAz, // leapfrog only, absent (offset 0) otherwise
+        SweepX, SweepY, SweepZ,        // absent before the first contact test
+        ArrayCount
+    };
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint64_t fileSize;
+        uint64_t bodyCount;
+        uint64_t stepCount;
+        double simulationTime;
+
+        char solverName[16];
+        char solverKernel[16];
+        float theta;
+        int32_t fmmOrder;
+        char solverSoftening[16];
+        float softeningLength;
+
+        char integratorName[16];
+        float timeStep;
+        int32_t blockLevels;
+        float eta;
+        uint32_t integratorPrimed;
+        char integratorPrecision[16];
+
+        char collisionResponse[16];
+        float restitution;
+        int32_t fragmentCount;
+        float fragmentSpeed;
+        float fragmentMinMass;
+
+        uint64_t offsets[ArrayCount]; // from the start of the file
+    };
+
+    size_t alignUp(size_t value) {
+        return (value + kAlignment - 1) / kAlignment * kAlignment;
+    }
+
+    bool copyName(char (&field)[16], const std::string& name) {
+        if (name.size() >= sizeof(field)) return false;
+        std::memset(field, 0, sizeof(field));
+        std::memcpy(field, name.data(), name.size());
+        return true;
+    }
+
+    std::string readName(const char (&field)[16]) {
+        return std::string(field, strnlen(field, sizeof(field)));
+    }
+
+    size_t elementSize(int array) {
+        return array == Level ? sizeof(uint8_t) : sizeof(float);
+    }
+
+    // First array of the group a belongs to; optional groups are stored whole or not at all.
+    int groupOf(int array) {
+        return array < Level ? X : array < SweepX ? Level : SweepX;
+    }
+
+    // Lays the world out exactly as the file will hold it.
+    bool serialize(const PhysicsWorld& world, std::vector<char>& buffer) {
+        const BodySystem& bodies = world.bodies;
+        const size_t n = bodies.size();
+        IntegratorState integratorState;
+        world.integrator().saveState(integratorState);
+        const bool hasLevels = integratorState.primed && integratorState.level.size() == n;
+        const float* sweepX = nullptr;
+        const float* sweepY = nullptr;
+        const float* sweepZ = nullptr;
+        const bool hasSweep = world.sweepStart(sweepX, sweepY, sweepZ);
+
+        const void* sources[ArrayCount] = {
+            bodies.x.data(), bodies.y.data(), bodies.z.data(),
+            bodies.vx.data(), bodies.vy.data(), bodies.vz.data(),
+            bodies.ax.data(), bodies.ay.data(), bodies.az.data(),
+            bodies.mass.data(), bodies.radius.data(),
+            integratorState.level.data(),
+            integratorState.prevAx.data(), integratorState.prevAy.data(), integratorState.prevAz.data(),
+            sweepX, sweepY, sweepZ
+        };
+
+        Header header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.version = Checkpoint::kVersion;
+        header.byteOrder = kByteOrderMark;
+        header.bodyCount = n;
+        header.stepCount = world.stepCount;
+        header.simulationTime = world.simulationTime;
+
+        const SolverConfig& solver = world.solverConfig();
+        const IntegratorConfig& integrator = world.integratorConfig();
+        const CollisionConfig& collisions = world.collisionConfig();
+        if (!copyName(header.solverName, solver.name) || !copyName(header.solverKernel, solver.kernel) ||
+            !copyName(header.solverSoftening, solver.softening) || !copyName(header.integratorName, integrator.name) ||
+            !copyName(header.integratorPrecision, integrator.precision) ||
+            !copyName(header.collisionResponse, collisions.response)) {
+            std::cerr << "Checkpoint: solver, integrator or collision name too long" << std::endl;
+            return false;
+        }
+        header.theta = solver.theta;
+        header.fmmOrder = solver.fmmOrder;
+        header.softeningLength = solver.softeningLength;
+        header.timeStep = integrator.timeStep;
+        header.blockLevels = integrator.blockLevels;
+        header.eta = integrator.eta;
+        header.integratorPrimed = integratorState.primed ? 1 : 0;
+        header.restitution = collisions.restitution;
+        header.fragmentCount = collisions.fragmentCount;
+        header.fragmentSpeed = collisions.fragmentSpeed;
+        header.fragmentMinMass = collisions.fragmentMinMass;
+
+        size_t offset = alignUp(sizeof(Header));
+        for (int a = 0; a < ArrayCount; ++a) {
+            if (groupOf(a) == Level && !hasLevels) continue;
+            if (groupOf(a) == SweepX && !hasSweep) continue;
+            header.offsets[a] = offset;
+            offset = alignUp(offset + n * elementSize(a));
+        }
+        header.fileSize = offset;
+
+        // Reused between saves, so only the padding needs clearing.
+        buffer.resize(offset);
+        std::memset(buffer.data(), 0, alignUp(sizeof(Header)));
+        std::memcpy(buffer.data(), &header, sizeof(header));
+        for (int a = 0; a < ArrayCount; ++a) {
+            if (header.offsets[a] == 0) continue;
+            size_t bytes = n * elementSize(a);
+            if (bytes > 0) std::memcpy(buffer.data() + header.offsets[a], sources[a], bytes);
+            std::memset(buffer.data() + header.offsets[a] + bytes, 0, alignUp(header.offsets[a] + bytes) - header.offsets[a] - bytes);
+        }
+        return true;
+    }
+
+    bool writeFile(const std::string& path, const std::vector<char>& buffer) {
+        const std::string temporary = path + ".tmp";
+        int fd = ::open(temporary.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Failed to open checkpoint for writing: " << temporary << std::endl;
+            return false;
+        }
+        size_t written = 0;
+        while (written < buffer.size()) {
+            ssize_t result = ::write(fd, buffer.data() + written, buffer.size() - written);
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                break;
+            }
+            written += static_cast<size_t>(result);
+        }
+        // The rename must not land before the data does.
+        bool ok = written == buffer.size() && ::fsync(fd) == 0;
+        ok = ::close(fd) == 0 && ok;
+        if (ok) ok = ::rename(temporary.c_str(), path.c_str()) == 0;
+        if (!ok) {
+            std::cerr << "Failed to write checkpoint: " << path << std::endl;
+            ::unlink(temporary.c_str());
+        }
+        return ok;
+    }
+
+    bool validate(const Header& header, size_t fileSize, const std::string& path) {
+        if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+            std::cerr << "Not a checkpoint file: " << path << std::endl;
+            return false;
+        }
+        if (header.version != Checkpoint::kVersion || header.byteOrder != kByteOrderMark) {
+            std::cerr << "Unsupported checkpoint version or byte order: " << path << std::endl;
+            return false;
+        }
+        if (header.fileSize != fileSize) {
+            std::cerr << "Truncated checkpoint: " << path << std::endl;
+            return false;
+        }
+        for (int a = 0; a < ArrayCount; ++a) {
+            uint64_t offset = header.offsets[a];
+            bool present = offset != 0;
+            if (!present && (groupOf(a) == X || header.offsets[groupOf(a)] != 0)) {
+                std::cerr << "Checkpoint is missing body arrays: " << path << std::endl;
+                return false;
+            }
+            if (present && (offset % kAlignment != 0 || offset < sizeof(Header) ||
+                            offset > fileSize || header.bodyCount > (fileSize - offset) / elementSize(a))) {
+                std::cerr << "Corrupt checkpoint array table: " << path << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+namespace Checkpoint {
+    bool save(const std::string& path, const PhysicsWorld& world) {
+        std::vector<char> buffer;
+        return serialize(world, buffer) && writeFile(path, buffer);
+    }
+
+    bool load(const std::string& path, PhysicsWorld& world) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Failed to open checkpoint: " << path << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(Header)) {
+            std::cerr << "Truncated checkpoint: " << path << std::endl;
+            ::close(fd);
+            return false;
+        }
+        const size_t fileSize = static_cast<size_t>(info.st_size);
+        void* mapping = ::mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            std::cerr << "Failed to map checkpoint: " << path << std::endl;
+            return false;
+        }
+        ::madvise(mapping, fileSize, MADV_SEQUENTIAL);
+
+        const char* base = static_cast<const char*>(mapping);
+        Header header;
+        std::memcpy(&header, base, sizeof(header));
+        bool ok = validate(header, fileSize, path);
+
+        SolverConfig solver;
+        IntegratorConfig integrator;
+        CollisionConfig collisions;
+        if (ok) {
+            solver.name = readName(header.solverName);
+            solver.kernel = readName(header.solverKernel);
+            solver.theta = header.theta;
+            solver.fmmOrder = header.fmmOrder;
+            solver.softening = readName(header.solverSoftening);
+            solver.softeningLength = header.softeningLength;
+            integrator.name = readName(header.integratorName);
+            integrator.timeStep = header.timeStep;
+            integrator.blockLevels = header.blockLevels;
+            integrator.eta = header.eta;
+            integrator.precision = readName(header.integratorPrecision);
+            collisions.response = readName(header.collisionResponse);
+            collisions.restitution = header.restitution;
+            collisions.fragmentCount = header.fragmentCount;
+            collisions.fragmentSpeed = header.fragmentSpeed;
+            collisions.fragmentMinMass = header.fragmentMinMass;
+            // Check everything before touching world so a bad file changes nothing.
+            ContactResolver resolver;
+            ok = createForceSolver(solver) && createIntegrator(integrator) && resolver.configure(collisions);
+            if (!ok) std::cerr << "Checkpoint names an unknown solver, integrator or collision response: " << path << std::endl;
+        }
+
+        if (ok) {
+            world.setSolver(solver);
+            world.setIntegrator(integrator);
+            world.setCollisions(collisions);
+
+            const size_t n = header.bodyCount;
+            auto floats = [&](int array) { return reinterpret_cast<const float*>(base + header.offsets[array]); };
+            BodySystem& bodies = world.bodies;
+            AlignedVector<float>* targets[] = {
+                &bodies.x, &bodies.y, &bodies.z, &bodies.vx, &bodies.vy, &bodies.vz,
+                &bodies.ax, &bodies.ay, &bodies.az, &bodies.mass, &bodies.radius
+            };
+            for (int a = X; a <= Radius; ++a) targets[a]->assign(floats(a), floats(a) + n);
+
+            IntegratorState state;
+            state.primed = header.integratorPrimed != 0;
+            if (header.offsets[Level] != 0) {
+                const uint8_t* level = reinterpret_cast<const uint8_t*>(base + header.offsets[Level]);
+                state.level.assign(level, level + n);
+                state.prevAx.assign(floats(PrevAx), floats(PrevAx) + n);
+                state.prevAy.assign(floats(PrevAy), floats(PrevAy) + n);
+                state.prevAz.assign(floats(PrevAz), floats(PrevAz) + n);
+            }
+            if (!world.integrator().restoreState(state, n)) {
+                std::cerr << "Checkpoint integrator state does not match; it restarts from the bodies" << std::endl;
+            }
+            world.bodiesRestored();
+            if (header.offsets[SweepX] != 0) world.restoreSweepStart(floats(SweepX), floats(SweepY), floats(SweepZ));
+            world.stepCount = header.stepCount;
+            world.simulationTime = header.simulationTime;
+        }
+
+        ::munmap(mapping, fileSize);
+        return ok;
+    }
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    wait();
+    if (!worker.joinable()) return;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    worker.join();
+}
+
+void CheckpointWriter::save(const std::string& path, const PhysicsWorld& world) {
+    if (!serialize(world, staging)) {
+        std::lock_guard<std::mutex> lock(mutex);
+        failed = true;
+        return;
+    }
+    {
+        // The buffers are swapped, not copied, so they are reused between saves.
+        std::lock_guard<std::mutex> lock(mutex);
+        if (hasWaiting) ++droppedCount;
+        waiting.swap(staging);
+        waitingPath = path;
+        hasWaiting = true;
+    }
+    if (!worker.joinable()) worker = std::thread([this]() { run(); });
+    wake.notify_one();
+}
+
+void CheckpointWriter::run() {
+    PROFILE_THREAD("checkpoint writer");
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        wake.wait(lock, [this]() { return hasWaiting || stopping; });
+        if (!hasWaiting) return;
+        writing.swap(waiting);
+        const std::string path = waitingPath;
+        hasWaiting = false;
+        inFlight = true;
+        lock.unlock();
+        bool ok;
+        {
+            PROFILE_ZONE("checkpoint.write");
+            ok = writeFile(path, writing);
+        }
+        lock.lock();
+        if (!ok) failed = true;
+        inFlight = false;
+        if (!hasWaiting) idle.notify_all();
+    }
+}
+
+bool CheckpointWriter::busy() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hasWaiting || inFlight;
+}
+
+unsigned long long CheckpointWriter::droppedSnapshots() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return droppedCount;
+}
+
+bool CheckpointWriter::wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return !hasWaiting && !inFlight; });
+    bool ok = !failed;
+    failed = false;
+    return ok;
+}
@@ -0,0 +1,182 @@
+#include "CollisionDetector.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const size_t kBucketChunk = 1024;
+    const size_t kLargeChunk = 4096;
+
+    inline int32_t cellCoord(float value, float cellSize) {
+        float cell = std::floor(value / cellSize);
+        return static_cast<int32_t>(std::max(-1e9f, std::min(1e9f, cell)));
+    }
+
+    inline uint32_t hashCell(const int32_t cell[3], uint32_t mask) {
+        uint64_t h = static_cast<uint32_t>(cell[0]) * 73856093ull
+                   ^ static_cast<uint32_t>(cell[1]) * 19349663ull
+                   ^ static_cast<uint32_t>(cell[2]) * 83492791ull;
+        return static_cast<uint32_t>(h ^ (h >> 29)) & mask;
+    }
+}
+
+bool CollisionDetector::touches(const BodySystem& bodies, uint32_t i, uint32_t j, float& toi) const {
+    const float reach = bodies.radius[i] + bodies.radius[j];
+    float dx = bodies.x[j] - bodies.x[i];
+    float dy = bodies.y[j] - bodies.y[i];
+    float dz = bodies.z[j] - bodies.z[i];
+    if (!sweepX) {
+        toi = 0.0f;
+        return dx * dx + dy * dy + dz * dz < reach * reach;
+    }
+
+    // Separation d(t) = d0 + (d1 - d0) t for t in [0, 1]; solve |d(t)| = reach.
+    const float d0x = sweepX[j] - sweepX[i], d0y = sweepY[j] - sweepY[i], d0z = sweepZ[j] - sweepZ[i];
+    const float c = d0x * d0x + d0y * d0y + d0z * d0z - reach * reach;
+    if (c < 0.0f) {
+        toi = 0.0f;
+        return true;
+    }
+    dx -= d0x;
+    dy -= d0y;
+    dz -= d0z;
+    const float a = dx * dx + dy * dy + dz * dz;
+    const float halfB = d0x * dx + d0y * dy + d0z * dz;
+    if (halfB >= 0.0f || a <= 0.0f) return false; // not approaching
+    const float discriminant = halfB * halfB - a * c;
+    if (discriminant < 0.0f) return false;
+    const float t = (-halfB - std::sqrt(discriminant)) / a;
+    if (t > 1.0f) return false;
+    toi = std::max(t, 0.0f);
+    return true;
+}
+
+void CollisionDetector::findContacts(const BodySystem& bodies, ThreadPool& pool, std::vector<ContactPair>& contacts) {
+    findContacts(bodies, nullptr, nullptr, nullptr, pool, contacts);
+}
+
+void CollisionDetector::findContacts(const BodySystem& bodies, const float* startX, const float* startY, const float* startZ,
+                                     ThreadPool& pool, std::vector<ContactPair>& contacts) {
+    contacts.clear();
+    sweepX = startX;
+    sweepY = startY;
+    sweepZ = startZ;
+    candidates = 0;
+    const size_t n = bodies.size();
+    if (n < 2) return;
+
+    double radiusSum = 0.0;
+    for (size_t i = 0; i < n; ++i) radiusSum += bodies.radius[i];
+    cellSize = std::max(static_cast<float>(4.0 * radiusSum / n), 1e-3f);
+
+    // Cell ranges of every bounding box; oversized bodies go to largeBodies.
+    cellBounds.resize(6 * n);
+    largeBodies.clear();
+    size_t entryCount = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const float center[3] = { bodies.x[i], bodies.y[i], bodies.z[i] };
+        const float start[3] = { startX ? startX[i] : center[0], startY ? startY[i] : center[1], startZ ? startZ[i] : center[2] };
+        int32_t* bounds = &cellBounds[6 * i];
+        size_t cells = 1;
+        bool large = false;
+        for (int axis = 0; axis < 3; ++axis) {
+            bounds[2 * axis] = cellCoord(std::min(center[axis], start[axis]) - bodies.radius[i], cellSize);
+            bounds[2 * axis + 1] = cellCoord(std::max(center[axis], start[axis]) + bodies.radius[i], cellSize);
+            int32_t span = bounds[2 * axis + 1] - bounds[2 * axis] + 1;
+            if (span > kMaxCellSpan) large = true;
+            cells *= static_cast<size_t>(span);
+        }
+        if (large) largeBodies.push_back(static_cast<uint32_t>(i));
+        else entryCount += cells;
+    }
+
+    entries.clear();
+    entries.reserve(entryCount);
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t* bounds = &cellBounds[6 * i];
+        if (bounds[1] - bounds[0] >= kMaxCellSpan || bounds[3] - bounds[2] >= kMaxCellSpan || bounds[5] - bounds[4] >= kMaxCellSpan) continue;
+        Entry entry;
+        entry.body = static_cast<uint32_t>(i);
+        for (entry.cell[0] = bounds[0]; entry.cell[0] <= bounds[1]; ++entry.cell[0])
+            for (entry.cell[1] = bounds[2]; entry.cell[1] <= bounds[3]; ++entry.cell[1])
+                for (entry.cell[2] = bounds[4]; entry.cell[2] <= bounds[5]; ++entry.cell[2])
+                    entries.push_back(entry);
+    }
+
+    // Counting sort of the entries into a power-of-two hash table.
+    uint32_t bucketCount = 1;
+    while (bucketCount < entries.size()) bucketCount <<= 1;
+    const uint32_t mask = bucketCount - 1;
+    bucketStart.assign(bucketCount + 1, 0);
+    for (const Entry& entry : entries) ++bucketStart[hashCell(entry.cell, mask) + 1];
+    for (uint32_t b = 0; b < bucketCount; ++b) bucketStart[b + 1] += bucketStart[b];
+    sortedEntries.resize(entries.size());
+    {
+        std::vector<uint32_t> cursor(bucketStart.begin(), bucketStart.end() - 1);
+        for (const Entry& entry : entries) sortedEntries[cursor[hashCell(entry.cell, mask)]++] = entry;
+    }
+
+    workerContacts.resize(pool.size());
+    workerCandidates.assign(pool.size(), 0);
+    for (auto& list : workerContacts) list.clear();
+
+    pool.parallelFor((bucketCount + kBucketChunk - 1) / kBucketChunk, [&](size_t chunk, size_t worker) {
+        size_t tested = 0;
+        const uint32_t end = static_cast<uint32_t>(std::min<size_t>(bucketCount, (chunk + 1) * kBucketChunk));
+        for (uint32_t b = static_cast<uint32_t>(chunk * kBucketChunk); b < end; ++b) {
+            testBucket(bodies, b, workerContacts[worker], tested);
+        }
+        workerCandidates[worker] += tested;
+    });
+
+    if (!largeBodies.empty()) {
+        std::vector<char> isLarge(n, 0);
+        for (uint32_t i : largeBodies) isLarge[i] = 1;
+        pool.parallelFor((n + kLargeChunk - 1) / kLargeChunk, [&](size_t chunk, size_t worker) {
+            size_t tested = 0;
+            const size_t end = std::min(n, (chunk + 1) * kLargeChunk);
+            for (uint32_t large : largeBodies) {
+                for (size_t j = chunk * kLargeChunk; j < end; ++j) {
+                    // Large-large pairs are tested once, from the lower index.
+                    if (j == large || (isLarge[j] && j < large)) continue;
+                    ++tested;
+                    uint32_t other = static_cast<uint32_t>(j);
+                    float toi;
+                    if (touches(bodies, std::min(large, other), std::max(large, other), toi)) {
+                        workerContacts[worker].push_back(ContactPair{ std::min(large, other), std::max(large, other), toi });
+                    }
+                }
+            }
+            workerCandidates[worker] += tested;
+        });
+    }
+
+    for (size_t w = 0; w < workerContacts.size(); ++w) {
+        contacts.insert(contacts.end(), workerContacts[w].begin(), workerContacts[w].end());
+        candidates += workerCandidates[w];
+    }
+}
+
+void CollisionDetector::testBucket(const BodySystem& bodies, uint32_t bucket, std::vector<ContactPair>& found, size_t& tested) const {
+    const uint32_t begin = bucketStart[bucket], end = bucketStart[bucket + 1];
+    for (uint32_t p = begin; p < end; ++p) {
+        const Entry& first = sortedEntries[p];
+        const int32_t* boundsI = &cellBounds[6 * first.body];
+        for (uint32_t q = p + 1; q < end; ++q) {
+            const Entry& second = sortedEntries[q];
+            // Different cells can hash to the same bucket.
+            if (first.cell[0] != second.cell[0] || first.cell[1] != second.cell[1] || first.cell[2] != second.cell[2]) continue;
+
+            // A pair sharing several cells is reported only from the cell
+            // holding the upper corner of the two boxes' lower corners.
+            const int32_t* boundsJ = &cellBounds[6 * second.body];
+            if (first.cell[0] != std::max(boundsI[0], boundsJ[0]) ||
+                first.cell[1] != std::max(boundsI[2], boundsJ[2]) ||
+                first.cell[2] != std::max(boundsI[4], boundsJ[4])) continue;
+
+            ++tested;
+            const uint32_t a = std::min(first.body, second.body), b = std::max(first.body, second.body);
+            float toi;
+            if (touches(bodies, a, b, toi)) found.push_back(ContactPair{ a, b, toi });
+        }
+    }
+}
@@ -0,0 +1,219 @@
+#include "ContactResponse.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Unit vector along (x, y, z), or fallback if it is zero.
+    void normalize(float& x, float& y, float& z, float fallbackX, float fallbackY, float fallbackZ) {
+        float length = std::sqrt(x * x + y * y + z * z);
+        if (length > 0.0f) {
+            x /= length;
+            y /= length;
+            z /= length;
+        } else {
+            x = fallbackX;
+            y = fallbackY;
+            z = fallbackZ;
+        }
+    }
+}
+
+bool ContactResolver::configure(const CollisionConfig& config) {
+    Response parsed;
+    if (config.response == "bounce") parsed = Response::Bounce;
+    else if (config.response == "merge") parsed = Response::Merge;
+    else if (config.response == "fragment") parsed = Response::Fragment;
+    else return false;
+    if (!(config.restitution >= 0.0f && config.restitution <= 1.0f)) return false;
+    if (config.fragmentCount < 2 || config.fragmentCount > 8) return false;
+    if (!(config.fragmentSpeed >= 0.0f) || !(config.fragmentMinMass > 0.0f)) return false;
+    response = parsed;
+    settings = config;
+    return true;
+}
+
+void ContactResolver::resolve(BodySystem& bodies, const float* startX, const float* startY, const float* startZ,
+                              std::vector<ContactPair>& contacts) {
+    const size_t n = bodies.size();
+    rewound.assign(n, 0);
+    removedFlag.assign(n, 0);
+    dead.clear();
+    pending.clear();
+
+    // Earliest impact first; the index tie-break makes the order independent
+    // of how the detector's workers split the pairs.
+    std::sort(contacts.begin(), contacts.end(), [](const ContactPair& l, const ContactPair& r) {
+        if (l.toi != r.toi) return l.toi < r.toi;
+        return l.a != r.a ? l.a < r.a : l.b < r.b;
+    });
+
+    for (const ContactPair& contact : contacts) {
+        if (removedFlag[contact.a] || removedFlag[contact.b]) continue;
+        if (startX && contact.toi > 0.0f) {
+            const uint32_t pair[2] = { contact.a, contact.b };
+            for (uint32_t i : pair) {
+                if (rewound[i]) continue;
+                bodies.x[i] = startX[i] + (bodies.x[i] - startX[i]) * contact.toi;
+                bodies.y[i] = startY[i] + (bodies.y[i] - startY[i]) * contact.toi;
+                bodies.z[i] = startZ[i] + (bodies.z[i] - startZ[i]) * contact.toi;
+                rewound[i] = 1;
+            }
+        }
+        switch (response) {
+            case Response::Bounce:
+                bounce(bodies, contact.a, contact.b);
+                break;
+            case Response::Merge:
+                merge(bodies, contact.a, contact.b);
+                break;
+            case Response::Fragment:
+                if (!fragment(bodies, contact.a, contact.b)) merge(bodies, contact.a, contact.b);
+                break;
+        }
+    }
+}
+
+void ContactResolver::bounce(BodySystem& bodies, uint32_t a, uint32_t b) {
+    // Masses only enter as fractions of the total: their product overflows a float.
+    const float total = bodies.mass[a] + bodies.mass[b];
+    if (!(total > 0.0f)) return;
+    const float shareA = bodies.mass[a] / total, shareB = bodies.mass[b] / total;
+    float nx = bodies.x[b] - bodies.x[a];
+    float ny = bodies.y[b] - bodies.y[a];
+    float nz = bodies.z[b] - bodies.z[a];
+    const float distance = std::sqrt(nx * nx + ny * ny + nz * nz);
+    normalize(nx, ny, nz, 1.0f, 0.0f, 0.0f);
+
+    // Each body gives way in proportion to the other's mass.
+    const float overlap = bodies.radius[a] + bodies.radius[b] - distance;
+    if (overlap > 0.0f) {
+        const float shiftA = overlap * shareB, shiftB = overlap * shareA;
+        bodies.x[a] -= nx * shiftA;
+        bodies.y[a] -= ny * shiftA;
+        bodies.z[a] -= nz * shiftA;
+        bodies.x[b] += nx * shiftB;
+        bodies.y[b] += ny * shiftB;
+        bodies.z[b] += nz * shiftB;
+    }
+
+    const float approach = (bodies.vx[b] - bodies.vx[a]) * nx + (bodies.vy[b] - bodies.vy[a]) * ny +
+                           (bodies.vz[b] - bodies.vz[a]) * nz;
+    if (approach >= 0.0f) return; // already separating
+    // Impulse -(1 + e) vn mA mB / (mA + mB), divided by each body's mass.
+    const float dv = -(1.0f + settings.restitution) * approach;
+    bodies.vx[a] -= nx * dv * shareB;
+    bodies.vy[a] -= ny * dv * shareB;
+    bodies.vz[a] -= nz * dv * shareB;
+    bodies.vx[b] += nx * dv * shareA;
+    bodies.vy[b] += ny * dv * shareA;
+    bodies.vz[b] += nz * dv * shareA;
+}
+
+void ContactResolver::merge(BodySystem& bodies, uint32_t a, uint32_t b) {
+    const uint32_t big = bodies.mass[a] >= bodies.mass[b] ? a : b;
+    const uint32_t small = big == a ? b : a;
+    const float mb = bodies.mass[big], ms = bodies.mass[small], total = mb + ms;
+    if (total > 0.0f) {
+        const float wb = mb / total, ws = ms / total;
+        bodies.x[big] = wb * bodies.x[big] + ws * bodies.x[small];
+        bodies.y[big] = wb * bodies.y[big] + ws * bodies.y[small];
+        bodies.z[big] = wb * bodies.z[big] + ws * bodies.z[small];
+        bodies.vx[big] = wb * bodies.vx[big] + ws * bodies.vx[small];
+        bodies.vy[big] = wb * bodies.vy[big] + ws * bodies.vy[small];
+        bodies.vz[big] = wb * bodies.vz[big] + ws * bodies.vz[small];
+    }
+    const float rb = bodies.radius[big], rs = bodies.radius[small];
+    bodies.radius[big] = std::cbrt(rb * rb * rb + rs * rs * rs);
+    bodies.mass[big] = total;
+    removedFlag[small] = 1;
+    dead.push_back(small);
+}
+
+bool ContactResolver::fragment(BodySystem& bodies, uint32_t a, uint32_t b) {
+    const uint32_t big = bodies.mass[a] >= bodies.mass[b] ? a : b;
+    const uint32_t small = big == a ? b : a;
+    const float mb = bodies.mass[big], ms = bodies.mass[small], total = mb + ms;
+    const float rb = bodies.radius[big], rs = bodies.radius[small];
+    const int count = settings.fragmentCount;
+    const float pieceMass = ms / count;
+    if (!(total > 0.0f) || pieceMass < settings.fragmentMinMass) return false;
+
+    float rvx = bodies.vx[small] - bodies.vx[big];
+    float rvy = bodies.vy[small] - bodies.vy[big];
+    float rvz = bodies.vz[small] - bodies.vz[big];
+    const float impact = std::sqrt(rvx * rvx + rvy * rvy + rvz * rvz);
+    const float escape = std::sqrt(2.0f * Constants::G_UNITS * total / (rb + rs));
+    if (!(impact > settings.fragmentSpeed * escape)) return false;
+
+    // The heavy body keeps its mass and takes the pair's centre-of-mass
+    // velocity; the pieces fly apart from that same velocity, so momentum
+    // is conserved.
+    const float wb = mb / total, ws = ms / total;
+    const float cvx = wb * bodies.vx[big] + ws * bodies.vx[small];
+    const float cvy = wb * bodies.vy[big] + ws * bodies.vy[small];
+    const float cvz = wb * bodies.vz[big] + ws * bodies.vz[small];
+    bodies.vx[big] = cvx;
+    bodies.vy[big] = cvy;
+    bodies.vz[big] = cvz;
+
+    // Pieces sit evenly on a ring around the line of centres, far enough
+    // apart and from the heavy body not to touch anything when they appear.
+    float nx = bodies.x[small] - bodies.x[big];
+    float ny = bodies.y[small] - bodies.y[big];
+    float nz = bodies.z[small] - bodies.z[big];
+    const float distance = std::sqrt(nx * nx + ny * ny + nz * nz);
+    normalize(nx, ny, nz, rvx / impact, rvy / impact, rvz / impact);
+    // u, w: an orthonormal basis of the plane perpendicular to n.
+    float ux, uy, uz;
+    if (std::fabs(nx) < 0.9f) { ux = 0.0f; uy = nz; uz = -ny; } // n x (1, 0, 0)
+    else { ux = -nz; uy = 0.0f; uz = nx; }                      // n x (0, 1, 0)
+    normalize(ux, uy, uz, 0.0f, 1.0f, 0.0f);
+    const float wx = ny * uz - nz * uy, wy = nz * ux - nx * uz, wz = nx * uy - ny * ux;
+
+    const float pieceRadius = rs / std::cbrt(static_cast<float>(count));
+    const float ring = 1.05f * std::max(rs, pieceRadius / std::sin(Constants::PI / count));
+    const float clearance = (rb + pieceRadius) * (rb + pieceRadius) - ring * ring;
+    const float along = std::max(distance, clearance > 0.0f ? 1.05f * std::sqrt(clearance) : 0.0f);
+    const float centerX = bodies.x[big] + nx * along;
+    const float centerY = bodies.y[big] + ny * along;
+    const float centerZ = bodies.z[big] + nz * along;
+    const float speed = settings.restitution * impact;
+
+    for (int k = 0; k < count; ++k) {
+        const float angle = 2.0f * Constants::PI * k / count;
+        const float c = std::cos(angle), s = std::sin(angle);
+        const float dx = c * ux + s * wx, dy = c * uy + s * wy, dz = c * uz + s * wz;
+        Piece piece;
+        piece.parent = small;
+        piece.x = centerX + ring * dx;
+        piece.y = centerY + ring * dy;
+        piece.z = centerZ + ring * dz;
+        piece.vx = cvx + speed * dx;
+        piece.vy = cvy + speed * dy;
+        piece.vz = cvz + speed * dz;
+        piece.mass = pieceMass;
+        piece.radius = pieceRadius;
+        pending.push_back(piece);
+    }
+    removedFlag[small] = 1;
+    dead.push_back(small);
+    return true;
+}
+
+void ContactResolver::applyEdits(BodySystem& bodies, BodyEdits& edits) {
+    edits.clear();
+    for (const Piece& piece : pending) {
+        bodies.add(piece.x, piece.y, piece.z, piece.vx, piece.vy, piece.vz, piece.mass, piece.radius);
+        edits.spawnedFrom.push_back(piece.parent);
+    }
+    // Highest index first, so the body swapped into a freed slot is never
+    // one still waiting for removal.
+    std::sort(dead.begin(), dead.end(), [](uint32_t l, uint32_t r) { return l > r; });
+    for (uint32_t i : dead) {
+        bodies.swapRemove(i);
+        edits.removed.push_back(i);
+    }
+    pending.clear();
+    dead.clear();
+}
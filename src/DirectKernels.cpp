@@ -0,0 +1,752 @@
+#include "DirectKernels.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GRAVITY_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace DirectKernels {
+    namespace {
+        typedef SofteningCoefficients Coefficients;
+        typedef ScalarLaw<SofteningLaw::Spline> Spline;
+
+#ifdef GRAVITY_X86_DISPATCH
+        // 1/sqrt(x) from the rsqrt estimate refined by one Newton-Raphson step.
+        __attribute__((target("avx2,fma")))
+        inline __m256 rsqrtAvx2(__m256 x) {
+            __m256 invR = _mm256_rsqrt_ps(x);
+            return _mm256_mul_ps(invR, _mm256_fnmadd_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), x), _mm256_mul_ps(invR, invR),
+                                                        _mm256_set1_ps(1.5f)));
+        }
+
+        __attribute__((target("avx512f")))
+        inline __m512 rsqrtAvx512(__m512 x) {
+            __m512 invR = _mm512_rsqrt14_ps(x);
+            return _mm512_mul_ps(invR, _mm512_fnmadd_ps(_mm512_mul_ps(_mm512_set1_ps(0.5f), x), _mm512_mul_ps(invR, invR),
+                                                        _mm512_set1_ps(1.5f)));
+        }
+#endif
+
+#ifdef GRAVITY_X86_DISPATCH
+        // SIMD counterparts of ScalarLaw, overloaded per vector width.
+        template <SofteningLaw L> struct VectorLaw;
+
+        template <> struct VectorLaw<SofteningLaw::None> {
+            __attribute__((target("avx2,fma")))
+            static __m256 invCube(__m256 r2, const Coefficients&) {
+                __m256 invR = rsqrtAvx2(r2);
+                return _mm256_and_ps(_mm256_cmp_ps(r2, _mm256_set1_ps(Constants::MIN_DISTANCE2), _CMP_GT_OQ),
+                                     _mm256_mul_ps(invR, _mm256_mul_ps(invR, invR)));
+            }
+            __attribute__((target("avx512f")))
+            static __m512 invCube(__m512 r2, const Coefficients&) {
+                __m512 invR = rsqrtAvx512(r2);
+                return _mm512_maskz_mul_ps(_mm512_cmp_ps_mask(r2, _mm512_set1_ps(Constants::MIN_DISTANCE2), _CMP_GT_OQ),
+                                           invR, _mm512_mul_ps(invR, invR));
+            }
+        };
+
+        template <> struct VectorLaw<SofteningLaw::Plummer> {
+            __attribute__((target("avx2,fma")))
+            static __m256 invCube(__m256 r2, const Coefficients& c) {
+                __m256 invR = rsqrtAvx2(_mm256_add_ps(r2, _mm256_set1_ps(c.eps2)));
+                return _mm256_mul_ps(invR, _mm256_mul_ps(invR, invR));
+            }
+            __attribute__((target("avx512f")))
+            static __m512 invCube(__m512 r2, const Coefficients& c) {
+                __m512 invR = rsqrtAvx512(_mm512_add_ps(r2, _mm512_set1_ps(c.eps2)));
+                return _mm512_mul_ps(invR, _mm512_mul_ps(invR, invR));
+            }
+        };
+
+        template <> struct VectorLaw<SofteningLaw::Spline> {
+            __attribute__((target("avx2,fma")))
+            static __m256 invCube(__m256 r2, const Coefficients& c) {
+                __m256 invR = rsqrtAvx2(_mm256_max_ps(r2, _mm256_set1_ps(kTinyR2)));
+                __m256 u = _mm256_mul_ps(_mm256_mul_ps(r2, invR), _mm256_set1_ps(c.invH));
+                __m256 u2 = _mm256_mul_ps(u, u), u3 = _mm256_mul_ps(u2, u);
+                __m256 inner = _mm256_fmadd_ps(u2, _mm256_fmadd_ps(_mm256_set1_ps(Spline::kInnerC3), u, _mm256_set1_ps(Spline::kInnerC2)),
+                                               _mm256_set1_ps(Spline::kInnerC0));
+                __m256 outer = _mm256_fmadd_ps(_mm256_set1_ps(Spline::kOuterC1), u, _mm256_set1_ps(Spline::kOuterC0));
+                outer = _mm256_fmadd_ps(_mm256_set1_ps(Spline::kOuterC2), u2, outer);
+                outer = _mm256_fmadd_ps(_mm256_set1_ps(Spline::kOuterC3), u3, outer);
+                __m256 newton = _mm256_mul_ps(invR, _mm256_mul_ps(invR, invR));
+                __m256 isInner = _mm256_cmp_ps(u, _mm256_set1_ps(0.5f), _CMP_LT_OQ);
+                __m256 softened = _mm256_fmadd_ps(_mm256_set1_ps(c.invH3), _mm256_blendv_ps(outer, inner, isInner),
+                                                  _mm256_andnot_ps(isInner, _mm256_mul_ps(_mm256_set1_ps(Spline::kOuterCInv3), newton)));
+                return _mm256_blendv_ps(newton, softened, _mm256_cmp_ps(r2, _mm256_set1_ps(c.h2), _CMP_LT_OQ));
+            }
+            __attribute__((target("avx512f")))
+            static __m512 invCube(__m512 r2, const Coefficients& c) {
+                __m512 invR = rsqrtAvx512(_mm512_max_ps(r2, _mm512_set1_ps(kTinyR2)));
+                __m512 u = _mm512_mul_ps(_mm512_mul_ps(r2, invR), _mm512_set1_ps(c.invH));
+                __m512 u2 = _mm512_mul_ps(u, u), u3 = _mm512_mul_ps(u2, u);
+                __m512 inner = _mm512_fmadd_ps(u2, _mm512_fmadd_ps(_mm512_set1_ps(Spline::kInnerC3), u, _mm512_set1_ps(Spline::kInnerC2)),
+                                               _mm512_set1_ps(Spline::kInnerC0));
+                __m512 outer = _mm512_fmadd_ps(_mm512_set1_ps(Spline::kOuterC1), u, _mm512_set1_ps(Spline::kOuterC0));
+                outer = _mm512_fmadd_ps(_mm512_set1_ps(Spline::kOuterC2), u2, outer);
+                outer = _mm512_fmadd_ps(_mm512_set1_ps(Spline::kOuterC3), u3, outer);
+                __m512 newton = _mm512_mul_ps(invR, _mm512_mul_ps(invR, invR));
+                __mmask16 isOuter = _mm512_cmp_ps_mask(u, _mm512_set1_ps(0.5f), _CMP_GE_OQ);
+                __m512 softened = _mm512_fmadd_ps(_mm512_set1_ps(c.invH3), _mm512_mask_blend_ps(isOuter, inner, outer),
+                                                  _mm512_maskz_mul_ps(isOuter, _mm512_set1_ps(Spline::kOuterCInv3), newton));
+                return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(r2, _mm512_set1_ps(c.h2), _CMP_LT_OQ), newton, softened);
+            }
+        };
+#endif
+
+        template <SofteningLaw L>
+        void computeScalar(const Coefficients& c, BodySystem& bodies, size_t begin, size_t end) {
+            const size_t n = bodies.size();
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+
+            for (size_t i = begin; i < end; ++i) {
+                const float xi = x[i], yi = y[i], zi = z[i];
+                float accX = 0.0f, accY = 0.0f, accZ = 0.0f;
+                for (size_t j = 0; j < n; ++j) {
+                    float dx = x[j] - xi;
+                    float dy = y[j] - yi;
+                    float dz = z[j] - zi;
+                    float s = m[j] * ScalarLaw<L>::invCube(dx * dx + dy * dy + dz * dz, c);
+                    accX += dx * s;
+                    accY += dy * s;
+                    accZ += dz * s;
+                }
+                bodies.ax[i] = Constants::G_UNITS * accX;
+                bodies.ay[i] = Constants::G_UNITS * accY;
+                bodies.az[i] = Constants::G_UNITS * accZ;
+            }
+        }
+
+        template <SofteningLaw L>
+        void sourcesScalar(const Coefficients& c, const float* x, const float* y, const float* z, const float* m,
+                           size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                           float* accX, float* accY, float* accZ) {
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const float xi = x[i], yi = y[i], zi = z[i];
+                float accXi = 0.0f, accYi = 0.0f, accZi = 0.0f;
+                for (size_t j = jBegin; j < jEnd; ++j) {
+                    float dx = x[j] - xi;
+                    float dy = y[j] - yi;
+                    float dz = z[j] - zi;
+                    float s = m[j] * ScalarLaw<L>::invCube(dx * dx + dy * dy + dz * dz, c);
+                    accXi += dx * s;
+                    accYi += dy * s;
+                    accZi += dz * s;
+                }
+                accX[i] += accXi;
+                accY[i] += accYi;
+                accZ[i] += accZi;
+            }
+        }
+
+        template <SofteningLaw L>
+        void tileScalar(const Coefficients& c, const BodySystem& bodies, size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                        float* accX, float* accY, float* accZ) {
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+            const bool diagonal = iBegin == jBegin;
+
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const float xi = x[i], yi = y[i], zi = z[i], mi = m[i];
+                float accXi = 0.0f, accYi = 0.0f, accZi = 0.0f;
+                for (size_t j = diagonal ? i + 1 : jBegin; j < jEnd; ++j) {
+                    float dx = x[j] - xi;
+                    float dy = y[j] - yi;
+                    float dz = z[j] - zi;
+                    float invR3 = ScalarLaw<L>::invCube(dx * dx + dy * dy + dz * dz, c);
+                    float sj = m[j] * invR3;
+                    float si = mi * invR3;
+                    accXi += dx * sj; accYi += dy * sj; accZi += dz * sj;
+                    accX[j] -= dx * si; accY[j] -= dy * si; accZ[j] -= dz * si;
+                }
+                accX[i] += accXi;
+                accY[i] += accYi;
+                accZ[i] += accZi;
+            }
+        }
+
+        // Each unordered pair once per lane; the lane loop is the inner one,
+        // so the compiler can vectorize it without the intrinsics below.
+        template <SofteningLaw L>
+        void lanesScalar(const Coefficients& c, size_t n, const float* x, const float* y, const float* z, const float* m,
+                         const float* weights, float* ax, float* ay, float* az, float* nearest) {
+            const size_t w = kEnsembleLanes;
+            std::fill(ax, ax + n * w, 0.0f);
+            std::fill(ay, ay + n * w, 0.0f);
+            std::fill(az, az + n * w, 0.0f);
+            for (size_t i = 0, k = 0; i < n; ++i) {
+                for (size_t j = i + 1; j < n; ++j, ++k) {
+                    for (size_t l = 0; l < w; ++l) {
+                        const size_t a = i * w + l, b = j * w + l;
+                        float dx = x[b] - x[a];
+                        float dy = y[b] - y[a];
+                        float dz = z[b] - z[a];
+                        float r2 = dx * dx + dy * dy + dz * dz;
+                        nearest[l] = std::min(nearest[l], r2 * weights[k]);
+                        float invR3 = ScalarLaw<L>::invCube(r2, c);
+                        float sj = m[b] * invR3;
+                        float si = m[a] * invR3;
+                        ax[a] += dx * sj; ay[a] += dy * sj; az[a] += dz * sj;
+                        ax[b] -= dx * si; ay[b] -= dy * si; az[b] -= dz * si;
+                    }
+                }
+            }
+            for (size_t k = 0; k < n * w; ++k) {
+                ax[k] *= Constants::G_UNITS;
+                ay[k] *= Constants::G_UNITS;
+                az[k] *= Constants::G_UNITS;
+            }
+        }
+
+#ifdef GRAVITY_X86_DISPATCH
+        __attribute__((target("avx2,fma")))
+        inline float horizontalSumAvx2(__m256 v) {
+            __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+            sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+            sum = _mm_add_ss(sum, _mm_movehdup_ps(sum));
+            return _mm_cvtss_f32(sum);
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx2,fma")))
+        void tileAvx2(const Coefficients& c, const BodySystem& bodies, size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                      float* accX, float* accY, float* accZ) {
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+            const bool diagonal = iBegin == jBegin;
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const __m256 xi = _mm256_set1_ps(x[i]);
+                const __m256 yi = _mm256_set1_ps(y[i]);
+                const __m256 zi = _mm256_set1_ps(z[i]);
+                const __m256 mi = _mm256_set1_ps(m[i]);
+                __m256 accXi = _mm256_setzero_ps();
+                __m256 accYi = _mm256_setzero_ps();
+                __m256 accZi = _mm256_setzero_ps();
+
+                size_t j = diagonal ? i + 1 : jBegin;
+                for (; j + 8 <= jEnd; j += 8) {
+                    __m256 dx = _mm256_sub_ps(_mm256_loadu_ps(x + j), xi);
+                    __m256 dy = _mm256_sub_ps(_mm256_loadu_ps(y + j), yi);
+                    __m256 dz = _mm256_sub_ps(_mm256_loadu_ps(z + j), zi);
+                    __m256 invR3 = VectorLaw<L>::invCube(_mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx))), c);
+                    __m256 sj = _mm256_mul_ps(_mm256_loadu_ps(m + j), invR3);
+                    __m256 si = _mm256_mul_ps(mi, invR3);
+                    accXi = _mm256_fmadd_ps(dx, sj, accXi);
+                    accYi = _mm256_fmadd_ps(dy, sj, accYi);
+                    accZi = _mm256_fmadd_ps(dz, sj, accZi);
+                    _mm256_storeu_ps(accX + j, _mm256_fnmadd_ps(dx, si, _mm256_loadu_ps(accX + j)));
+                    _mm256_storeu_ps(accY + j, _mm256_fnmadd_ps(dy, si, _mm256_loadu_ps(accY + j)));
+                    _mm256_storeu_ps(accZ + j, _mm256_fnmadd_ps(dz, si, _mm256_loadu_ps(accZ + j)));
+                }
+                if (j < jEnd) {
+                    const __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(jEnd - j)), lanes);
+                    __m256 dx = _mm256_sub_ps(_mm256_maskload_ps(x + j, mask), xi);
+                    __m256 dy = _mm256_sub_ps(_mm256_maskload_ps(y + j, mask), yi);
+                    __m256 dz = _mm256_sub_ps(_mm256_maskload_ps(z + j, mask), zi);
+                    __m256 invR3 = _mm256_and_ps(_mm256_castsi256_ps(mask),
+                                                 VectorLaw<L>::invCube(_mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx))), c));
+                    __m256 sj = _mm256_mul_ps(_mm256_maskload_ps(m + j, mask), invR3);
+                    __m256 si = _mm256_mul_ps(mi, invR3);
+                    accXi = _mm256_fmadd_ps(dx, sj, accXi);
+                    accYi = _mm256_fmadd_ps(dy, sj, accYi);
+                    accZi = _mm256_fmadd_ps(dz, sj, accZi);
+                    _mm256_maskstore_ps(accX + j, mask, _mm256_fnmadd_ps(dx, si, _mm256_maskload_ps(accX + j, mask)));
+                    _mm256_maskstore_ps(accY + j, mask, _mm256_fnmadd_ps(dy, si, _mm256_maskload_ps(accY + j, mask)));
+                    _mm256_maskstore_ps(accZ + j, mask, _mm256_fnmadd_ps(dz, si, _mm256_maskload_ps(accZ + j, mask)));
+                }
+
+                accX[i] += horizontalSumAvx2(accXi);
+                accY[i] += horizontalSumAvx2(accYi);
+                accZ[i] += horizontalSumAvx2(accZi);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx2,fma")))
+        inline void accumulateAvx2(const Coefficients& c, __m256 dx, __m256 dy, __m256 dz, __m256 m,
+                                   __m256& accX, __m256& accY, __m256& accZ) {
+            __m256 r2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+            __m256 s = _mm256_mul_ps(m, VectorLaw<L>::invCube(r2, c));
+
+            accX = _mm256_fmadd_ps(dx, s, accX);
+            accY = _mm256_fmadd_ps(dy, s, accY);
+            accZ = _mm256_fmadd_ps(dz, s, accZ);
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx2,fma")))
+        void computeAvx2(const Coefficients& c, BodySystem& bodies, size_t begin, size_t end) {
+            const size_t n = bodies.size();
+            const size_t vecEnd = n & ~static_cast<size_t>(7);
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+
+            const __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n - vecEnd)),
+                                                        _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+
+            for (size_t i = begin; i < end; ++i) {
+                const __m256 xi = _mm256_set1_ps(x[i]);
+                const __m256 yi = _mm256_set1_ps(y[i]);
+                const __m256 zi = _mm256_set1_ps(z[i]);
+                __m256 accX = _mm256_setzero_ps();
+                __m256 accY = _mm256_setzero_ps();
+                __m256 accZ = _mm256_setzero_ps();
+
+                for (size_t j = 0; j < vecEnd; j += 8) {
+                    accumulateAvx2<L>(c, _mm256_sub_ps(_mm256_load_ps(x + j), xi),
+                                      _mm256_sub_ps(_mm256_load_ps(y + j), yi),
+                                      _mm256_sub_ps(_mm256_load_ps(z + j), zi),
+                                      _mm256_load_ps(m + j), accX, accY, accZ);
+                }
+                if (vecEnd < n) {
+                    // Masked-off lanes load zero mass and contribute nothing.
+                    accumulateAvx2<L>(c, _mm256_sub_ps(_mm256_maskload_ps(x + vecEnd, tailMask), xi),
+                                      _mm256_sub_ps(_mm256_maskload_ps(y + vecEnd, tailMask), yi),
+                                      _mm256_sub_ps(_mm256_maskload_ps(z + vecEnd, tailMask), zi),
+                                      _mm256_maskload_ps(m + vecEnd, tailMask), accX, accY, accZ);
+                }
+
+                bodies.ax[i] = Constants::G_UNITS * horizontalSumAvx2(accX);
+                bodies.ay[i] = Constants::G_UNITS * horizontalSumAvx2(accY);
+                bodies.az[i] = Constants::G_UNITS * horizontalSumAvx2(accZ);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx2,fma")))
+        void sourcesAvx2(const Coefficients& c, const float* x, const float* y, const float* z, const float* m,
+                         size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                         float* accX, float* accY, float* accZ) {
+            const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+            const size_t vecEnd = jBegin + ((jEnd - jBegin) & ~static_cast<size_t>(7));
+            const __m256i tailMask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(jEnd - vecEnd)), lanes);
+
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const __m256 xi = _mm256_set1_ps(x[i]);
+                const __m256 yi = _mm256_set1_ps(y[i]);
+                const __m256 zi = _mm256_set1_ps(z[i]);
+                __m256 accXi = _mm256_setzero_ps();
+                __m256 accYi = _mm256_setzero_ps();
+                __m256 accZi = _mm256_setzero_ps();
+
+                for (size_t j = jBegin; j < vecEnd; j += 8) {
+                    accumulateAvx2<L>(c, _mm256_sub_ps(_mm256_loadu_ps(x + j), xi),
+                                      _mm256_sub_ps(_mm256_loadu_ps(y + j), yi),
+                                      _mm256_sub_ps(_mm256_loadu_ps(z + j), zi),
+                                      _mm256_loadu_ps(m + j), accXi, accYi, accZi);
+                }
+                if (vecEnd < jEnd) {
+                    accumulateAvx2<L>(c, _mm256_sub_ps(_mm256_maskload_ps(x + vecEnd, tailMask), xi),
+                                      _mm256_sub_ps(_mm256_maskload_ps(y + vecEnd, tailMask), yi),
+                                      _mm256_sub_ps(_mm256_maskload_ps(z + vecEnd, tailMask), zi),
+                                      _mm256_maskload_ps(m + vecEnd, tailMask), accXi, accYi, accZi);
+                }
+
+                accX[i] += horizontalSumAvx2(accXi);
+                accY[i] += horizontalSumAvx2(accYi);
+                accZ[i] += horizontalSumAvx2(accZi);
+            }
+        }
+
+        // Lanes hold whole systems, so there is no horizontal sum: body i's
+        // sums stay in registers while the pairs (i, j > i) stream past.
+        // AVX2 covers the 16 lanes as two halves of 8.
+        template <SofteningLaw L>
+        __attribute__((target("avx2,fma")))
+        void lanesAvx2(const Coefficients& c, size_t n, const float* x, const float* y, const float* z, const float* m,
+                       const float* weights, float* ax, float* ay, float* az, float* nearest) {
+            const size_t w = kEnsembleLanes;
+            const __m256 g = _mm256_set1_ps(Constants::G_UNITS);
+            for (size_t k = 0; k < n * w; k += 8) {
+                _mm256_store_ps(ax + k, _mm256_setzero_ps());
+                _mm256_store_ps(ay + k, _mm256_setzero_ps());
+                _mm256_store_ps(az + k, _mm256_setzero_ps());
+            }
+            for (size_t half = 0; half < w; half += 8) {
+                __m256 closest = _mm256_loadu_ps(nearest + half);
+                for (size_t i = 0, k = 0; i < n; ++i) {
+                    const size_t a = i * w + half;
+                    const __m256 xi = _mm256_load_ps(x + a);
+                    const __m256 yi = _mm256_load_ps(y + a);
+                    const __m256 zi = _mm256_load_ps(z + a);
+                    const __m256 mi = _mm256_load_ps(m + a);
+                    __m256 accXi = _mm256_load_ps(ax + a);
+                    __m256 accYi = _mm256_load_ps(ay + a);
+                    __m256 accZi = _mm256_load_ps(az + a);
+                    for (size_t j = i + 1; j < n; ++j, ++k) {
+                        const size_t b = j * w + half;
+                        __m256 dx = _mm256_sub_ps(_mm256_load_ps(x + b), xi);
+                        __m256 dy = _mm256_sub_ps(_mm256_load_ps(y + b), yi);
+                        __m256 dz = _mm256_sub_ps(_mm256_load_ps(z + b), zi);
+                        __m256 r2 = _mm256_fmadd_ps(dz, dz, _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx)));
+                        closest = _mm256_min_ps(closest, _mm256_mul_ps(r2, _mm256_set1_ps(weights[k])));
+                        __m256 invR3 = VectorLaw<L>::invCube(r2, c);
+                        __m256 sj = _mm256_mul_ps(_mm256_load_ps(m + b), invR3);
+                        __m256 si = _mm256_mul_ps(mi, invR3);
+                        accXi = _mm256_fmadd_ps(dx, sj, accXi);
+                        accYi = _mm256_fmadd_ps(dy, sj, accYi);
+                        accZi = _mm256_fmadd_ps(dz, sj, accZi);
+                        _mm256_store_ps(ax + b, _mm256_fnmadd_ps(dx, si, _mm256_load_ps(ax + b)));
+                        _mm256_store_ps(ay + b, _mm256_fnmadd_ps(dy, si, _mm256_load_ps(ay + b)));
+                        _mm256_store_ps(az + b, _mm256_fnmadd_ps(dz, si, _mm256_load_ps(az + b)));
+                    }
+                    // Every later pair only touches j > i, so body i is final.
+                    _mm256_store_ps(ax + a, _mm256_mul_ps(g, accXi));
+                    _mm256_store_ps(ay + a, _mm256_mul_ps(g, accYi));
+                    _mm256_store_ps(az + a, _mm256_mul_ps(g, accZi));
+                }
+                _mm256_storeu_ps(nearest + half, closest);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx512f")))
+        inline void accumulateAvx512(const Coefficients& c, __m512 dx, __m512 dy, __m512 dz, __m512 m,
+                                     __m512& accX, __m512& accY, __m512& accZ) {
+            __m512 r2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+            __m512 s = _mm512_mul_ps(m, VectorLaw<L>::invCube(r2, c));
+
+            accX = _mm512_fmadd_ps(dx, s, accX);
+            accY = _mm512_fmadd_ps(dy, s, accY);
+            accZ = _mm512_fmadd_ps(dz, s, accZ);
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx512f")))
+        void computeAvx512(const Coefficients& c, BodySystem& bodies, size_t begin, size_t end) {
+            const size_t n = bodies.size();
+            const size_t vecEnd = n & ~static_cast<size_t>(15);
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+
+            const __mmask16 tailMask = static_cast<__mmask16>((1u << (n - vecEnd)) - 1u);
+
+            for (size_t i = begin; i < end; ++i) {
+                const __m512 xi = _mm512_set1_ps(x[i]);
+                const __m512 yi = _mm512_set1_ps(y[i]);
+                const __m512 zi = _mm512_set1_ps(z[i]);
+                __m512 accX = _mm512_setzero_ps();
+                __m512 accY = _mm512_setzero_ps();
+                __m512 accZ = _mm512_setzero_ps();
+
+                for (size_t j = 0; j < vecEnd; j += 16) {
+                    accumulateAvx512<L>(c, _mm512_sub_ps(_mm512_load_ps(x + j), xi),
+                                        _mm512_sub_ps(_mm512_load_ps(y + j), yi),
+                                        _mm512_sub_ps(_mm512_load_ps(z + j), zi),
+                                        _mm512_load_ps(m + j), accX, accY, accZ);
+                }
+                if (vecEnd < n) {
+                    accumulateAvx512<L>(c, _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, x + vecEnd), xi),
+                                        _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, y + vecEnd), yi),
+                                        _mm512_sub_ps(_mm512_maskz_loadu_ps(tailMask, z + vecEnd), zi),
+                                        _mm512_maskz_loadu_ps(tailMask, m + vecEnd), accX, accY, accZ);
+                }
+
+                bodies.ax[i] = Constants::G_UNITS * _mm512_reduce_add_ps(accX);
+                bodies.ay[i] = Constants::G_UNITS * _mm512_reduce_add_ps(accY);
+                bodies.az[i] = Constants::G_UNITS * _mm512_reduce_add_ps(accZ);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx512f")))
+        void sourcesAvx512(const Coefficients& c, const float* x, const float* y, const float* z, const float* m,
+                           size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                           float* accX, float* accY, float* accZ) {
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const __m512 xi = _mm512_set1_ps(x[i]);
+                const __m512 yi = _mm512_set1_ps(y[i]);
+                const __m512 zi = _mm512_set1_ps(z[i]);
+                __m512 accXi = _mm512_setzero_ps();
+                __m512 accYi = _mm512_setzero_ps();
+                __m512 accZi = _mm512_setzero_ps();
+
+                for (size_t j = jBegin; j < jEnd; j += 16) {
+                    const size_t remaining = jEnd - j;
+                    const __mmask16 lanes = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                                            : static_cast<__mmask16>((1u << remaining) - 1u);
+                    accumulateAvx512<L>(c, _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, x + j), xi),
+                                        _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, y + j), yi),
+                                        _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, z + j), zi),
+                                        _mm512_maskz_loadu_ps(lanes, m + j), accXi, accYi, accZi);
+                }
+
+                accX[i] += _mm512_reduce_add_ps(accXi);
+                accY[i] += _mm512_reduce_add_ps(accYi);
+                accZ[i] += _mm512_reduce_add_ps(accZi);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx512f")))
+        void tileAvx512(const Coefficients& c, const BodySystem& bodies, size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                        float* accX, float* accY, float* accZ) {
+            const float* x = bodies.x.data();
+            const float* y = bodies.y.data();
+            const float* z = bodies.z.data();
+            const float* m = bodies.mass.data();
+            const bool diagonal = iBegin == jBegin;
+
+            for (size_t i = iBegin; i < iEnd; ++i) {
+                const __m512 xi = _mm512_set1_ps(x[i]);
+                const __m512 yi = _mm512_set1_ps(y[i]);
+                const __m512 zi = _mm512_set1_ps(z[i]);
+                const __m512 mi = _mm512_set1_ps(m[i]);
+                __m512 accXi = _mm512_setzero_ps();
+                __m512 accYi = _mm512_setzero_ps();
+                __m512 accZi = _mm512_setzero_ps();
+
+                for (size_t j = diagonal ? i + 1 : jBegin; j < jEnd; j += 16) {
+                    const size_t remaining = jEnd - j;
+                    const __mmask16 lanes = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                                            : static_cast<__mmask16>((1u << remaining) - 1u);
+                    __m512 dx = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, x + j), xi);
+                    __m512 dy = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, y + j), yi);
+                    __m512 dz = _mm512_sub_ps(_mm512_maskz_loadu_ps(lanes, z + j), zi);
+                    __m512 r2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+                    __m512 invR3 = _mm512_maskz_mov_ps(lanes, VectorLaw<L>::invCube(r2, c));
+                    __m512 sj = _mm512_mul_ps(_mm512_maskz_loadu_ps(lanes, m + j), invR3);
+                    __m512 si = _mm512_mul_ps(mi, invR3);
+                    accXi = _mm512_fmadd_ps(dx, sj, accXi);
+                    accYi = _mm512_fmadd_ps(dy, sj, accYi);
+                    accZi = _mm512_fmadd_ps(dz, sj, accZi);
+                    _mm512_mask_storeu_ps(accX + j, lanes, _mm512_fnmadd_ps(dx, si, _mm512_maskz_loadu_ps(lanes, accX + j)));
+                    _mm512_mask_storeu_ps(accY + j, lanes, _mm512_fnmadd_ps(dy, si, _mm512_maskz_loadu_ps(lanes, accY + j)));
+                    _mm512_mask_storeu_ps(accZ + j, lanes, _mm512_fnmadd_ps(dz, si, _mm512_maskz_loadu_ps(lanes, accZ + j)));
+                }
+
+                accX[i] += _mm512_reduce_add_ps(accXi);
+                accY[i] += _mm512_reduce_add_ps(accYi);
+                accZ[i] += _mm512_reduce_add_ps(accZi);
+            }
+        }
+
+        template <SofteningLaw L>
+        __attribute__((target("avx512f")))
+        void lanesAvx512(const Coefficients& c, size_t n, const float* x, const float* y, const float* z, const float* m,
+                         const float* weights, float* ax, float* ay, float* az, float* nearest) {
+            const size_t w = kEnsembleLanes;
+            const __m512 g = _mm512_set1_ps(Constants::G_UNITS);
+            for (size_t k = 0; k < n * w; k += w) {
+                _mm512_store_ps(ax + k, _mm512_setzero_ps());
+                _mm512_store_ps(ay + k, _mm512_setzero_ps());
+                _mm512_store_ps(az + k, _mm512_setzero_ps());
+            }
+            __m512 closest = _mm512_loadu_ps(nearest);
+            for (size_t i = 0, k = 0; i < n; ++i) {
+                const size_t a = i * w;
+                const __m512 xi = _mm512_load_ps(x + a);
+                const __m512 yi = _mm512_load_ps(y + a);
+                const __m512 zi = _mm512_load_ps(z + a);
+                const __m512 mi = _mm512_load_ps(m + a);
+                __m512 accXi = _mm512_load_ps(ax + a);
+                __m512 accYi = _mm512_load_ps(ay + a);
+                __m512 accZi = _mm512_load_ps(az + a);
+                for (size_t j = i + 1; j < n; ++j, ++k) {
+                    const size_t b = j * w;
+                    __m512 dx = _mm512_sub_ps(_mm512_load_ps(x + b), xi);
+                    __m512 dy = _mm512_sub_ps(_mm512_load_ps(y + b), yi);
+                    __m512 dz = _mm512_sub_ps(_mm512_load_ps(z + b), zi);
+                    __m512 r2 = _mm512_fmadd_ps(dz, dz, _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx)));
+                    closest = _mm512_min_ps(closest, _mm512_mul_ps(r2, _mm512_set1_ps(weights[k])));
+                    __m512 invR3 = VectorLaw<L>::invCube(r2, c);
+                    __m512 sj = _mm512_mul_ps(_mm512_load_ps(m + b), invR3);
+                    __m512 si = _mm512_mul_ps(mi, invR3);
+                    accXi = _mm512_fmadd_ps(dx, sj, accXi);
+                    accYi = _mm512_fmadd_ps(dy, sj, accYi);
+                    accZi = _mm512_fmadd_ps(dz, sj, accZi);
+                    _mm512_store_ps(ax + b, _mm512_fnmadd_ps(dx, si, _mm512_load_ps(ax + b)));
+                    _mm512_store_ps(ay + b, _mm512_fnmadd_ps(dy, si, _mm512_load_ps(ay + b)));
+                    _mm512_store_ps(az + b, _mm512_fnmadd_ps(dz, si, _mm512_load_ps(az + b)));
+                }
+                _mm512_store_ps(ax + a, _mm512_mul_ps(g, accXi));
+                _mm512_store_ps(ay + a, _mm512_mul_ps(g, accYi));
+                _mm512_store_ps(az + a, _mm512_mul_ps(g, accZi));
+            }
+            _mm512_storeu_ps(nearest, closest);
+        }
+#endif
+
+        Isa supportedIsa(Isa isa) {
+            Isa supported = detectIsa();
+            return static_cast<int>(isa) > static_cast<int>(supported) ? supported : isa;
+        }
+
+        template <SofteningLaw L>
+        void computeWith(Isa isa, const Coefficients& c, BodySystem& bodies, size_t begin, size_t end) {
+            switch (isa) {
+#ifdef GRAVITY_X86_DISPATCH
+                case Isa::Avx512: computeAvx512<L>(c, bodies, begin, end); break;
+                case Isa::Avx2: computeAvx2<L>(c, bodies, begin, end); break;
+#endif
+                default: computeScalar<L>(c, bodies, begin, end); break;
+            }
+        }
+
+        template <SofteningLaw L>
+        void sourcesWith(Isa isa, const Coefficients& c, const float* x, const float* y, const float* z, const float* m,
+                         size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                         float* accX, float* accY, float* accZ) {
+            switch (isa) {
+#ifdef GRAVITY_X86_DISPATCH
+                case Isa::Avx512: sourcesAvx512<L>(c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+                case Isa::Avx2: sourcesAvx2<L>(c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+#endif
+                default: sourcesScalar<L>(c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+            }
+        }
+
+        template <SofteningLaw L>
+        void tileWith(Isa isa, const Coefficients& c, const BodySystem& bodies,
+                      size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                      float* accX, float* accY, float* accZ) {
+            switch (isa) {
+#ifdef GRAVITY_X86_DISPATCH
+                case Isa::Avx512: tileAvx512<L>(c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+                case Isa::Avx2: tileAvx2<L>(c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+#endif
+                default: tileScalar<L>(c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ); break;
+            }
+        }
+
+        template <SofteningLaw L>
+        void lanesWith(Isa isa, const Coefficients& c, size_t n, const float* x, const float* y, const float* z, const float* m,
+                       const float* weights, float* ax, float* ay, float* az, float* nearest) {
+            switch (isa) {
+#ifdef GRAVITY_X86_DISPATCH
+                case Isa::Avx512: lanesAvx512<L>(c, n, x, y, z, m, weights, ax, ay, az, nearest); break;
+                case Isa::Avx2: lanesAvx2<L>(c, n, x, y, z, m, weights, ax, ay, az, nearest); break;
+#endif
+                default: lanesScalar<L>(c, n, x, y, z, m, weights, ax, ay, az, nearest); break;
+            }
+        }
+    }
+
+    Isa detectIsa() {
+#ifdef GRAVITY_X86_DISPATCH
+        static const Isa detected = []() {
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx512f")) return Isa::Avx512;
+            if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::Avx2;
+            return Isa::Scalar;
+        }();
+        return detected;
+#else
+        return Isa::Scalar;
+#endif
+    }
+
+    const char* isaName(Isa isa) {
+        switch (isa) {
+            case Isa::Avx2: return "avx2";
+            case Isa::Avx512: return "avx512";
+            default: return "scalar";
+        }
+    }
+
+    bool parseIsa(const std::string& name, Isa& isa) {
+        if (name == "auto") isa = detectIsa();
+        else if (name == "scalar") isa = Isa::Scalar;
+        else if (name == "avx2") isa = Isa::Avx2;
+        else if (name == "avx512") isa = Isa::Avx512;
+        else return false;
+        return true;
+    }
+
+    const char* softeningName(SofteningLaw law) {
+        switch (law) {
+            case SofteningLaw::Plummer: return "plummer";
+            case SofteningLaw::Spline: return "spline";
+            default: return "none";
+        }
+    }
+
+    bool parseSoftening(const std::string& name, SofteningLaw& law) {
+        if (name == "none") law = SofteningLaw::None;
+        else if (name == "plummer") law = SofteningLaw::Plummer;
+        else if (name == "spline") law = SofteningLaw::Spline;
+        else return false;
+        return true;
+    }
+
+    void computeRange(Isa isa, const Softening& softening, BodySystem& bodies, size_t begin, size_t end) {
+        isa = supportedIsa(isa);
+        const Coefficients c(softening);
+        switch (softening.law) {
+            case SofteningLaw::Plummer: computeWith<SofteningLaw::Plummer>(isa, c, bodies, begin, end); break;
+            case SofteningLaw::Spline: computeWith<SofteningLaw::Spline>(isa, c, bodies, begin, end); break;
+            default: computeWith<SofteningLaw::None>(isa, c, bodies, begin, end); break;
+        }
+    }
+
+    void accumulateSources(Isa isa, const Softening& softening, const float* x, const float* y, const float* z, const float* m,
+                           size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                           float* accX, float* accY, float* accZ) {
+        isa = supportedIsa(isa);
+        const Coefficients c(softening);
+        switch (softening.law) {
+            case SofteningLaw::Plummer:
+                sourcesWith<SofteningLaw::Plummer>(isa, c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+            case SofteningLaw::Spline:
+                sourcesWith<SofteningLaw::Spline>(isa, c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+            default:
+                sourcesWith<SofteningLaw::None>(isa, c, x, y, z, m, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+        }
+    }
+
+    void accumulateTile(Isa isa, const Softening& softening, const BodySystem& bodies,
+                        size_t iBegin, size_t iEnd, size_t jBegin, size_t jEnd,
+                        float* accX, float* accY, float* accZ) {
+        isa = supportedIsa(isa);
+        const Coefficients c(softening);
+        switch (softening.law) {
+            case SofteningLaw::Plummer:
+                tileWith<SofteningLaw::Plummer>(isa, c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+            case SofteningLaw::Spline:
+                tileWith<SofteningLaw::Spline>(isa, c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+            default:
+                tileWith<SofteningLaw::None>(isa, c, bodies, iBegin, iEnd, jBegin, jEnd, accX, accY, accZ);
+                break;
+        }
+    }
+
+    void computeLanes(Isa isa, const Softening& softening, size_t bodyCount,
+                      const float* x, const float* y, const float* z, const float* m, const float* pairWeights,
+                      float* ax, float* ay, float* az, float* nearest) {
+        isa = supportedIsa(isa);
+        const Coefficients c(softening);
+        switch (softening.law) {
+            case SofteningLaw::Plummer:
+                lanesWith<SofteningLaw::Plummer>(isa, c, bodyCount, x, y, z, m, pairWeights, ax, ay, az, nearest);
+                break;
+            case SofteningLaw::Spline:
+                lanesWith<SofteningLaw::Spline>(isa, c, bodyCount, x, y, z, m, pairWeights, ax, ay, az, nearest);
+                break;
+            default:
+                lanesWith<SofteningLaw::None>(isa, c, bodyCount, x, y, z, m, pairWeights, ax, ay, az, nearest);
+                break;
+        }
+    }
+}
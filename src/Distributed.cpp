@@ -0,0 +1,416 @@
+#include "Distributed.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    const size_t kLeafCapacity = 8;
+    const size_t kSamplesPerRank = 256;
+    const int kMortonBits = 21; // per axis, 63 bits in all
+
+    // Axis-aligned box of one process's bodies, as exchanged before each evaluation.
+    struct Box {
+        float min[3];
+        float max[3];
+        uint64_t count;
+    };
+
+    // A body in flight between processes.
+    struct BodyRecord {
+        uint64_t id;
+        float x, y, z, vx, vy, vz, ax, ay, az, mass, radius;
+    };
+
+    struct Sample {
+        uint64_t key;
+        double weight;
+    };
+
+    template <typename T>
+    void append(std::vector<char>& out, const T& value) {
+        const size_t at = out.size();
+        out.resize(at + sizeof(T));
+        std::memcpy(out.data() + at, &value, sizeof(T));
+    }
+
+    template <typename T>
+    size_t countOf(const std::vector<char>& in) {
+        return in.size() / sizeof(T);
+    }
+
+    template <typename T>
+    T readAt(const std::vector<char>& in, size_t index) {
+        T value;
+        std::memcpy(&value, in.data() + index * sizeof(T), sizeof(T));
+        return value;
+    }
+
+    Box boxOf(const BodySystem& bodies) {
+        Box box;
+        box.count = bodies.size();
+        for (int axis = 0; axis < 3; ++axis) {
+            box.min[axis] = 0.0f;
+            box.max[axis] = 0.0f;
+        }
+        if (bodies.empty()) return box;
+        const AlignedVector<float>* coordinates[3] = { &bodies.x, &bodies.y, &bodies.z };
+        for (int axis = 0; axis < 3; ++axis) {
+            const AlignedVector<float>& c = *coordinates[axis];
+            auto range = std::minmax_element(c.begin(), c.end());
+            box.min[axis] = *range.first;
+            box.max[axis] = *range.second;
+        }
+        return box;
+    }
+
+    bool gatherBoxes(Transport& transport, const BodySystem& bodies, std::vector<Box>& boxes) {
+        std::vector<char> mine;
+        append(mine, boxOf(bodies));
+        std::vector<std::vector<char>> all;
+        if (!transport.allGather(mine, all)) return false;
+        boxes.resize(all.size());
+        for (size_t p = 0; p < all.size(); ++p) boxes[p] = readAt<Box>(all[p], 0);
+        return true;
+    }
+
+    // Spreads the low 21 bits of v to every third bit.
+    uint64_t spreadBits(uint64_t v) {
+        v &= 0x1FFFFF;
+        v = (v | v << 32) & 0x1F00000000FFFFull;
+        v = (v | v << 16) & 0x1F0000FF0000FFull;
+        v = (v | v << 8) & 0x100F00F00F00F00Full;
+        v = (v | v << 4) & 0x10C30C30C30C30C3ull;
+        v = (v | v << 2) & 0x1249249249249249ull;
+        return v;
+    }
+
+    // Morton keys of the bodies within the box [low, low + extent).
+    void mortonKeys(const BodySystem& bodies, const float* low, float extent, std::vector<uint64_t>& keys) {
+        const size_t n = bodies.size();
+        const float cells = static_cast<float>(1u << kMortonBits);
+        const float scale = extent > 0.0f ? cells / extent : 0.0f;
+        const AlignedVector<float>* coordinates[3] = { &bodies.x, &bodies.y, &bodies.z };
+        keys.assign(n, 0);
+        for (int axis = 0; axis < 3; ++axis) {
+            const AlignedVector<float>& c = *coordinates[axis];
+            for (size_t i = 0; i < n; ++i) {
+                float cell = std::min(std::max((c[i] - low[axis]) * scale, 0.0f), cells - 1.0f);
+                keys[i] |= spreadBits(static_cast<uint64_t>(cell)) << axis;
+            }
+        }
+    }
+
+    void packBody(const BodySystem& bodies, const std::vector<uint64_t>& ids, size_t i, std::vector<char>& out) {
+        BodyRecord r = { ids[i], bodies.x[i], bodies.y[i], bodies.z[i], bodies.vx[i], bodies.vy[i], bodies.vz[i],
+                         bodies.ax[i], bodies.ay[i], bodies.az[i], bodies.mass[i], bodies.radius[i] };
+        append(out, r);
+    }
+
+    // Replaces bodies and ids with every record received.
+    void unpackBodies(const std::vector<std::vector<char>>& incoming, BodySystem& bodies, std::vector<uint64_t>& ids) {
+        size_t total = 0;
+        for (const std::vector<char>& message : incoming) total += countOf<BodyRecord>(message);
+        bodies.resize(total);
+        ids.resize(total);
+        size_t i = 0;
+        for (const std::vector<char>& message : incoming) {
+            const size_t count = countOf<BodyRecord>(message);
+            for (size_t k = 0; k < count; ++k, ++i) {
+                BodyRecord r = readAt<BodyRecord>(message, k);
+                ids[i] = r.id;
+                bodies.x[i] = r.x; bodies.y[i] = r.y; bodies.z[i] = r.z;
+                bodies.vx[i] = r.vx; bodies.vy[i] = r.vy; bodies.vz[i] = r.vz;
+                bodies.ax[i] = r.ax; bodies.ay[i] = r.ay; bodies.az[i] = r.az;
+                bodies.mass[i] = r.mass;
+                bodies.radius[i] = r.radius;
+            }
+        }
+    }
+}
+
+DistributedSolver::DistributedSolver(Transport& link, std::unique_ptr<ForceSolver> innerSolver, float openingAngle)
+    : transport(link), inner(std::move(innerSolver)), theta(openingAngle) {}
+
+double DistributedSolver::takeWork() {
+    double taken = work;
+    work = 0.0;
+    return taken;
+}
+
+void DistributedSolver::collectEssential(const BodySystem& bodies, const float* box, std::vector<char>& out) const {
+    if (tree.nodes.empty()) return;
+    const float theta2 = theta * theta;
+    uint32_t stack[Octree::kMaxDepth * 7 + 8];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Octree::Node& node = tree.nodes[stack[--top]];
+        if (node.isLeaf()) {
+            for (uint32_t k = node.begin; k < node.end; ++k) {
+                uint32_t j = tree.bodyOrder[k];
+                const float source[4] = { bodies.x[j], bodies.y[j], bodies.z[j], bodies.mass[j] };
+                append(out, source);
+            }
+            continue;
+        }
+        // Distance from the centre of mass to the nearest point of the box:
+        // accepted here means accepted for every body inside it.
+        const float com[3] = { node.comX, node.comY, node.comZ };
+        float dist2 = 0.0f;
+        for (int axis = 0; axis < 3; ++axis) {
+            float gap = std::max(std::max(box[axis] - com[axis], com[axis] - box[3 + axis]), 0.0f);
+            dist2 += gap * gap;
+        }
+        const float size = 2.0f * node.halfSize;
+        if (size * size < theta2 * dist2) {
+            const float source[4] = { node.comX, node.comY, node.comZ, node.mass };
+            append(out, source);
+        } else {
+            for (uint8_t c = 0; c < node.childCount; ++c) stack[top++] = static_cast<uint32_t>(node.firstChild + c);
+        }
+    }
+}
+
+void DistributedSolver::computeAccelerations(BodySystem& bodies, ThreadPool& pool) {
+    const size_t n = bodies.size();
+    const int self = transport.rank();
+    std::vector<Box> boxes;
+    {
+        PROFILE_ZONE("distributed.exchange");
+        if (!linkFailed && !gatherBoxes(transport, bodies, boxes)) linkFailed = true;
+        outgoing.assign(transport.size(), std::vector<char>());
+        if (!linkFailed) {
+            tree.build(bodies, kLeafCapacity);
+            for (int p = 0; p < transport.size(); ++p) {
+                if (p == self || boxes[p].count == 0) continue;
+                const float box[6] = { boxes[p].min[0], boxes[p].min[1], boxes[p].min[2],
+                                       boxes[p].max[0], boxes[p].max[1], boxes[p].max[2] };
+                collectEssential(bodies, box, outgoing[p]);
+            }
+            if (!transport.exchange(outgoing, incoming)) linkFailed = true;
+        }
+        if (linkFailed) incoming.assign(transport.size(), std::vector<char>());
+    }
+
+    imported = 0;
+    for (int p = 0; p < transport.size(); ++p) {
+        if (p != self) imported += incoming[p].size() / (4 * sizeof(float));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (imported == 0) {
+        inner->computeAccelerations(bodies, pool);
+    } else {
+        combined.resize(n + imported);
+        std::copy(bodies.x.begin(), bodies.x.end(), combined.x.begin());
+        std::copy(bodies.y.begin(), bodies.y.end(), combined.y.begin());
+        std::copy(bodies.z.begin(), bodies.z.end(), combined.z.begin());
+        std::copy(bodies.mass.begin(), bodies.mass.end(), combined.mass.begin());
+        size_t at = n;
+        for (int p = 0; p < transport.size(); ++p) {
+            if (p == self) continue;
+            const size_t count = incoming[p].size() / (4 * sizeof(float));
+            for (size_t k = 0; k < count; ++k, ++at) {
+                float source[4];
+                std::memcpy(source, incoming[p].data() + k * sizeof(source), sizeof(source));
+                combined.x[at] = source[0];
+                combined.y[at] = source[1];
+                combined.z[at] = source[2];
+                combined.mass[at] = source[3];
+            }
+        }
+        targets.resize(n);
+        for (size_t i = 0; i < n; ++i) targets[i] = static_cast<uint32_t>(i);
+        inner->computeAccelerationsFor(combined, pool, targets);
+        std::copy(combined.ax.begin(), combined.ax.begin() + n, bodies.ax.begin());
+        std::copy(combined.ay.begin(), combined.ay.begin() + n, bodies.ay.begin());
+        std::copy(combined.az.begin(), combined.az.begin() + n, bodies.az.begin());
+    }
+    work += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+DistributedWorld::DistributedWorld(Transport& link, size_t threadCount)
+    : transport(link), pool(new ThreadPool(threadCount)) {
+    setSolver(solverCfg);
+    setIntegrator(integratorCfg);
+}
+
+bool DistributedWorld::setSolver(const SolverConfig& config) {
+    std::unique_ptr<ForceSolver> created = createForceSolver(config);
+    if (!created) return false;
+    solver.reset(new DistributedSolver(transport, std::move(created), config.theta));
+    solverCfg = config;
+    if (timeIntegrator) timeIntegrator->reset();
+    return true;
+}
+
+bool DistributedWorld::setIntegrator(const IntegratorConfig& config) {
+    if (config.blockLevels > 0) return false;
+    std::unique_ptr<Integrator> created = createIntegrator(config);
+    if (!created) return false;
+    timeIntegrator = std::move(created);
+    integratorCfg = config;
+    return true;
+}
+
+bool DistributedWorld::distribute(const BodySystem& all) {
+    // Every rank learns the body count first, so all of them refuse
+    // together a run with more processes than bodies.
+    const size_t n = all.size();
+    std::vector<char> mine;
+    append(mine, static_cast<uint64_t>(n));
+    std::vector<std::vector<char>> counts;
+    if (!transport.allGather(mine, counts)) return false;
+    uint64_t total = 0;
+    for (const std::vector<char>& count : counts) total += readAt<uint64_t>(count, 0);
+    if (total < static_cast<uint64_t>(transport.size())) {
+        if (transport.rank() == 0) {
+            std::cerr << "Distributed run: " << transport.size() << " processes for " << total
+                      << " bodies; use at most one process per body" << std::endl;
+        }
+        return false;
+    }
+
+    // Rank 0 deals out contiguous slices; the first rebalance sorts them out.
+    std::vector<std::vector<char>> outgoing(transport.size());
+    std::vector<uint64_t> inputIds(n);
+    for (size_t i = 0; i < n; ++i) inputIds[i] = i;
+    for (size_t i = 0; i < n; ++i) {
+        packBody(all, inputIds, i, outgoing[i * transport.size() / n]);
+    }
+    std::vector<std::vector<char>> incoming;
+    if (!transport.exchange(outgoing, incoming)) return false;
+    unpackBodies(incoming, bodies, ids);
+    return rebalance(0.0);
+}
+
+bool DistributedWorld::rebalance(double secondsPerBody) {
+    PROFILE_ZONE("distributed.rebalance");
+    const int ranks = transport.size();
+    std::vector<Box> boxes;
+    if (!gatherBoxes(transport, bodies, boxes)) return false;
+    float low[3] = { 0.0f, 0.0f, 0.0f }, high[3] = { 0.0f, 0.0f, 0.0f };
+    bool any = false;
+    for (const Box& box : boxes) {
+        if (box.count == 0) continue;
+        for (int axis = 0; axis < 3; ++axis) {
+            low[axis] = any ? std::min(low[axis], box.min[axis]) : box.min[axis];
+            high[axis] = any ? std::max(high[axis], box.max[axis]) : box.max[axis];
+        }
+        any = true;
+    }
+    if (!any) return true;
+    const float extent = std::max(high[0] - low[0], std::max(high[1] - low[1], high[2] - low[2])) * 1.0001f;
+
+    const size_t n = bodies.size();
+    std::vector<uint64_t> keys;
+    mortonKeys(bodies, low, extent, keys);
+    std::vector<uint32_t> order(n);
+    for (size_t i = 0; i < n; ++i) order[i] = static_cast<uint32_t>(i);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+
+    // Every local body weighs the same, so evenly spaced samples of the
+    // sorted keys, each standing for the bodies up to the next, describe
+    // the local load; the union of all samples describes the global one.
+    const double weight = secondsPerBody > 0.0 ? secondsPerBody : 1.0;
+    const size_t sampleCount = std::min(n, kSamplesPerRank);
+    std::vector<char> mine;
+    for (size_t k = 0; k < sampleCount; ++k) {
+        const size_t begin = k * n / sampleCount, end = (k + 1) * n / sampleCount;
+        Sample sample = { keys[order[begin]], weight * static_cast<double>(end - begin) };
+        append(mine, sample);
+    }
+    std::vector<std::vector<char>> all;
+    if (!transport.allGather(mine, all)) return false;
+    std::vector<Sample> samples;
+    double total = 0.0;
+    for (const std::vector<char>& message : all) {
+        for (size_t k = 0; k < countOf<Sample>(message); ++k) {
+            samples.push_back(readAt<Sample>(message, k));
+            total += samples.back().weight;
+        }
+    }
+    std::sort(samples.begin(), samples.end(), [](const Sample& a, const Sample& b) { return a.key < b.key; });
+
+    // Rank p owns keys from splits[p - 1] up to splits[p].
+    std::vector<uint64_t> splits;
+    double running = 0.0;
+    size_t next = 0;
+    for (int p = 1; p < ranks; ++p) {
+        const double target = total * p / ranks;
+        while (next < samples.size() && running + samples[next].weight <= target) running += samples[next++].weight;
+        splits.push_back(next < samples.size() ? samples[next].key : ~0ull);
+    }
+
+    std::vector<std::vector<char>> outgoing(ranks);
+    for (uint32_t i : order) {
+        const int owner = static_cast<int>(std::upper_bound(splits.begin(), splits.end(), keys[i]) - splits.begin());
+        packBody(bodies, ids, i, outgoing[owner]);
+    }
+    std::vector<std::vector<char>> incoming;
+    if (!transport.exchange(outgoing, incoming)) return false;
+    // Arrivals from each rank are sorted already, and the ranks' ranges are
+    // consecutive, so concatenating in rank order keeps the curve order.
+    unpackBodies(incoming, bodies, ids);
+
+    timeIntegrator->reset();
+    ++rebalances;
+    return true;
+}
+
+bool DistributedWorld::step() {
+    PROFILE_ZONE("distributed.step");
+    // No contact stage: pairs may straddle two processes.
+    timeIntegrator->step(bodies, *solver, *pool, []() {});
+    if (solver->failed()) return false;
+    ++stepCount;
+    simulationTime += integratorCfg.timeStep;
+    workSinceCheck += solver->takeWork();
+
+    if (rebalanceInterval == 0 || stepCount % rebalanceInterval != 0) return true;
+    std::vector<char> mine;
+    append(mine, workSinceCheck);
+    std::vector<std::vector<char>> all;
+    if (!transport.allGather(mine, all)) return false;
+    double slowest = 0.0, sum = 0.0;
+    for (const std::vector<char>& message : all) {
+        double seconds = readAt<double>(message, 0);
+        slowest = std::max(slowest, seconds);
+        sum += seconds;
+    }
+    const double mean = sum / static_cast<double>(all.size());
+    lastImbalance = mean > 0.0 ? slowest / mean - 1.0 : 0.0;
+    const double secondsPerBody = bodies.empty() ? 0.0 : workSinceCheck / static_cast<double>(bodies.size());
+    workSinceCheck = 0.0;
+    if (lastImbalance <= imbalanceTolerance) return true;
+    return rebalance(secondsPerBody);
+}
+
+bool DistributedWorld::gather(BodySystem& all) {
+    std::vector<std::vector<char>> outgoing(transport.size());
+    for (size_t i = 0; i < bodies.size(); ++i) packBody(bodies, ids, i, outgoing[0]);
+    std::vector<std::vector<char>> incoming;
+    if (!transport.exchange(outgoing, incoming)) return false;
+    if (transport.rank() != 0) return true;
+
+    BodySystem received;
+    std::vector<uint64_t> receivedIds;
+    unpackBodies(incoming, received, receivedIds);
+    const size_t n = received.size();
+    all.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        const uint64_t i = receivedIds[k];
+        if (i >= n) {
+            std::cerr << "Distributed gather: body id " << i << " out of range" << std::endl;
+            return false;
+        }
+        all.x[i] = received.x[k]; all.y[i] = received.y[k]; all.z[i] = received.z[k];
+        all.vx[i] = received.vx[k]; all.vy[i] = received.vy[k]; all.vz[i] = received.vz[k];
+        all.ax[i] = received.ax[k]; all.ay[i] = received.ay[k]; all.az[i] = received.az[k];
+        all.mass[i] = received.mass[k];
+        all.radius[i] = received.radius[k];
+    }
+    return true;
+}
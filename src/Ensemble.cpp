@@ -0,0 +1,231 @@
+#include "Ensemble.hpp"
+#include "Physics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+namespace {
+    const size_t kLanes = DirectKernels::kEnsembleLanes;
+
+    // splitmix64 stream with Box-Muller normals; one stream per member, so
+    // the perturbations do not depend on the thread count.
+    class Jitter {
+    public:
+        Jitter(uint64_t seed, uint64_t member) : state(seed ^ (member * 0xd1b54a32d192ed03ull)) {}
+
+        double normal() {
+            double u1 = uniform(), u2 = uniform();
+            return std::sqrt(-2.0 * std::log(u1)) * std::cos(2.0 * M_PI * u2);
+        }
+
+    private:
+        uint64_t state;
+
+        double uniform() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            z ^= z >> 31;
+            return (static_cast<double>(z >> 11) + 0.5) * (1.0 / 9007199254740992.0);
+        }
+    };
+
+    struct CentreOfMass {
+        double x = 0, y = 0, z = 0, vx = 0, vy = 0, vz = 0;
+    };
+
+    CentreOfMass centreOfMass(const BodySystem& bodies) {
+        CentreOfMass c;
+        double total = 0.0;
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            const double m = bodies.mass[i];
+            c.x += m * bodies.x[i]; c.y += m * bodies.y[i]; c.z += m * bodies.z[i];
+            c.vx += m * bodies.vx[i]; c.vy += m * bodies.vy[i]; c.vz += m * bodies.vz[i];
+            total += m;
+        }
+        if (total > 0.0) {
+            c.x /= total; c.y /= total; c.z /= total;
+            c.vx /= total; c.vy /= total; c.vz /= total;
+        }
+        return c;
+    }
+}
+
+Ensemble::Ensemble(size_t threadCount) : pool(new ThreadPool(threadCount)) {}
+
+bool Ensemble::configure(const EnsembleConfig& config) {
+    DirectKernels::Isa parsedIsa;
+    DirectKernels::Softening parsedSoftening;
+    if (!DirectKernels::parseIsa(config.kernel, parsedIsa)) return false;
+    if (!DirectKernels::parseSoftening(config.softening, parsedSoftening.law)) return false;
+    parsedSoftening.length = config.softeningLength;
+    if (parsedSoftening.law != DirectKernels::SofteningLaw::None && !(config.softeningLength > 0.0f)) return false;
+    if (config.members == 0 || !(config.positionJitter >= 0.0f) || !(config.velocityJitter >= 0.0f)) return false;
+    if (!(config.timeStep > 0.0f)) return false;
+    settings = config;
+    kernelIsa = parsedIsa;
+    softeningLaw = parsedSoftening;
+    return true;
+}
+
+size_t Ensemble::offset(size_t m, size_t i) const {
+    return (m / kLanes) * bodies * kLanes + i * kLanes + m % kLanes;
+}
+
+void Ensemble::populate(const BodySystem& base) {
+    bodies = base.size();
+    blocks = (settings.members + kLanes - 1) / kLanes;
+    const size_t slots = blocks * bodies * kLanes;
+    AlignedVector<float>* arrays[] = { &x, &y, &z, &vx, &vy, &vz, &ax, &ay, &az, &mass };
+    for (AlignedVector<float>* array : arrays) array->assign(slots, 0.0f);
+    radius.assign(base.radius.begin(), base.radius.end());
+    // The kernel tracks squared distance over squared contact distance,
+    // so the closest approach needs no square root in the pair loop.
+    pairWeights.clear();
+    for (size_t i = 0; i < bodies; ++i) {
+        for (size_t j = i + 1; j < bodies; ++j) {
+            const float contact = radius[i] + radius[j];
+            pairWeights.push_back(contact > 0.0f ? 1.0f / (contact * contact) : 0.0f);
+        }
+    }
+    closest.assign(blocks * kLanes, std::numeric_limits<float>::max());
+    stepCount = 0;
+    simulationTime = 0.0;
+
+    // Jitter scales: RMS distance and speed about the centre of mass.
+    const CentreOfMass c = centreOfMass(base);
+    double spread = 0.0, speed = 0.0;
+    for (size_t i = 0; i < bodies; ++i) {
+        const double dx = base.x[i] - c.x, dy = base.y[i] - c.y, dz = base.z[i] - c.z;
+        const double dvx = base.vx[i] - c.vx, dvy = base.vy[i] - c.vy, dvz = base.vz[i] - c.vz;
+        spread += dx * dx + dy * dy + dz * dz;
+        speed += dvx * dvx + dvy * dvy + dvz * dvz;
+    }
+    if (bodies > 0) {
+        spread = std::sqrt(spread / bodies) * settings.positionJitter;
+        speed = std::sqrt(speed / bodies) * settings.velocityJitter;
+    }
+
+    // Padding lanes of the last block run unperturbed copies nobody reads.
+    for (size_t m = 0; m < blocks * kLanes; ++m) {
+        const bool perturbed = m > 0 && m < settings.members;
+        Jitter jitter(settings.seed, m);
+        for (size_t i = 0; i < bodies; ++i) {
+            const size_t k = offset(m, i);
+            x[k] = base.x[i]; y[k] = base.y[i]; z[k] = base.z[i];
+            vx[k] = base.vx[i]; vy[k] = base.vy[i]; vz[k] = base.vz[i];
+            mass[k] = base.mass[i];
+            if (!perturbed) continue;
+            x[k] += static_cast<float>(spread * jitter.normal());
+            y[k] += static_cast<float>(spread * jitter.normal());
+            z[k] += static_cast<float>(spread * jitter.normal());
+            vx[k] += static_cast<float>(speed * jitter.normal());
+            vy[k] += static_cast<float>(speed * jitter.normal());
+            vz[k] += static_cast<float>(speed * jitter.normal());
+        }
+    }
+
+    initialEnergy.assign(settings.members, 0.0);
+    pool->parallelFor(settings.members, [&](size_t m, size_t) {
+        BodySystem single;
+        member(m, single);
+        initialEnergy[m] = Physics::totalEnergy(single, softeningLaw);
+    });
+    pool->parallelFor(blocks, [&](size_t block, size_t) { computeBlock(block); });
+    // The priming pass saw the initial positions; only stepped ones count.
+    std::fill(closest.begin(), closest.end(), std::numeric_limits<float>::max());
+}
+
+void Ensemble::computeBlock(size_t block) {
+    const size_t first = block * bodies * kLanes;
+    DirectKernels::computeLanes(kernelIsa, softeningLaw, bodies, x.data() + first, y.data() + first, z.data() + first,
+                                mass.data() + first, pairWeights.data(), ax.data() + first, ay.data() + first,
+                                az.data() + first, closest.data() + block * kLanes);
+}
+
+void Ensemble::stepBlock(size_t block) {
+    const size_t first = block * bodies * kLanes, last = first + bodies * kLanes;
+    const float dt = settings.timeStep, halfDt = 0.5f * dt;
+    for (size_t k = first; k < last; ++k) {
+        vx[k] += ax[k] * halfDt;
+        vy[k] += ay[k] * halfDt;
+        vz[k] += az[k] * halfDt;
+        x[k] += vx[k] * dt;
+        y[k] += vy[k] * dt;
+        z[k] += vz[k] * dt;
+    }
+    computeBlock(block);
+    for (size_t k = first; k < last; ++k) {
+        vx[k] += ax[k] * halfDt;
+        vy[k] += ay[k] * halfDt;
+        vz[k] += az[k] * halfDt;
+    }
+}
+
+void Ensemble::step() {
+    pool->parallelFor(blocks, [&](size_t block, size_t) { stepBlock(block); });
+    ++stepCount;
+    simulationTime += settings.timeStep;
+}
+
+void Ensemble::member(size_t m, BodySystem& out) const {
+    out.resize(bodies);
+    for (size_t i = 0; i < bodies; ++i) {
+        const size_t k = offset(m, i);
+        out.x[i] = x[k]; out.y[i] = y[k]; out.z[i] = z[k];
+        out.vx[i] = vx[k]; out.vy[i] = vy[k]; out.vz[i] = vz[k];
+        out.ax[i] = ax[k]; out.ay[i] = ay[k]; out.az[i] = az[k];
+        out.mass[i] = mass[k];
+        out.radius[i] = radius[i];
+    }
+}
+
+void Ensemble::summarize(std::vector<MemberSummary>& out) {
+    out.assign(settings.members, MemberSummary());
+    pool->parallelFor(settings.members, [&](size_t m, size_t) {
+        BodySystem single;
+        member(m, single);
+        MemberSummary& summary = out[m];
+        summary.initialEnergy = initialEnergy[m];
+        summary.finalEnergy = Physics::totalEnergy(single, softeningLaw);
+        summary.closestApproach = std::sqrt(closest[m]);
+
+        const CentreOfMass c = centreOfMass(single);
+        double maxRadius2 = 0.0;
+        for (size_t i = 0; i < bodies; ++i) {
+            const double dx = single.x[i] - c.x, dy = single.y[i] - c.y, dz = single.z[i] - c.z;
+            maxRadius2 = std::max(maxRadius2, dx * dx + dy * dy + dz * dz);
+            // Specific energies, so the masses only appear once.
+            const double dvx = single.vx[i] - c.vx, dvy = single.vy[i] - c.vy, dvz = single.vz[i] - c.vz;
+            double energy = 0.5 * (dvx * dvx + dvy * dvy + dvz * dvz);
+            for (size_t j = 0; j < bodies; ++j) {
+                if (j == i) continue;
+                const double rx = single.x[j] - single.x[i], ry = single.y[j] - single.y[i], rz = single.z[j] - single.z[i];
+                const double r = std::sqrt(rx * rx + ry * ry + rz * rz);
+                // The potential totalEnergy() uses, so the columns agree under softening.
+                energy -= Constants::G_UNITS * static_cast<double>(single.mass[j]) * Physics::inverseDistance(r, softeningLaw);
+            }
+            if (energy > 0.0) ++summary.unbound;
+        }
+        summary.maxRadius = static_cast<float>(std::sqrt(maxRadius2));
+    });
+}
+
+bool Ensemble::writeSummary(const std::string& path, const std::vector<MemberSummary>& summaries) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open summary file for writing: " << path << std::endl;
+        return false;
+    }
+    out.precision(std::numeric_limits<double>::max_digits10);
+    out << "member,initial_energy,final_energy,relative_energy_error,closest_approach,max_radius,unbound\n";
+    for (size_t m = 0; m < summaries.size(); ++m) {
+        const MemberSummary& s = summaries[m];
+        const double error = s.initialEnergy != 0.0 ? std::fabs((s.finalEnergy - s.initialEnergy) / s.initialEnergy) : 0.0;
+        out << m << ',' << s.initialEnergy << ',' << s.finalEnergy << ',' << error << ','
+            << s.closestApproach << ',' << s.maxRadius << ',' << s.unbound << '\n';
+    }
+    return static_cast<bool>(out);
+}
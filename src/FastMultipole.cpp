@@ -0,0 +1,319 @@
+#include "FastMultipole.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    double factorial(int n) {
+        double result = 1.0;
+        for (int i = 2; i <= n; ++i) result *= i;
+        return result;
+    }
+
+    inline size_t nodeSize(const Octree::Node& node) { return node.end - node.begin; }
+}
+
+FmmSolver::FmmSolver(int order, float theta, size_t maxLeafBodies)
+    : expansionOrder(std::min(std::max(order, 1), kMaxOrder)), openingAngle(theta),
+      leafCapacity(maxLeafBodies > 0 ? maxLeafBodies : 1), isa(DirectKernels::detectIsa()) {
+    buildTables();
+}
+
+void FmmSolver::buildTables() {
+    const int p = expansionOrder;
+    termIndex.assign((p + 1) * (p + 1) * (p + 1), -1);
+    termA.clear(); termB.clear(); termC.clear(); termFactorial.clear();
+
+    // Ordered by total degree so recurrences only look at earlier terms.
+    for (int degree = 0; degree <= p; ++degree) {
+        for (int a = degree; a >= 0; --a) {
+            for (int b = degree - a; b >= 0; --b) {
+                int c = degree - a - b;
+                termIndex[(a * (p + 1) + b) * (p + 1) + c] = static_cast<int>(termA.size());
+                termA.push_back(static_cast<uint8_t>(a));
+                termB.push_back(static_cast<uint8_t>(b));
+                termC.push_back(static_cast<uint8_t>(c));
+                termFactorial.push_back(factorial(a) * factorial(b) * factorial(c));
+            }
+        }
+    }
+    termCount = termA.size();
+
+    recurrences.assign(termCount, Recurrence());
+    for (size_t t = 1; t < termCount; ++t) {
+        const int k[3] = { termA[t], termB[t], termC[t] };
+        const int n = k[0] + k[1] + k[2];
+        Recurrence& r = recurrences[t];
+        r.monomialAxis = 3;
+        for (int axis = 0; axis < 3; ++axis) {
+            int d1[3] = { k[0], k[1], k[2] };
+            int d2[3] = { k[0], k[1], k[2] };
+            d1[axis] -= 1;
+            d2[axis] -= 2;
+            r.down1[axis] = static_cast<uint16_t>(k[axis] > 0 ? index(d1[0], d1[1], d1[2]) : 0);
+            r.weight1[axis] = k[axis] > 0 ? -(2.0 * n - 1.0) / n : 0.0;
+            r.down2[axis] = static_cast<uint16_t>(k[axis] > 1 ? index(d2[0], d2[1], d2[2]) : 0);
+            r.weight2[axis] = k[axis] > 1 ? -(n - 1.0) / n : 0.0;
+            if (r.monomialAxis == 3 && k[axis] > 0) {
+                r.monomialAxis = static_cast<uint8_t>(axis);
+                r.monomialParent = r.down1[axis];
+                r.monomialScale = 1.0 / k[axis];
+            }
+        }
+    }
+
+    m2mTerms.clear(); m2lTerms.clear(); l2lTerms.clear();
+    for (size_t outer = 0; outer < termCount; ++outer) {
+        const int a = termA[outer], b = termB[outer], c = termC[outer];
+        for (size_t inner = 0; inner < termCount; ++inner) {
+            const int qa = termA[inner], qb = termB[inner], qc = termC[inner];
+
+            // M2M: M_k += M'_q * d^(k-q) / (k-q)!  for q <= k.
+            if (qa <= a && qb <= b && qc <= c) {
+                Term t;
+                t.out = static_cast<uint16_t>(outer);
+                t.in = static_cast<uint16_t>(inner);
+                t.other = static_cast<uint16_t>(index(a - qa, b - qb, c - qc));
+                t.coef = 1.0;
+                m2mTerms.push_back(t);
+            }
+
+            // M2L: L_n += (-1)^|k| (n+k)! / n! * M_k * T_(n+k)  for |n| + |k| <= p.
+            if (a + b + c + qa + qb + qc <= p) {
+                Term t;
+                t.out = static_cast<uint16_t>(outer);
+                t.in = static_cast<uint16_t>(inner);
+                t.other = static_cast<uint16_t>(index(a + qa, b + qb, c + qc));
+                t.coef = (((qa + qb + qc) & 1) ? -1.0 : 1.0) * termFactorial[t.other] / termFactorial[outer];
+                m2lTerms.push_back(t);
+            }
+
+            // L2L: L'_q += n! / q! * L_n * e^(n-q) / (n-q)!  for n >= q.
+            if (qa >= a && qb >= b && qc >= c) {
+                Term t;
+                t.out = static_cast<uint16_t>(outer);
+                t.in = static_cast<uint16_t>(inner);
+                t.other = static_cast<uint16_t>(index(qa - a, qb - b, qc - c));
+                t.coef = termFactorial[inner] / termFactorial[outer];
+                l2lTerms.push_back(t);
+            }
+        }
+    }
+}
+
+// out[k] = d^k / k! for every term k.
+void FmmSolver::monomials(double dx, double dy, double dz, double* out) const {
+    const double d[3] = { dx, dy, dz };
+    out[0] = 1.0;
+    for (size_t t = 1; t < termCount; ++t) {
+        const Recurrence& r = recurrences[t];
+        out[t] = out[r.monomialParent] * d[r.monomialAxis] * r.monomialScale;
+    }
+}
+
+// out[k] = D^k (1 / |r|) / k! at r = (dx, dy, dz), from the recurrence
+// |k| r^2 T_k + (2|k| - 1) sum_i r_i T_(k-e_i) + (|k| - 1) sum_i T_(k-2e_i) = 0.
+void FmmSolver::taylorCoefficients(double dx, double dy, double dz, double* out) const {
+    const double invR2 = 1.0 / (dx * dx + dy * dy + dz * dz);
+    out[0] = std::sqrt(invR2);
+    for (size_t t = 1; t < termCount; ++t) {
+        const Recurrence& r = recurrences[t];
+        double sum = r.weight1[0] * dx * out[r.down1[0]] + r.weight1[1] * dy * out[r.down1[1]] + r.weight1[2] * dz * out[r.down1[2]]
+                   + r.weight2[0] * out[r.down2[0]] + r.weight2[1] * out[r.down2[1]] + r.weight2[2] * out[r.down2[2]];
+        out[t] = sum * invR2;
+    }
+}
+
+void FmmSolver::computeAccelerations(BodySystem& bodies, ThreadPool& pool) {
+    const size_t n = bodies.size();
+    if (n == 0) return;
+
+    prepareTree(bodies, pool.size());
+
+    for (size_t level = levels.size(); level-- > 0;) {
+        const std::vector<uint32_t>& cells = levels[level];
+        pool.parallelFor(cells.size(), [&](size_t k, size_t) { upward(cells[k]); });
+    }
+
+    pool.parallelFor(taskCells.size(), [&](size_t k, size_t) { interact(taskCells[k], 0); });
+
+    for (size_t level = 1; level < levels.size(); ++level) {
+        const std::vector<uint32_t>& cells = levels[level];
+        pool.parallelFor(cells.size(), [&](size_t k, size_t) { localToLocal(cells[k]); });
+    }
+
+    pool.parallelFor(leaves.size(), [&](size_t k, size_t) { localToBodies(leaves[k]); });
+
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t i = tree.bodyOrder[k];
+        bodies.ax[i] = Constants::G_UNITS * sortedAccX[k];
+        bodies.ay[i] = Constants::G_UNITS * sortedAccY[k];
+        bodies.az[i] = Constants::G_UNITS * sortedAccZ[k];
+    }
+}
+
+void FmmSolver::prepareTree(const BodySystem& bodies, size_t workerCount) {
+    const size_t n = bodies.size();
+    tree.build(bodies, leafCapacity);
+    const size_t nodeCount = tree.nodes.size();
+
+    sortedX.resize(n); sortedY.resize(n); sortedZ.resize(n); sortedMass.resize(n);
+    for (size_t k = 0; k < n; ++k) {
+        uint32_t i = tree.bodyOrder[k];
+        sortedX[k] = bodies.x[i];
+        sortedY[k] = bodies.y[i];
+        sortedZ[k] = bodies.z[i];
+        sortedMass[k] = bodies.mass[i];
+    }
+    sortedAccX.assign(n, 0.0f);
+    sortedAccY.assign(n, 0.0f);
+    sortedAccZ.assign(n, 0.0f);
+
+    parent.assign(nodeCount, 0);
+    centers.resize(3 * nodeCount);
+    radii.resize(nodeCount);
+    multipoles.assign(nodeCount * termCount, 0.0);
+    locals.assign(nodeCount * termCount, 0.0);
+    levels.clear();
+    leaves.clear();
+
+    for (uint32_t i = 0; i < nodeCount; ++i) {
+        const Octree::Node& node = tree.nodes[i];
+        centers[3 * i] = node.comX;
+        centers[3 * i + 1] = node.comY;
+        centers[3 * i + 2] = node.comZ;
+        if (levels.size() <= node.depth) levels.resize(node.depth + 1);
+        levels[node.depth].push_back(i);
+        if (node.isLeaf()) {
+            leaves.push_back(i);
+        } else {
+            for (uint8_t c = 0; c < node.childCount; ++c) parent[node.firstChild + c] = i;
+        }
+    }
+
+    // Cut the tree into enough disjoint target subtrees to keep the pool busy.
+    taskCells.assign(1, 0);
+    std::vector<uint32_t> next;
+    const size_t wanted = 8 * workerCount;
+    while (taskCells.size() < wanted) {
+        next.clear();
+        bool split = false;
+        for (uint32_t cell : taskCells) {
+            const Octree::Node& node = tree.nodes[cell];
+            if (node.isLeaf()) {
+                next.push_back(cell);
+            } else {
+                for (uint8_t c = 0; c < node.childCount; ++c) next.push_back(node.firstChild + c);
+                split = true;
+            }
+        }
+        taskCells.swap(next);
+        if (!split) break;
+    }
+}
+
+void FmmSolver::upward(uint32_t nodeIndex) {
+    const Octree::Node& node = tree.nodes[nodeIndex];
+    const double cx = centers[3 * nodeIndex], cy = centers[3 * nodeIndex + 1], cz = centers[3 * nodeIndex + 2];
+    double* M = &multipoles[nodeIndex * termCount];
+    double P[kMaxTerms];
+
+    if (node.isLeaf()) {
+        double radius = 0.0;
+        for (uint32_t k = node.begin; k < node.end; ++k) {
+            double dx = sortedX[k] - cx, dy = sortedY[k] - cy, dz = sortedZ[k] - cz;
+            radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz));
+            monomials(dx, dy, dz, P);
+            const double m = sortedMass[k];
+            for (size_t t = 0; t < termCount; ++t) M[t] += m * P[t];
+        }
+        radii[nodeIndex] = radius;
+        return;
+    }
+
+    double radius = 0.0;
+    for (uint8_t c = 0; c < node.childCount; ++c) {
+        const uint32_t child = static_cast<uint32_t>(node.firstChild + c);
+        double dx = centers[3 * child] - cx, dy = centers[3 * child + 1] - cy, dz = centers[3 * child + 2] - cz;
+        radius = std::max(radius, std::sqrt(dx * dx + dy * dy + dz * dz) + radii[child]);
+        monomials(dx, dy, dz, P);
+        const double* childM = &multipoles[child * termCount];
+        for (const Term& t : m2mTerms) M[t.out] += childM[t.in] * P[t.other];
+    }
+    double gx = cx - node.centerX, gy = cy - node.centerY, gz = cz - node.centerZ;
+    double cellBound = std::sqrt(gx * gx + gy * gy + gz * gz) + node.halfSize * std::sqrt(3.0);
+    radii[nodeIndex] = std::min(radius, cellBound);
+}
+
+void FmmSolver::interact(uint32_t target, uint32_t source) {
+    const Octree::Node& A = tree.nodes[target];
+    const Octree::Node& B = tree.nodes[source];
+    const double dx = centers[3 * target] - centers[3 * source];
+    const double dy = centers[3 * target + 1] - centers[3 * source + 1];
+    const double dz = centers[3 * target + 2] - centers[3 * source + 2];
+    const double dist2 = dx * dx + dy * dy + dz * dz;
+    const double reach = radii[target] + radii[source];
+
+    if (dist2 > 0.0 && reach * reach < static_cast<double>(openingAngle) * openingAngle * dist2) {
+        multipoleToLocal(target, source);
+        return;
+    }
+
+    if ((A.isLeaf() && B.isLeaf()) || nodeSize(A) * nodeSize(B) <= leafCapacity * leafCapacity) {
+        DirectKernels::accumulateSources(isa, softening, sortedX.data(), sortedY.data(), sortedZ.data(), sortedMass.data(),
+                                         A.begin, A.end, B.begin, B.end,
+                                         sortedAccX.data(), sortedAccY.data(), sortedAccZ.data());
+        return;
+    }
+
+    if (B.isLeaf() || (!A.isLeaf() && radii[target] >= radii[source])) {
+        for (uint8_t c = 0; c < A.childCount; ++c) interact(static_cast<uint32_t>(A.firstChild + c), source);
+    } else {
+        for (uint8_t c = 0; c < B.childCount; ++c) interact(target, static_cast<uint32_t>(B.firstChild + c));
+    }
+}
+
+void FmmSolver::multipoleToLocal(uint32_t target, uint32_t source) {
+    double T[kMaxTerms];
+    taylorCoefficients(centers[3 * target] - centers[3 * source],
+                       centers[3 * target + 1] - centers[3 * source + 1],
+                       centers[3 * target + 2] - centers[3 * source + 2], T);
+    const double* M = &multipoles[source * termCount];
+    double* L = &locals[target * termCount];
+    for (const Term& t : m2lTerms) L[t.out] += t.coef * M[t.in] * T[t.other];
+}
+
+void FmmSolver::localToLocal(uint32_t child) {
+    const uint32_t from = parent[child];
+    double P[kMaxTerms];
+    monomials(centers[3 * child] - centers[3 * from],
+              centers[3 * child + 1] - centers[3 * from + 1],
+              centers[3 * child + 2] - centers[3 * from + 2], P);
+    const double* parentL = &locals[from * termCount];
+    double* L = &locals[child * termCount];
+    for (const Term& t : l2lTerms) L[t.out] += t.coef * parentL[t.in] * P[t.other];
+}
+
+void FmmSolver::localToBodies(uint32_t leaf) {
+    const Octree::Node& node = tree.nodes[leaf];
+    const double cx = centers[3 * leaf], cy = centers[3 * leaf + 1], cz = centers[3 * leaf + 2];
+    const double* L = &locals[leaf * termCount];
+    const size_t gradientTerms = termCount - (expansionOrder + 1) * (expansionOrder + 2) / 2;
+    double P[kMaxTerms];
+
+    for (uint32_t k = node.begin; k < node.end; ++k) {
+        monomials(sortedX[k] - cx, sortedY[k] - cy, sortedZ[k] - cz, P);
+        // d/dv_x sum_n L_n v^n = sum_a L_(a+e_x) (a+e_x)! * v^a / a!
+        double gx = 0.0, gy = 0.0, gz = 0.0;
+        for (size_t t = 0; t < gradientTerms; ++t) {
+            const int a = termA[t], b = termB[t], c = termC[t];
+            const int ix = index(a + 1, b, c), iy = index(a, b + 1, c), iz = index(a, b, c + 1);
+            gx += L[ix] * termFactorial[ix] * P[t];
+            gy += L[iy] * termFactorial[iy] * P[t];
+            gz += L[iz] * termFactorial[iz] * P[t];
+        }
+        sortedAccX[k] += static_cast<float>(gx);
+        sortedAccY[k] += static_cast<float>(gy);
+        sortedAccZ[k] += static_cast<float>(gz);
+    }
+}
@@ -0,0 +1,133 @@
+#include "ForceSolver.hpp"
+#include "BarnesHut.hpp"
+#include "FastMultipole.hpp"
+#include "constants.hpp"
+#include <algorithm>
+
+namespace {
+    const size_t kReduceChunk = 2048;
+    const size_t kTargetChunk = 64;
+}
+
+void DirectSumSolver::planTiles(size_t bodyCount, size_t workerCount) {
+    // Roughly two tile rows per worker gives ~2W^2 tiles to balance, while
+    // keeping a tile's column slice of the accumulators in L1/L2.
+    size_t size = (bodyCount + 2 * workerCount - 1) / (2 * workerCount);
+    size = std::min<size_t>(std::max<size_t>(size, 64), 1024);
+    size = (size + 15) & ~static_cast<size_t>(15);
+    if (size == tileSize && bodyCount == tileBodyCount) return;
+
+    tileSize = size;
+    tileBodyCount = bodyCount;
+    const uint32_t blocks = static_cast<uint32_t>((bodyCount + size - 1) / size);
+    tiles.clear();
+    for (uint32_t row = 0; row < blocks; ++row) {
+        for (uint32_t col = row; col < blocks; ++col) {
+            tiles.push_back(std::make_pair(row, col));
+        }
+    }
+}
+
+void DirectSumSolver::computeAccelerations(BodySystem& bodies, ThreadPool& pool) {
+    const size_t n = bodies.size();
+    if (n == 0) return;
+
+    planTiles(n, pool.size());
+    accumulators.resize(pool.size());
+    for (auto& acc : accumulators) {
+        acc.x.resize(n);
+        acc.y.resize(n);
+        acc.z.resize(n);
+        acc.used = false;
+    }
+
+    pool.parallelFor(tiles.size(), [&](size_t task, size_t worker) {
+        Accumulator& acc = accumulators[worker];
+        if (!acc.used) {
+            std::fill(acc.x.begin(), acc.x.end(), 0.0f);
+            std::fill(acc.y.begin(), acc.y.end(), 0.0f);
+            std::fill(acc.z.begin(), acc.z.end(), 0.0f);
+            acc.used = true;
+        }
+        size_t iBegin = tiles[task].first * tileSize;
+        size_t jBegin = tiles[task].second * tileSize;
+        DirectKernels::accumulateTile(isa, softening, bodies,
+                                      iBegin, std::min(iBegin + tileSize, n),
+                                      jBegin, std::min(jBegin + tileSize, n),
+                                      acc.x.data(), acc.y.data(), acc.z.data());
+    });
+
+    std::vector<const Accumulator*> used;
+    for (const auto& acc : accumulators) {
+        if (acc.used) used.push_back(&acc);
+    }
+
+    pool.parallelFor((n + kReduceChunk - 1) / kReduceChunk, [&](size_t chunk, size_t) {
+        size_t end = std::min(n, (chunk + 1) * kReduceChunk);
+        for (size_t i = chunk * kReduceChunk; i < end; ++i) {
+            float sumX = 0.0f, sumY = 0.0f, sumZ = 0.0f;
+            for (const Accumulator* acc : used) {
+                sumX += acc->x[i];
+                sumY += acc->y[i];
+                sumZ += acc->z[i];
+            }
+            bodies.ax[i] = Constants::G_UNITS * sumX;
+            bodies.ay[i] = Constants::G_UNITS * sumY;
+            bodies.az[i] = Constants::G_UNITS * sumZ;
+        }
+    });
+}
+
+void DirectSumSolver::computeAccelerationsFor(BodySystem& bodies, ThreadPool& pool, const std::vector<uint32_t>& targets) {
+    const size_t n = bodies.size();
+    // Past half the bodies the symmetric tiles do less work than one-sided rows.
+    if (2 * targets.size() > n) {
+        computeAccelerations(bodies, pool);
+        return;
+    }
+
+    pool.parallelFor((targets.size() + kTargetChunk - 1) / kTargetChunk, [&](size_t chunk, size_t) {
+        size_t end = std::min(targets.size(), (chunk + 1) * kTargetChunk);
+        for (size_t t = chunk * kTargetChunk; t < end; ++t) {
+            uint32_t i = targets[t];
+            bodies.ax[i] = bodies.ay[i] = bodies.az[i] = 0.0f;
+            DirectKernels::accumulateSources(isa, softening, bodies.x.data(), bodies.y.data(), bodies.z.data(), bodies.mass.data(),
+                                             i, i + 1, 0, n, bodies.ax.data(), bodies.ay.data(), bodies.az.data());
+            bodies.ax[i] *= Constants::G_UNITS;
+            bodies.ay[i] *= Constants::G_UNITS;
+            bodies.az[i] *= Constants::G_UNITS;
+        }
+    });
+}
+
+bool solverSoftening(const SolverConfig& config, DirectKernels::Softening& softening) {
+    if (!DirectKernels::parseSoftening(config.softening, softening.law)) return false;
+    if (softening.law == DirectKernels::SofteningLaw::None) {
+        softening.length = 0.0f;
+        return true;
+    }
+    softening.length = config.softeningLength;
+    return softening.length > 0.0f;
+}
+
+std::unique_ptr<ForceSolver> createForceSolver(const SolverConfig& config) {
+    DirectKernels::Softening softening;
+    if (!solverSoftening(config, softening)) return nullptr;
+
+    if (config.name == "direct") {
+        DirectKernels::Isa isa;
+        if (!DirectKernels::parseIsa(config.kernel, isa)) return nullptr;
+        return std::unique_ptr<ForceSolver>(new DirectSumSolver(isa, softening));
+    }
+    if (config.name == "barnes-hut") {
+        BarnesHutSolver* solver = new BarnesHutSolver(config.theta);
+        solver->softening = softening;
+        return std::unique_ptr<ForceSolver>(solver);
+    }
+    if (config.name == "fmm") {
+        FmmSolver* solver = new FmmSolver(config.fmmOrder, config.theta);
+        solver->softening = softening;
+        return std::unique_ptr<ForceSolver>(solver);
+    }
+    return nullptr;
+}
@@ -1,15 +1,17 @@
 #include "GravitySimulation.hpp" 
 #include "constants.hpp"         
+#include "Profiler.hpp"
 
 #include <glm/gtc/matrix_transform.hpp> 
 #include <glm/gtc/type_ptr.hpp>      
 #include <iostream>                    
 #include <cmath>                        
 #include <algorithm>                   
+#include <cstdio>
 
-GravitySimulation::GravitySimulation(int width, int height, const char* title)
+GravitySimulation::GravitySimulation(int width, int height, const char* title, const std::string& replayPath)
     : camera(glm::vec3(0.0f, 1000.0f, 5000.0f)), 
-      grid(20000.0f, 25)
+      grid(20000.0f, 64, Grid::WarpMode::Gpu, 4)
 {
     if (!initGLFW(width, height, title)) {
         running = false; 
@@ -23,6 +25,8 @@ GravitySimulation::GravitySimulation(int width, int height, const char* title)
     initOpenGLOptions();
     
     grid.setupOpenGLResources(); 
+    bodyRenderer.setupOpenGLResources();
+    renderQueue.setupOpenGLResources();
 
     setupCallbacks();
 
@@ -30,8 +34,10 @@ GravitySimulation::GravitySimulation(int width, int height, const char* title)
         #version 330 core
         layout(location=0) in vec3 aPos;
         uniform mat4 model;
-        uniform mat4 view;
-        uniform mat4 projection;
+        layout(std140) uniform Frame {
+            mat4 view;
+            mat4 projection;
+        };
         out float lightIntensity;
         void main() {
             gl_Position = projection * view * model * vec4(aPos, 1.0);
@@ -64,18 +70,26 @@ GravitySimulation::GravitySimulation(int width, int height, const char* title)
     )glsl";
     mainShader = new Shader(vertexShaderSource, fragmentShaderSource);
 
-    objects.emplace_back(Object(glm::vec3(-5000, 650, -350), glm::vec3(0, 0, -500), 5.97219e22f, 5515, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f)));
-    objects.emplace_back(Object(glm::vec3(5000, 650, -350), glm::vec3(0, 0, 500), 5.97219e22f, 5515, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f)));
-    objects.emplace_back(Object(glm::vec3(0, 0, -350), glm::vec3(0, 0, 0), 1.989e25f, 5515, glm::vec4(1.0f, 0.929f, 0.176f, 1.0f), true)); 
-    
-    for(auto& obj : objects) { 
-        obj.Initializing = false;
-        obj.Launched = true;
+    if (!replayPath.empty()) {
+        if (!replay.open(replayPath)) {
+            running = false;
+            return;
+        }
+        replaying = true;
+        std::cout << "Replaying " << replay.frameCount() << " frames, " << replay.stepStride()
+                  << " steps apart" << std::endl;
+        return;
     }
+
+    launch(objects.insert(glm::vec3(-5000, 650, -350), glm::vec3(0, 0, -500), 5.97219e22f, 5515, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f)));
+    launch(objects.insert(glm::vec3(5000, 650, -350), glm::vec3(0, 0, 500), 5.97219e22f, 5515, glm::vec4(0.0f, 1.0f, 1.0f, 1.0f)));
+    launch(objects.insert(glm::vec3(0, 0, -350), glm::vec3(0, 0, 0), 1.989e25f, 5515, glm::vec4(1.0f, 0.929f, 0.176f, 1.0f), true));
     firstMouse = true; 
+    physics.start();
 }
 
 GravitySimulation::~GravitySimulation() {
+    physics.stop();
     delete mainShader; 
 
     if (window) { 
@@ -95,6 +109,7 @@ bool GravitySimulation::initGLFW(int width, int height, const char* title) {
     glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
     #endif
 
+    windowTitle = title;
     window = glfwCreateWindow(width, height, title, NULL, NULL);
     if (!window) {
         std::cerr << "Failed to create GLFW window" << std::endl;
@@ -148,13 +163,22 @@ void GravitySimulation::setupCallbacks() {
 void GravitySimulation::run() {
     glm::mat4 projection;
 
+    PROFILE_THREAD("main");
     while (running && !glfwWindowShouldClose(window)) {
+        PROFILE_ZONE("frame");
         float currentFrame = static_cast<float>(glfwGetTime());
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput();
-        update(); 
+        {
+            PROFILE_ZONE("input");
+            processInput();
+        }
+        {
+            PROFILE_ZONE("update");
+            if (replaying) updateReplay();
+            else update();
+        }
 
         int fbWidth, fbHeight;
         glfwGetFramebufferSize(window, &fbWidth, &fbHeight);
@@ -164,12 +188,38 @@ void GravitySimulation::run() {
              projection = glm::perspective(glm::radians(camera.Zoom), 1.0f, 0.1f, 750000.0f);
         }
 
-        render(projection);
+        render(projection, fbHeight);
 
         glfwPollEvents();
+#ifdef GRAVITY_PROFILE
+        showFrameStats();
+#endif
     }
 }
 
+void GravitySimulation::showFrameStats() {
+    double now = glfwGetTime();
+    if (now - statsShownAt < 0.5) return;
+    statsShownAt = now;
+
+    // p50/p99 over the last 256 occurrences of each stage, in ms.
+    const char* stages[] = { "frame", "update", "grid.warp", "render", "swap", "physics.step" };
+    std::string title = windowTitle;
+    char text[96];
+    for (const char* stage : stages) {
+        ProfileStats stats = Profiler::stats(stage);
+        if (stats.count == 0) continue;
+        std::snprintf(text, sizeof(text), " | %s %.2f/%.2f", stage, stats.p50, stats.p99);
+        title += text;
+    }
+    ProfileStats step = Profiler::stats("physics.step");
+    if (!replaying && step.count > 0 && step.mean > 0.0) {
+        std::snprintf(text, sizeof(text), " | %.3g bodies/s", static_cast<double>(objects.size()) * 1e3 / step.mean);
+        title += text;
+    }
+    glfwSetWindowTitle(window, title.c_str());
+}
+
 void GravitySimulation::processInput() {
 
     if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS || glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS) {
@@ -183,12 +233,13 @@ void GravitySimulation::processInput() {
     if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) camera.ProcessKeyboard(GLFW_KEY_D, deltaTime);
     if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS) camera.ProcessKeyboard(GLFW_KEY_SPACE, deltaTime);
     
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS && !isCreatingObject) {
+    Object* created = objects.get(creating);
+    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS && !created) {
         camera.ProcessKeyboard(GLFW_KEY_LEFT_SHIFT, deltaTime);
     }
 
-    if (isCreatingObject && !objects.empty()) {
-        Object& newObj = objects.back();
+    if (created) {
+        Object& newObj = *created;
         bool shiftIsForVertical = (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS || 
                                    glfwGetKey(window, GLFW_KEY_RIGHT_SHIFT) == GLFW_PRESS);
 
@@ -210,84 +261,291 @@ void GravitySimulation::processInput() {
 }
 
 void GravitySimulation::update() {
-    if (isCreatingObject && !objects.empty()) {
-
+    if (Object* newObj = objects.get(creating)) {
         if (glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_RIGHT) == GLFW_PRESS) {
-            Object& newObj = objects.back();
-            newObj.mass *= (1.0f + 1.0f * deltaTime); 
-            newObj.updateRadius();           
-            newObj.generateSphereVertices(); 
+            newObj->mass *= (1.0f + 1.0f * deltaTime);
+            newObj->updateRadius();
         }
     }
 
-    if (!paused) {
-        for (size_t i = 0; i < objects.size(); ++i) {
-            if (objects[i].Initializing || !objects[i].Launched) continue; 
-
-            for (size_t j = 0; j < objects.size(); ++j) {
-                if (i == j || objects[j].Initializing || !objects[j].Launched) continue;
+    retryUnsent();
+    applySnapshot();
+    // Frame boundary: slots destroyed during the last frame become reusable.
+    objects.compact();
+    grid.updateAndWarp(objects); 
+}
 
-                glm::vec3 diff = objects[j].position - objects[i].position;
-                float distance_visual = glm::length(diff);
+bool GravitySimulation::send(const PhysicsCommand& command) {
+    if (!physics.send(command)) return false;
+    ++commandsSent;
+    return true;
+}
 
-                if (distance_visual > 0.001f) { 
-                    glm::vec3 direction = glm::normalize(diff);
- 
-                    float dist_m = distance_visual * 1000.0f; 
-                    
-                    double G_force_mag = (Constants::G * static_cast<double>(objects[i].mass) * static_cast<double>(objects[j].mass)) / 
-                                         (static_cast<double>(dist_m) * dist_m);
+void GravitySimulation::launch(SlotHandle handle) {
+    Object& obj = *objects.get(handle);
+
+    PhysicsCommand command;
+    command.type = PhysicsCommand::Type::AddBody;
+    command.id = handle;
+    command.x = obj.position.x;
+    command.y = obj.position.y;
+    command.z = obj.position.z;
+    command.vx = obj.velocity.x;
+    command.vy = obj.velocity.y;
+    command.vz = obj.velocity.z;
+    command.mass = obj.mass;
+    command.radius = obj.radius;
+    // Only a body the physics will see may be dropped for missing from a snapshot.
+    if (!send(command)) {
+        if (std::find(unsentLaunches.begin(), unsentLaunches.end(), handle) == unsentLaunches.end()) {
+            unsentLaunches.push_back(handle);
+        }
+        return;
+    }
+    obj.Launched = true;
+    obj.launchSerial = commandsSent;
+}
 
-                    float acc_mag = static_cast<float>(G_force_mag / static_cast<double>(objects[i].mass));
-                    glm::vec3 acceleration = direction * acc_mag;
-                    objects[i].accelerate(acceleration); 
-                }
-                
-                
-                float collisionFactor = objects[i].checkCollision(objects[j]);
-                if (collisionFactor < 1.0f) { 
-                    objects[i].velocity *= collisionFactor; 
+void GravitySimulation::retryUnsent() {
+    std::vector<SlotHandle> launches;
+    launches.swap(unsentLaunches);
+    for (SlotHandle handle : launches) {
+        if (objects.contains(handle)) launch(handle);
+    }
+    // A body merged away meanwhile is already gone from both sides.
+    std::vector<SlotHandle> removals;
+    removals.swap(unsentRemovals);
+    for (SlotHandle handle : removals) destroy(handle);
+}
 
-                }
+void GravitySimulation::destroy(SlotHandle handle) {
+    const Object* obj = objects.get(handle);
+    if (!obj) return;
+    if (obj->Launched) {
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::RemoveBody;
+        command.id = handle;
+        // Erasing a body the physics still simulates would leave it pulling
+        // on everything with nothing to draw or remove it by.
+        if (!send(command)) {
+            if (std::find(unsentRemovals.begin(), unsentRemovals.end(), handle) == unsentRemovals.end()) {
+                unsentRemovals.push_back(handle);
             }
+            return;
         }
+    }
+    objects.erase(handle);
+}
+
+Object* GravitySimulation::objectOf(const BodySnapshot& snapshot, size_t k) {
+    const SlotHandle id = snapshot.ids[k];
+    if ((id.index & PhysicsThread::kSpawnedBit) == 0) return objects.get(id);
+    auto found = fragments.find(id.index);
+    if (found != fragments.end()) return objects.get(found->second);
+    SlotHandle handle = objects.insert(glm::vec3(snapshot.x[k], snapshot.y[k], snapshot.z[k]), glm::vec3(0.0f),
+                                       snapshot.mass[k], Constants::DEFAULT_DENSITY, glm::vec4(0.6f, 0.6f, 0.6f, 1.0f));
+    fragments[id.index] = handle;
+    Object* obj = objects.get(handle);
+    obj->Launched = true;
+    return obj;
+}
 
-        for (auto& obj : objects) {
-            if (!obj.Initializing && obj.Launched) {
-                obj.updatePhysics(); 
+void GravitySimulation::applySnapshot() {
+    if (physics.snapshotPending()) {
+        previousSnapshot = physics.snapshot();
+        physics.acquireSnapshot();
+        ++snapshotsTaken;
+
+        // Bodies merged or shattered by the physics are gone from the new
+        // snapshot; drop their objects, except those launched too recently
+        // to be in it yet.
+        const BodySnapshot& taken = physics.snapshot();
+        for (size_t k = 0; k < taken.ids.size(); ++k) {
+            if (Object* obj = objectOf(taken, k)) obj->seenInSnapshot = snapshotsTaken;
+        }
+        std::vector<SlotHandle> gone;
+        for (auto it = objects.begin(); it != objects.end(); ++it) {
+            const Object& obj = *it;
+            if (obj.Launched && obj.seenInSnapshot != snapshotsTaken && obj.launchSerial <= taken.commandsApplied) {
+                gone.push_back(it.handle());
+            }
+        }
+        for (SlotHandle handle : gone) objects.erase(handle);
+        if (!gone.empty()) {
+            for (auto it = fragments.begin(); it != fragments.end();) {
+                it = objects.contains(it->second) ? std::next(it) : fragments.erase(it);
             }
         }
     }
-    grid.updateAndWarp(objects); 
+
+    // Draw between the last two ticks so motion stays smooth when the frame
+    // rate and the tick rate differ.
+    const BodySnapshot& current = physics.snapshot();
+    float alpha = 1.0f;
+    if (!current.paused && previousSnapshot.stepCount < current.stepCount) {
+        double since = PhysicsThread::clockSeconds() - current.publishedAt;
+        alpha = static_cast<float>(std::min(1.0, std::max(0.0, since / physics.tickInterval())));
+    }
+
+    for (size_t k = 0; k < current.ids.size(); ++k) {
+        Object* obj = objectOf(current, k);
+        if (!obj) continue;
+        glm::vec3 position(current.x[k], current.y[k], current.z[k]);
+        if (alpha < 1.0f && k < previousSnapshot.ids.size() && previousSnapshot.ids[k] == current.ids[k]) {
+            glm::vec3 before(previousSnapshot.x[k], previousSnapshot.y[k], previousSnapshot.z[k]);
+            position = before + (position - before) * alpha;
+        }
+        obj->position = position;
+        obj->mass = current.mass[k];
+        obj->radius = current.radius[k];
+    }
 }
 
-void GravitySimulation::render(const glm::mat4& projection) {
+void GravitySimulation::updateReplay() {
+    const float lastFrame = static_cast<float>(replay.frameCount() - 1);
+    // Frames per second of wall time that match the viewer's tick rate.
+    const float framesPerSecond = 1.0f / (Constants::TIME_STEP * static_cast<float>(std::max<uint32_t>(replay.stepStride(), 1)));
+    const float scrubRate = 10.0f;
+
+    if (!replayPaused) replayFrame += deltaTime * replaySpeed * framesPerSecond;
+    if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) replayFrame -= deltaTime * scrubRate * replaySpeed * framesPerSecond;
+    if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) replayFrame += deltaTime * scrubRate * replaySpeed * framesPerSecond;
+    replayFrame = std::min(std::max(replayFrame, 0.0f), lastFrame);
+
+    size_t before = static_cast<size_t>(replayFrame);
+    size_t after = std::min(before + 1, replay.frameCount() - 1);
+    float alpha = replayFrame - static_cast<float>(before);
+    if (replay.bodyCount(after) != replay.bodyCount(before)) after = before;
+
+    replay.positions(before, replayX, replayY, replayZ);
+    replay.positions(after, replayNextX, replayNextY, replayNextZ);
+    const float* mass = replay.mass(before);
+    const float* radius = replay.radius(before);
+    const size_t n = replay.bodyCount(before);
+
+    if (replayBodies.size() != n) {
+        objects.clear();
+        objects.reserve(n);
+        replayBodies.clear();
+        float heaviest = 0.0f;
+        for (size_t i = 0; i < n; ++i) heaviest = std::max(heaviest, mass[i]);
+        for (size_t i = 0; i < n; ++i) {
+            // Stars (the heaviest bodies) glow, the rest draw like planets.
+            bool star = mass[i] >= 0.1f * heaviest;
+            glm::vec4 color = star ? glm::vec4(1.0f, 0.929f, 0.176f, 1.0f) : glm::vec4(0.0f, 1.0f, 1.0f, 1.0f);
+            replayBodies.push_back(objects.insert(glm::vec3(0.0f), glm::vec3(0.0f), mass[i], Constants::DEFAULT_DENSITY, color, star));
+            objects.get(replayBodies.back())->Launched = true;
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        Object& obj = *objects.get(replayBodies[i]);
+        glm::vec3 from(replayX[i], replayY[i], replayZ[i]);
+        glm::vec3 to(replayNextX[i], replayNextY[i], replayNextZ[i]);
+        obj.position = from + (to - from) * alpha;
+        obj.mass = mass[i];
+        obj.radius = radius[i];
+    }
+
+    grid.updateAndWarp(objects);
+}
+
+void GravitySimulation::render(const glm::mat4& projection, int viewportHeight) {
     glClearColor(0.0f, 0.0f, 0.0f, 1.0f); 
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
     if (!mainShader) return; 
 
-    mainShader->use();
-    mainShader->setMat4("projection", projection);
-    mainShader->setMat4("view", camera.GetViewMatrix());
-
-    grid.draw(*mainShader);
-
-    for (auto& obj : objects) {
-
-        obj.draw(*mainShader);
+    {
+        PROFILE_ZONE("render");
+        glm::mat4 view = camera.GetViewMatrix();
+        renderQueue.setFrame(view, projection);
+        grid.submit(renderQueue, *mainShader);
+        bodyRenderer.submit(renderQueue, objects, view, projection, viewportHeight);
+        renderQueue.flush();
     }
 
+    PROFILE_ZONE("swap");
     glfwSwapBuffers(window);
 }
 
 
 void GravitySimulation::keyCallback(int key, int scancode, int action, int mods) {
+#ifdef GRAVITY_PROFILE
+    if (key == GLFW_KEY_T && action == GLFW_PRESS && Profiler::writeChromeTrace("gravity_trace.json")) {
+        std::cout << "Trace written to gravity_trace.json" << std::endl;
+    }
+#endif
+
+    if (replaying) {
+        if (key == GLFW_KEY_P && action == GLFW_PRESS) replayPaused = !replayPaused;
+        if (key == GLFW_KEY_UP && action == GLFW_PRESS) replaySpeed *= 2.0f;
+        if (key == GLFW_KEY_DOWN && action == GLFW_PRESS) replaySpeed *= 0.5f;
+        if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+            bool toGpu = grid.warpMode == Grid::WarpMode::Cpu;
+            grid.setWarpMode(toGpu ? Grid::WarpMode::Gpu : Grid::WarpMode::Cpu);
+        }
+        if (action == GLFW_PRESS) {
+            size_t frame = static_cast<size_t>(replayFrame);
+            std::cout << "Replay step " << replay.step(frame) << " (t = " << replay.time(frame) << "), speed x"
+                      << replaySpeed << (replayPaused ? ", paused" : "") << std::endl;
+        }
+        return;
+    }
 
     if (key == GLFW_KEY_P && action == GLFW_PRESS) {
         paused = !paused;
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::SetPaused;
+        command.paused = paused;
+        send(command);
         std::cout << "Simulation " << (paused ? "PAUSED" : "RESUMED") << std::endl;
     }
+
+    if (key == GLFW_KEY_BACKSPACE && action == GLFW_PRESS && objects.contains(creating)) {
+        destroy(creating);
+        creating = SlotHandle();
+        std::cout << "Object creation cancelled" << std::endl;
+    }
+
+    if (key == GLFW_KEY_B && action == GLFW_PRESS) {
+        if (solverConfig.name == "direct") solverConfig.name = "barnes-hut";
+        else if (solverConfig.name == "barnes-hut") solverConfig.name = "fmm";
+        else solverConfig.name = "direct";
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::SetSolver;
+        command.solver = solverConfig;
+        send(command);
+        std::cout << "Force solver: " << solverConfig.name << std::endl;
+    }
+
+    if (key == GLFW_KEY_C && action == GLFW_PRESS) {
+        if (collisionConfig.response == "bounce") collisionConfig.response = "merge";
+        else if (collisionConfig.response == "merge") collisionConfig.response = "fragment";
+        else collisionConfig.response = "bounce";
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::SetCollisions;
+        command.collisions = collisionConfig;
+        send(command);
+        std::cout << "Collisions: " << collisionConfig.response << std::endl;
+    }
+
+    if (key == GLFW_KEY_G && action == GLFW_PRESS) {
+        bool toGpu = grid.warpMode == Grid::WarpMode::Cpu;
+        grid.setWarpMode(toGpu ? Grid::WarpMode::Gpu : Grid::WarpMode::Cpu);
+        std::cout << "Grid warp: " << (toGpu ? "GPU" : "CPU") << std::endl;
+    }
+
+    if (key == GLFW_KEY_I && action == GLFW_PRESS) {
+        if (integratorConfig.name == "euler") integratorConfig.name = "leapfrog";
+        else if (integratorConfig.name == "leapfrog") integratorConfig.name = "verlet";
+        else if (integratorConfig.name == "verlet") integratorConfig.name = "yoshida4";
+        else integratorConfig.name = "euler";
+        PhysicsCommand command;
+        command.type = PhysicsCommand::Type::SetIntegrator;
+        command.integrator = integratorConfig;
+        send(command);
+        std::cout << "Integrator: " << integratorConfig.name << std::endl;
+    }
 }
 
 void GravitySimulation::mouseCallback(double xpos, double ypos) {
@@ -306,21 +564,22 @@ void GravitySimulation::mouseCallback(double xpos, double ypos) {
 }
 
 void GravitySimulation::mouseButtonCallback(int button, int action, int mods) {
-    if (button == GLFW_MOUSE_BUTTON_LEFT) {
-        if (action == GLFW_PRESS && !isCreatingObject) {
+    if (button == GLFW_MOUSE_BUTTON_LEFT && !replaying) {
+        if (action == GLFW_PRESS && !objects.contains(creating)) {
             glm::vec3 startPos = camera.Position + camera.Front * 500.0f; 
-            objects.emplace_back(Object(startPos, glm::vec3(0.0f), Constants::DEFAULT_INIT_MASS));
-            objects.back().Initializing = true;
-            objects.back().Launched = false; 
-            isCreatingObject = true;
-            std::cout << "Started creating object. Initial Mass: " << objects.back().mass 
-                      << ", Visual Radius: " << objects.back().radius << std::endl;
-        } else if (action == GLFW_RELEASE && isCreatingObject && !objects.empty()) {
-            objects.back().Initializing = false;
-            objects.back().Launched = true; 
-            isCreatingObject = false;
-            std::cout << "Launched object. Final Mass: " << objects.back().mass 
-                      << ", Visual Radius: " << objects.back().radius << std::endl;
+            creating = objects.insert(startPos, glm::vec3(0.0f), Constants::DEFAULT_INIT_MASS);
+            Object& newObj = *objects.get(creating);
+            newObj.Initializing = true;
+            newObj.Launched = false;
+            std::cout << "Started creating object. Initial Mass: " << newObj.mass 
+                      << ", Visual Radius: " << newObj.radius << std::endl;
+        } else if (action == GLFW_RELEASE && objects.contains(creating)) {
+            Object& newObj = *objects.get(creating);
+            newObj.Initializing = false;
+            launch(creating);
+            creating = SlotHandle();
+            std::cout << "Launched object. Final Mass: " << newObj.mass 
+                      << ", Visual Radius: " << newObj.radius << std::endl;
         }
     }
 }
@@ -1,57 +1,138 @@
 #include "Grid.hpp"      
 #include "utils.hpp"     
+#include "Profiler.hpp"
 #include <cmath>         
 #include <algorithm>  
 
-Grid::Grid(float size, int divs) : gridSize(size), divisions(divs) {
-    float step = gridSize / divisions;
+namespace {
+    const char* kWarpVertexShader = R"glsl(
+        #version 330 core
+        layout(location=0) in vec3 aPos;
+        layout(std140) uniform Frame {
+            mat4 view;
+            mat4 projection;
+        };
+        uniform samplerBuffer bodies; // x, z, rs (m), strength
+        uniform int bodyCount;
+        uniform float planeY;
+        void main() {
+            float displacement = 0.0;
+            for (int i = 0; i < bodyCount; ++i) {
+                vec4 body = texelFetch(bodies, i);
+                float distanceXZ = max(length(body.xy - aPos.xz), 1.0) * 1000.0;
+                if (distanceXZ > body.z) {
+                    displacement -= body.w / distanceXZ;
+                }
+            }
+            gl_Position = projection * view * vec4(aPos.x, planeY + displacement, aPos.z, 1.0);
+        }
+    )glsl";
+
+    const char* kWarpFragmentShader = R"glsl(
+        #version 330 core
+        out vec4 FragColor;
+        uniform vec4 objectColor;
+        void main() {
+            FragColor = objectColor;
+        }
+    )glsl";
+
+    const glm::vec4 kGridColor(1.0f, 1.0f, 1.0f, 0.25f);
+}
+
+Grid::Grid(float size, int divs, WarpMode mode, int refine)
+    : gridSize(size), divisions(divs), refineLevels(refine), warpMode(mode) {
     float halfSize = gridSize / 2.0f;
-    initialYPlane = -halfSize * 0.3f + 3 * step;
+    // Height of the legacy 25-division grid, whatever the density.
+    initialYPlane = -halfSize * 0.3f + 3 * (gridSize / 25.0f);
 
-    generateInitialVertices();
+    generateInitialVertices(std::vector<GridAnchor>());
 
 }
 
 Grid::~Grid() {
     if (VAO != 0) glDeleteVertexArrays(1, &VAO);
     if (VBO != 0) glDeleteBuffers(1, &VBO);
+    if (EBO != 0) glDeleteBuffers(1, &EBO);
+    if (bodyTexture != 0) glDeleteTextures(1, &bodyTexture);
+    if (bodyBuffer != 0) glDeleteBuffers(1, &bodyBuffer);
+    delete warpShader;
 }
 
-void Grid::generateInitialVertices() {
-    vertices.clear();
-    float step = gridSize / divisions;
-    float halfSize = gridSize / 2.0f;
+void Grid::generateInitialVertices(const std::vector<GridAnchor>& anchors) {
+    mesh.build(gridSize, divisions, refineLevels, kRefineReach, anchors);
+    builtAnchors = anchors;
 
-    // x-axis lines
-    for (int zStep = 0; zStep <= divisions; ++zStep) {
-        float z = -halfSize + zStep * step;
-        for (int xStep = 0; xStep < divisions; ++xStep) {
-            float xStart = -halfSize + xStep * step;
-            float xEnd = xStart + step;
-            vertices.insert(vertices.end(), { xStart, initialYPlane, z });
-            vertices.insert(vertices.end(), { xEnd,   initialYPlane, z });
-        }
-    }
-    // z-axis lines
-    for (int xStep = 0; xStep <= divisions; ++xStep) {
-        float x = -halfSize + xStep * step;
-        for (int zStep = 0; zStep < divisions; ++zStep) {
-            float zStart = -halfSize + zStep * step;
-            float zEnd = zStart + step;
-            vertices.insert(vertices.end(), { x, initialYPlane, zStart });
-            vertices.insert(vertices.end(), { x, initialYPlane, zEnd });
-        }
+    vertices.resize(mesh.vertexCount() * 3);
+    for (size_t v = 0; v < mesh.vertexCount(); ++v) {
+        vertices[3 * v] = mesh.x[v];
+        vertices[3 * v + 1] = initialYPlane;
+        vertices[3 * v + 2] = mesh.z[v];
     }
     vertexCount = vertices.size(); 
+    indexCount = mesh.lines.size();
+}
+
+bool Grid::anchorsMoved(const std::vector<GridAnchor>& anchors) const {
+    if (refineLevels == 0) return false;
+    if (anchors.size() != builtAnchors.size()) return true;
+    const float tolerance = 0.25f * gridSize / divisions;
+    for (size_t a = 0; a < anchors.size(); ++a) {
+        if (std::abs(anchors[a].x - builtAnchors[a].x) > tolerance ||
+            std::abs(anchors[a].z - builtAnchors[a].z) > tolerance) return true;
+    }
+    return false;
+}
+
+void Grid::uploadMesh() {
+    glBindVertexArray(VAO);
+    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(),
+                 warpMode == WarpMode::Cpu ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.lines.size() * sizeof(uint32_t), mesh.lines.data(), GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
 void Grid::setupOpenGLResources() {
     if (!vertices.empty() && VAO == 0) { 
-        Utils::createVBOVAO(VAO, VBO, vertices.data(), vertexCount, GL_DYNAMIC_DRAW);
+        Utils::createVBOVAO(VAO, VBO, vertices.data(), vertexCount,
+                            warpMode == WarpMode::Cpu ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+        glGenBuffers(1, &EBO);
+        uploadMesh();
+    }
+    if (!warpShader) {
+        warpShader = new Shader(kWarpVertexShader, kWarpFragmentShader);
+        warpColorLocation = warpShader->uniformLocation("objectColor");
+        warpBodyCountLocation = warpShader->uniformLocation("bodyCount");
+        warpPlaneYLocation = warpShader->uniformLocation("planeY");
+        warpShader->use();
+        warpShader->setInt("bodies", 0);
+        glGenBuffers(1, &bodyBuffer);
+        glGenTextures(1, &bodyTexture);
+        bodyTexels.assign(4, 0.0f);
+        uploadBodies();
     }
 }
 
-void Grid::updateAndWarp(const std::vector<Object>& objects) {
+void Grid::setWarpMode(WarpMode mode) {
+    warpMode = mode;
+}
+
+void Grid::uploadBodies() {
+    glBindBuffer(GL_TEXTURE_BUFFER, bodyBuffer);
+    // Orphan the old storage so the driver need not wait on the last draw.
+    glBufferData(GL_TEXTURE_BUFFER, std::max<size_t>(bodyTexels.size(), 4) * sizeof(float), nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_TEXTURE_BUFFER, 0, bodyTexels.size() * sizeof(float), bodyTexels.data());
+    glBindTexture(GL_TEXTURE_BUFFER, bodyTexture);
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, bodyBuffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
+
+void Grid::updateAndWarp(const SlotMap<Object>& objects) {
+    PROFILE_ZONE("grid.warp");
     if (vertices.empty() || VAO == 0) return;
 
     float totalMass = 0.0f;
@@ -65,31 +146,44 @@ void Grid::updateAndWarp(const std::vector<Object>& objects) {
     else comY = initialYPlane; 
 
     float verticalShiftFactor = comY - initialYPlane;
+    planeY = initialYPlane - std::abs(verticalShiftFactor * 0.1f);
 
-    for (size_t i = 0; i < vertices.size(); i += 3) { 
-
-        glm::vec3 vertexBasePos(vertices[i], initialYPlane, vertices[i + 2]); 
-        float totalDisplacementY = 0.0f;
-
-        for (const auto& obj : objects) {
-            if (obj.mass <= 0 || obj.radius <=0) continue; 
-
-            glm::vec3 toObject = obj.position - vertexBasePos;
-            glm::vec3 toObjectXZ = glm::vec3(toObject.x, 0.0f, toObject.z);
-            float distanceXZ = glm::length(toObjectXZ);
-            if (distanceXZ < 1.0f) distanceXZ = 1.0f; 
-
-            float distanceXZ_m = distanceXZ * 1000.0f; 
-            float rs = (2.0f * static_cast<float>(Constants::G) * obj.mass) / (Constants::C * Constants::C); 
-
-            if (distanceXZ_m > rs) { 
-                float warpFactor = (obj.mass / Constants::DEFAULT_INIT_MASS) * obj.radius * 100000.0f;
+    // Per-body terms shared by both modes: the displacement of a vertex at
+    // horizontal distance d (m) is -strength / d, skipped inside rs.
+    bodyTexels.clear();
+    sources.clear();
+    float strongest = 0.0f;
+    for (const auto& obj : objects) {
+        if (obj.mass <= 0 || obj.radius <=0) continue; 
+        float rs = Constants::SCHWARZSCHILD_PER_KG * obj.mass;
+        float warpFactor = (obj.mass / Constants::DEFAULT_INIT_MASS) * obj.radius * 100000.0f;
+        WarpSource source = { obj.position.x, obj.position.z, rs, warpFactor * rs };
+        sources.push_back(source);
+        bodyTexels.insert(bodyTexels.end(), { source.x, source.z, source.rs, source.strength });
+        strongest = std::max(strongest, source.strength);
+    }
 
-                totalDisplacementY -= warpFactor * (rs / distanceXZ_m);
-            } 
+    if (refineLevels > 0) {
+        std::vector<GridAnchor> anchors;
+        for (const WarpSource& source : sources) {
+            if (source.strength >= kAnchorFraction * strongest) anchors.push_back(GridAnchor{ source.x, source.z });
+        }
+        if (anchorsMoved(anchors)) {
+            generateInitialVertices(anchors);
+            uploadMesh();
         }
+    }
+
+    if (warpMode == WarpMode::Gpu) {
+        uploadBodies();
+        return;
+    }
 
-        vertices[i + 1] = initialYPlane + totalDisplacementY - std::abs(verticalShiftFactor * 0.1f);
+    displacement.resize(mesh.vertexCount());
+    warper.setSources(sources);
+    warper.evaluate(mesh.x.data(), mesh.z.data(), mesh.vertexCount(), displacement.data(), pool);
+    for (size_t v = 0; v < mesh.vertexCount(); ++v) {
+        vertices[3 * v + 1] = planeY + displacement[v];
     }
 
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
@@ -97,16 +191,33 @@ void Grid::updateAndWarp(const std::vector<Object>& objects) {
     glBindBuffer(GL_ARRAY_BUFFER, 0);
 }
 
-void Grid::draw(Shader& shader) {
+void Grid::submit(RenderQueue& queue, const Shader& shader) {
     if (VAO == 0 || vertexCount == 0) return;
-    shader.use();
-    glm::mat4 model = glm::mat4(1.0f);
-    shader.setMat4("model", model);
-    shader.setVec4("objectColor", glm::vec4(1.0f, 1.0f, 1.0f, 0.25f)); 
-    shader.setBool("isGrid", true);
-    shader.setBool("GLOW", false); 
 
-    glBindVertexArray(VAO);
-    glDrawArrays(GL_LINES, 0, vertexCount / 3); 
-    glBindVertexArray(0);
-}
\ No newline at end of file
+    DrawCall call;
+    call.vao = VAO;
+    call.blend = BlendMode::Alpha;
+    call.primitive = GL_LINES;
+    call.count = static_cast<GLsizei>(indexCount);
+    call.indexed = true;
+
+    if (warpMode == WarpMode::Gpu && warpShader) {
+        call.shader = warpShader;
+        call.bufferTexture = bodyTexture;
+        call.uniforms = [this]() {
+            warpShader->setVec4(warpColorLocation, kGridColor);
+            warpShader->setInt(warpBodyCountLocation, static_cast<int>(bodyTexels.size() / 4));
+            warpShader->setFloat(warpPlaneYLocation, planeY);
+        };
+    } else {
+        const Shader* cpuShader = &shader;
+        call.shader = cpuShader;
+        call.uniforms = [cpuShader]() {
+            cpuShader->setMat4("model", glm::mat4(1.0f));
+            cpuShader->setVec4("objectColor", kGridColor);
+            cpuShader->setBool("isGrid", true);
+            cpuShader->setBool("GLOW", false);
+        };
+    }
+    queue.submit(std::move(call));
+}
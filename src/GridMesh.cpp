@@ -0,0 +1,157 @@
+#include "GridMesh.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    inline uint64_t spreadBits(uint32_t v) {
+        uint64_t x = v;
+        x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+        x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+        x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        x = (x | (x << 2)) & 0x3333333333333333ull;
+        x = (x | (x << 1)) & 0x5555555555555555ull;
+        return x;
+    }
+
+    inline uint64_t latticeKey(uint32_t i, uint32_t j) {
+        return (static_cast<uint64_t>(i) << 32) | j;
+    }
+
+    // Splits the edges lying on each lattice line at every edge endpoint on
+    // that line and emits the covered pieces as (key, key) pairs. When
+    // vertices is given, every distinct point is appended to it once.
+    template <typename KeyFn>
+    void emitLines(std::vector<std::pair<uint64_t, uint64_t>>& segments, std::vector<uint64_t>* vertices,
+                   std::vector<uint32_t>& points,
+                   const std::vector<uint32_t>& lineStarts, const uint32_t* lineIds,
+                   const uint32_t* begins, const uint32_t* ends, KeyFn key) {
+        for (size_t l = 0; l + 1 < lineStarts.size(); ++l) {
+            const uint32_t first = lineStarts[l], last = lineStarts[l + 1];
+            points.clear();
+            for (uint32_t e = first; e < last; ++e) {
+                points.push_back(begins[e]);
+                points.push_back(ends[e]);
+            }
+            std::sort(points.begin(), points.end());
+            points.erase(std::unique(points.begin(), points.end()), points.end());
+            if (vertices) {
+                for (uint32_t point : points) vertices->push_back(key(lineIds[first], point));
+            }
+
+            // Edges are sorted by begin, so a running maximum of the covered
+            // end tells whether the gap between two points is drawn.
+            uint32_t e = first;
+            uint32_t coveredTo = 0;
+            for (size_t p = 0; p + 1 < points.size(); ++p) {
+                while (e < last && begins[e] <= points[p]) {
+                    coveredTo = std::max(coveredTo, ends[e]);
+                    ++e;
+                }
+                if (coveredTo >= points[p + 1]) {
+                    segments.push_back(std::make_pair(key(lineIds[first], points[p]), key(lineIds[first], points[p + 1])));
+                }
+            }
+        }
+    }
+}
+
+void GridMesh::refine(uint32_t i, uint32_t j, uint32_t span, int level, float unit, float halfSize,
+                      int refineLevels, float refineRatio, const std::vector<GridAnchor>& anchors) {
+    if (level < refineLevels) {
+        const float minX = -halfSize + i * unit, maxX = minX + span * unit;
+        const float minZ = -halfSize + j * unit, maxZ = minZ + span * unit;
+        float nearest2 = INFINITY;
+        for (const GridAnchor& anchor : anchors) {
+            float dx = std::max(std::max(minX - anchor.x, anchor.x - maxX), 0.0f);
+            float dz = std::max(std::max(minZ - anchor.z, anchor.z - maxZ), 0.0f);
+            nearest2 = std::min(nearest2, dx * dx + dz * dz);
+        }
+        const float reach = refineRatio * span * unit;
+        if (nearest2 < reach * reach) {
+            const uint32_t half = span / 2;
+            refine(i, j, half, level + 1, unit, halfSize, refineLevels, refineRatio, anchors);
+            refine(i + half, j, half, level + 1, unit, halfSize, refineLevels, refineRatio, anchors);
+            refine(i, j + half, half, level + 1, unit, halfSize, refineLevels, refineRatio, anchors);
+            refine(i + half, j + half, half, level + 1, unit, halfSize, refineLevels, refineRatio, anchors);
+            return;
+        }
+    }
+    horizontal.push_back(Edge{ j, i, i + span });
+    horizontal.push_back(Edge{ j + span, i, i + span });
+    vertical.push_back(Edge{ i, j, j + span });
+    vertical.push_back(Edge{ i + span, j, j + span });
+}
+
+void GridMesh::build(float size, int divisions, int refineLevels, float refineRatio, const std::vector<GridAnchor>& anchors) {
+    x.clear();
+    z.clear();
+    lines.clear();
+    horizontal.clear();
+    vertical.clear();
+    if (divisions <= 0) return;
+    refineLevels = std::max(0, std::min(refineLevels, 12));
+
+    const uint32_t baseSpan = 1u << refineLevels;
+    const float halfSize = size / 2.0f;
+    const float unit = size / static_cast<float>(static_cast<uint32_t>(divisions) * baseSpan);
+    for (uint32_t cj = 0; cj < static_cast<uint32_t>(divisions); ++cj) {
+        for (uint32_t ci = 0; ci < static_cast<uint32_t>(divisions); ++ci) {
+            refine(ci * baseSpan, cj * baseSpan, baseSpan, 0, unit, halfSize, refineLevels, refineRatio, anchors);
+        }
+    }
+
+    // Group the edges of every lattice line, ordered by where they start.
+    std::vector<std::pair<uint64_t, uint64_t>> segments;
+    std::vector<uint64_t> keys;
+    std::vector<uint32_t> points;
+    for (int axis = 0; axis < 2; ++axis) {
+        std::vector<Edge>& edges = axis == 0 ? horizontal : vertical;
+        std::sort(edges.begin(), edges.end(), [](const Edge& a, const Edge& b) {
+            return a.line != b.line ? a.line < b.line : a.begin < b.begin;
+        });
+        std::vector<uint32_t> lineStarts, lineIds(edges.size()), begins(edges.size()), ends(edges.size());
+        for (size_t e = 0; e < edges.size(); ++e) {
+            if (e == 0 || edges[e].line != edges[e - 1].line) lineStarts.push_back(static_cast<uint32_t>(e));
+            lineIds[e] = edges[e].line;
+            begins[e] = edges[e].begin;
+            ends[e] = edges[e].end;
+        }
+        lineStarts.push_back(static_cast<uint32_t>(edges.size()));
+        if (axis == 0) {
+            // Every leaf corner lies on a horizontal edge, so the horizontal
+            // lines alone see each vertex exactly once.
+            emitLines(segments, &keys, points, lineStarts, lineIds.data(), begins.data(), ends.data(),
+                      [](uint32_t line, uint32_t along) { return latticeKey(along, line); });
+        } else {
+            emitLines(segments, nullptr, points, lineStarts, lineIds.data(), begins.data(), ends.data(),
+                      [](uint32_t line, uint32_t along) { return latticeKey(line, along); });
+        }
+    }
+
+    // Number the lattice points in Morton order.
+    std::vector<std::pair<uint64_t, uint64_t>> ordered(keys.size()); // (morton, key)
+    for (size_t k = 0; k < keys.size(); ++k) {
+        uint32_t i = static_cast<uint32_t>(keys[k] >> 32), j = static_cast<uint32_t>(keys[k]);
+        ordered[k] = std::make_pair(spreadBits(i) | (spreadBits(j) << 1), keys[k]);
+    }
+    std::sort(ordered.begin(), ordered.end());
+
+    x.resize(ordered.size());
+    z.resize(ordered.size());
+    for (size_t v = 0; v < ordered.size(); ++v) {
+        uint64_t key = ordered[v].second;
+        x[v] = -halfSize + static_cast<uint32_t>(key >> 32) * unit;
+        z[v] = -halfSize + static_cast<uint32_t>(key) * unit;
+    }
+
+    auto indexOf = [&ordered](uint64_t key) {
+        uint64_t morton = spreadBits(static_cast<uint32_t>(key >> 32)) | (spreadBits(static_cast<uint32_t>(key)) << 1);
+        auto it = std::lower_bound(ordered.begin(), ordered.end(), std::make_pair(morton, key));
+        return static_cast<uint32_t>(it - ordered.begin());
+    };
+    lines.resize(segments.size() * 2);
+    for (size_t s = 0; s < segments.size(); ++s) {
+        lines[2 * s] = indexOf(segments[s].first);
+        lines[2 * s + 1] = indexOf(segments[s].second);
+    }
+}
@@ -0,0 +1,188 @@
+#include "GridWarp.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define GRAVITY_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    void applyScalar(const float* x, const float* z, size_t count, const float* sx, const float* sz,
+                     const float* rs, const float* strength, size_t sourceCount, float* displacement) {
+        for (size_t v = 0; v < count; ++v) {
+            float sum = 0.0f;
+            for (size_t s = 0; s < sourceCount; ++s) {
+                float dx = sx[s] - x[v], dz = sz[s] - z[v];
+                float d = std::max(std::sqrt(dx * dx + dz * dz), 1.0f);
+                if (d > rs[s]) sum -= strength[s] / d;
+            }
+            displacement[v] = sum;
+        }
+    }
+
+#ifdef GRAVITY_X86_DISPATCH
+    __attribute__((target("avx2,fma")))
+    void applyAvx2(const float* x, const float* z, size_t count, const float* sx, const float* sz,
+                   const float* rs, const float* strength, size_t sourceCount, float* displacement) {
+        const __m256 one = _mm256_set1_ps(1.0f);
+        size_t v = 0;
+        for (; v + 8 <= count; v += 8) {
+            const __m256 vx = _mm256_loadu_ps(x + v), vz = _mm256_loadu_ps(z + v);
+            __m256 sum = _mm256_setzero_ps();
+            for (size_t s = 0; s < sourceCount; ++s) {
+                __m256 dx = _mm256_sub_ps(_mm256_set1_ps(sx[s]), vx);
+                __m256 dz = _mm256_sub_ps(_mm256_set1_ps(sz[s]), vz);
+                __m256 d = _mm256_sqrt_ps(_mm256_fmadd_ps(dx, dx, _mm256_mul_ps(dz, dz)));
+                d = _mm256_max_ps(d, one);
+                __m256 term = _mm256_div_ps(_mm256_set1_ps(strength[s]), d);
+                sum = _mm256_sub_ps(sum, _mm256_and_ps(_mm256_cmp_ps(d, _mm256_set1_ps(rs[s]), _CMP_GT_OQ), term));
+            }
+            _mm256_storeu_ps(displacement + v, sum);
+        }
+        applyScalar(x + v, z + v, count - v, sx, sz, rs, strength, sourceCount, displacement + v);
+    }
+
+    __attribute__((target("avx512f")))
+    void applyAvx512(const float* x, const float* z, size_t count, const float* sx, const float* sz,
+                     const float* rs, const float* strength, size_t sourceCount, float* displacement) {
+        const __m512 one = _mm512_set1_ps(1.0f);
+        for (size_t v = 0; v < count; v += 16) {
+            const size_t remaining = count - v;
+            const __mmask16 lanes = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                                    : static_cast<__mmask16>((1u << remaining) - 1u);
+            const __m512 vx = _mm512_maskz_loadu_ps(lanes, x + v), vz = _mm512_maskz_loadu_ps(lanes, z + v);
+            __m512 sum = _mm512_setzero_ps();
+            for (size_t s = 0; s < sourceCount; ++s) {
+                __m512 dx = _mm512_sub_ps(_mm512_set1_ps(sx[s]), vx);
+                __m512 dz = _mm512_sub_ps(_mm512_set1_ps(sz[s]), vz);
+                __m512 d = _mm512_sqrt_ps(_mm512_fmadd_ps(dx, dx, _mm512_mul_ps(dz, dz)));
+                d = _mm512_max_ps(d, one);
+                __mmask16 outside = _mm512_cmp_ps_mask(d, _mm512_set1_ps(rs[s]), _CMP_GT_OQ);
+                sum = _mm512_mask_sub_ps(sum, outside, sum, _mm512_div_ps(_mm512_set1_ps(strength[s]), d));
+            }
+            _mm512_mask_storeu_ps(displacement + v, lanes, sum);
+        }
+    }
+#endif
+}
+
+GridWarper::GridWarper(float openingAngle, DirectKernels::Isa kernelIsa) : theta(openingAngle), isa(kernelIsa) {
+    DirectKernels::Isa supported = DirectKernels::detectIsa();
+    if (static_cast<int>(isa) > static_cast<int>(supported)) isa = supported;
+}
+
+void GridWarper::setSources(const std::vector<WarpSource>& sources) {
+    // Both rs and strength / d scale with the length unit, so converting them
+    // once here lets the vertex loops work in visual units throughout.
+    sorted = sources;
+    for (WarpSource& source : sorted) {
+        source.rs *= Constants::UNITS_PER_METER;
+        source.strength *= Constants::UNITS_PER_METER;
+    }
+    nodes.clear();
+    if (!sorted.empty()) buildNode(0, static_cast<uint32_t>(sorted.size()));
+}
+
+int32_t GridWarper::buildNode(uint32_t begin, uint32_t end) {
+    const int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.push_back(Node());
+
+    Node node;
+    node.minX = node.minZ = INFINITY;
+    node.maxX = node.maxZ = -INFINITY;
+    double weight = 0.0, cx = 0.0, cz = 0.0;
+    for (uint32_t s = begin; s < end; ++s) {
+        const WarpSource& source = sorted[s];
+        node.minX = std::min(node.minX, source.x);
+        node.maxX = std::max(node.maxX, source.x);
+        node.minZ = std::min(node.minZ, source.z);
+        node.maxZ = std::max(node.maxZ, source.z);
+        weight += source.strength;
+        cx += static_cast<double>(source.strength) * source.x;
+        cz += static_cast<double>(source.strength) * source.z;
+    }
+    node.strength = static_cast<float>(weight);
+    node.centerX = weight > 0.0 ? static_cast<float>(cx / weight) : 0.5f * (node.minX + node.maxX);
+    node.centerZ = weight > 0.0 ? static_cast<float>(cz / weight) : 0.5f * (node.minZ + node.maxZ);
+    float reachX = std::max(node.centerX - node.minX, node.maxX - node.centerX);
+    float reachZ = std::max(node.centerZ - node.minZ, node.maxZ - node.centerZ);
+    node.radius = std::sqrt(reachX * reachX + reachZ * reachZ);
+    node.begin = begin;
+    node.end = end;
+    node.left = node.right = -1;
+
+    if (end - begin > kLeafSize) {
+        // Median split along the wider side.
+        const bool splitX = node.maxX - node.minX >= node.maxZ - node.minZ;
+        const uint32_t middle = begin + (end - begin) / 2;
+        std::nth_element(sorted.begin() + begin, sorted.begin() + middle, sorted.begin() + end,
+                         [splitX](const WarpSource& a, const WarpSource& b) { return splitX ? a.x < b.x : a.z < b.z; });
+        node.left = buildNode(begin, middle);
+        node.right = buildNode(middle, end);
+    }
+    nodes[index] = node;
+    return index;
+}
+
+void GridWarper::gather(const float* x, const float* z, size_t begin, size_t end, InteractionList& list) const {
+    list.clear();
+    if (nodes.empty()) return;
+
+    float minX = INFINITY, maxX = -INFINITY, minZ = INFINITY, maxZ = -INFINITY;
+    for (size_t v = begin; v < end; ++v) {
+        minX = std::min(minX, x[v]);
+        maxX = std::max(maxX, x[v]);
+        minZ = std::min(minZ, z[v]);
+        maxZ = std::max(maxZ, z[v]);
+    }
+    const float centerX = 0.5f * (minX + maxX), centerZ = 0.5f * (minZ + maxZ);
+    const float chunkRadius = 0.5f * std::sqrt((maxX - minX) * (maxX - minX) + (maxZ - minZ) * (maxZ - minZ));
+
+    int32_t stack[128];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        float dx = node.centerX - centerX, dz = node.centerZ - centerZ;
+        float reach = node.radius + chunkRadius;
+        if (node.left >= 0 && reach * reach < theta * theta * (dx * dx + dz * dz)) {
+            list.add(node.centerX, node.centerZ, 0.0f, node.strength);
+        } else if (node.left < 0) {
+            for (uint32_t s = node.begin; s < node.end; ++s) {
+                list.add(sorted[s].x, sorted[s].z, sorted[s].rs, sorted[s].strength);
+            }
+        } else {
+            stack[top++] = node.left;
+            stack[top++] = node.right;
+        }
+    }
+}
+
+void GridWarper::evaluate(const float* x, const float* z, size_t count, float* displacement, ThreadPool& pool) {
+    lists.resize(pool.size());
+    pool.parallelFor((count + kChunk - 1) / kChunk, [&](size_t chunk, size_t worker) {
+        const size_t begin = chunk * kChunk, end = std::min(count, begin + kChunk);
+        InteractionList& list = lists[worker];
+        gather(x, z, begin, end, list);
+
+        const float* sx = list.x.data();
+        const float* sz = list.z.data();
+        const float* rs = list.rs.data();
+        const float* strength = list.strength.data();
+        switch (isa) {
+#ifdef GRAVITY_X86_DISPATCH
+            case DirectKernels::Isa::Avx512:
+                applyAvx512(x + begin, z + begin, end - begin, sx, sz, rs, strength, list.x.size(), displacement + begin);
+                break;
+            case DirectKernels::Isa::Avx2:
+                applyAvx2(x + begin, z + begin, end - begin, sx, sz, rs, strength, list.x.size(), displacement + begin);
+                break;
+#endif
+            default:
+                applyScalar(x + begin, z + begin, end - begin, sx, sz, rs, strength, list.x.size(), displacement + begin);
+                break;
+        }
+    });
+}
@@ -0,0 +1,242 @@
+#include "Integrator.hpp"
+#include "Physics.hpp"
+#include "Precision.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    void kickAll(BodySystem& bodies, float dt) {
+        const size_t n = bodies.size();
+        for (size_t i = 0; i < n; ++i) {
+            bodies.vx[i] += bodies.ax[i] * dt;
+            bodies.vy[i] += bodies.ay[i] * dt;
+            bodies.vz[i] += bodies.az[i] * dt;
+        }
+    }
+
+    void driftAll(BodySystem& bodies, float dt) {
+        const size_t n = bodies.size();
+        for (size_t i = 0; i < n; ++i) {
+            bodies.x[i] += bodies.vx[i] * dt;
+            bodies.y[i] += bodies.vy[i] * dt;
+            bodies.z[i] += bodies.vz[i] * dt;
+        }
+    }
+}
+
+void Integrator::evaluateAll(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool) {
+    PROFILE_ZONE("physics.forces");
+    solver.computeAccelerations(bodies, pool);
+    bodyEvaluations += bodies.size();
+}
+
+void EulerIntegrator::step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) {
+    evaluateAll(bodies, solver, pool);
+    Physics::kick(bodies);
+    contacts();
+    Physics::drift(bodies);
+}
+
+LeapfrogIntegrator::LeapfrogIntegrator(float frameStep, int blockLevels, float accuracy)
+    : timeStep(frameStep), levelCount(std::max(0, std::min(blockLevels, kMaxLevels))), eta(accuracy) {}
+
+void LeapfrogIntegrator::step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) {
+    const size_t n = bodies.size();
+    if (!primed || level.size() != n) {
+        evaluateAll(bodies, solver, pool);
+        // Without a previous acceleration there is no timescale yet, so
+        // every body starts on the finest level.
+        level.assign(n, static_cast<uint8_t>(levelCount));
+        prevAx.assign(bodies.ax.begin(), bodies.ax.end());
+        prevAy.assign(bodies.ay.begin(), bodies.ay.end());
+        prevAz.assign(bodies.az.begin(), bodies.az.end());
+        primed = true;
+    }
+
+    const uint32_t ticks = 1u << levelCount;
+    const float tick = timeStep / static_cast<float>(ticks);
+
+    for (uint32_t t = 0; t < ticks; ++t) {
+        for (size_t i = 0; i < n; ++i) {
+            uint32_t span = 1u << (levelCount - level[i]);
+            if (t % span != 0) continue;
+            float halfStep = 0.5f * tick * static_cast<float>(span);
+            bodies.vx[i] += bodies.ax[i] * halfStep;
+            bodies.vy[i] += bodies.ay[i] * halfStep;
+            bodies.vz[i] += bodies.az[i] * halfStep;
+        }
+
+        driftAll(bodies, tick);
+
+        const uint32_t end = t + 1;
+        active.clear();
+        for (size_t i = 0; i < n; ++i) {
+            if (end % (1u << (levelCount - level[i])) == 0) active.push_back(static_cast<uint32_t>(i));
+        }
+        // An empty system still evaluates: every tick is a full one for it,
+        // and a collective solver must be called the same number of times
+        // by every process, including those that own no bodies.
+        if (active.empty() && n > 0) continue;
+
+        if (active.size() == n) {
+            evaluateAll(bodies, solver, pool);
+        } else {
+            PROFILE_ZONE("physics.forces");
+            solver.computeAccelerationsFor(bodies, pool, active);
+            bodyEvaluations += active.size();
+        }
+
+        for (uint32_t i : active) {
+            float halfStep = 0.5f * tick * static_cast<float>(1u << (levelCount - level[i]));
+            bodies.vx[i] += bodies.ax[i] * halfStep;
+            bodies.vy[i] += bodies.ay[i] * halfStep;
+            bodies.vz[i] += bodies.az[i] * halfStep;
+            if (levelCount > 0) updateLevel(bodies, i, end);
+        }
+    }
+
+    contacts();
+}
+
+void LeapfrogIntegrator::updateLevel(const BodySystem& bodies, uint32_t i, uint32_t tick) {
+    const float dax = bodies.ax[i] - prevAx[i];
+    const float day = bodies.ay[i] - prevAy[i];
+    const float daz = bodies.az[i] - prevAz[i];
+    const float change = std::sqrt(dax * dax + day * day + daz * daz);
+    const float acc = std::sqrt(bodies.ax[i] * bodies.ax[i] + bodies.ay[i] * bodies.ay[i] + bodies.az[i] * bodies.az[i]);
+    prevAx[i] = bodies.ax[i];
+    prevAy[i] = bodies.ay[i];
+    prevAz[i] = bodies.az[i];
+
+    int current = level[i];
+    int wanted = 0;
+    if (change > 0.0f && acc > 0.0f) {
+        // eta * |a| / |da/dt| with da/dt measured over the step just taken.
+        float elapsed = timeStep / static_cast<float>(1u << current);
+        float wantedStep = eta * acc * elapsed / change;
+        wanted = static_cast<int>(std::ceil(std::log2(timeStep / wantedStep)));
+        wanted = std::max(0, std::min(wanted, levelCount));
+    }
+
+    if (wanted > current) {
+        level[i] = static_cast<uint8_t>(wanted);
+    } else if (wanted < current && tick % (1u << (levelCount - current + 1)) == 0) {
+        level[i] = static_cast<uint8_t>(current - 1);
+    }
+}
+
+void LeapfrogIntegrator::saveState(IntegratorState& state) const {
+    state.primed = primed;
+    state.level = level;
+    state.prevAx = prevAx;
+    state.prevAy = prevAy;
+    state.prevAz = prevAz;
+}
+
+bool LeapfrogIntegrator::restoreState(const IntegratorState& state, size_t bodyCount) {
+    bool fits = state.level.size() == bodyCount && state.prevAx.size() == bodyCount &&
+                state.prevAy.size() == bodyCount && state.prevAz.size() == bodyCount;
+    for (size_t i = 0; fits && i < bodyCount; ++i) fits = state.level[i] <= levelCount;
+    if (!state.primed || !fits) {
+        primed = false;
+        return !state.primed;
+    }
+    level = state.level;
+    prevAx = state.prevAx;
+    prevAy = state.prevAy;
+    prevAz = state.prevAz;
+    primed = true;
+    return true;
+}
+
+std::vector<size_t> LeapfrogIntegrator::levelHistogram() const {
+    std::vector<size_t> histogram(levelCount + 1, 0);
+    for (uint8_t l : level) ++histogram[l];
+    return histogram;
+}
+
+void VelocityVerletIntegrator::step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) {
+    if (!primed) {
+        evaluateAll(bodies, solver, pool);
+        primed = true;
+    }
+
+    const size_t n = bodies.size();
+    const float halfStep2 = 0.5f * timeStep * timeStep;
+    for (size_t i = 0; i < n; ++i) {
+        bodies.x[i] += bodies.vx[i] * timeStep + bodies.ax[i] * halfStep2;
+        bodies.y[i] += bodies.vy[i] * timeStep + bodies.ay[i] * halfStep2;
+        bodies.z[i] += bodies.vz[i] * timeStep + bodies.az[i] * halfStep2;
+    }
+    oldAx.assign(bodies.ax.begin(), bodies.ax.end());
+    oldAy.assign(bodies.ay.begin(), bodies.ay.end());
+    oldAz.assign(bodies.az.begin(), bodies.az.end());
+
+    evaluateAll(bodies, solver, pool);
+
+    const float halfStep = 0.5f * timeStep;
+    for (size_t i = 0; i < n; ++i) {
+        bodies.vx[i] += (oldAx[i] + bodies.ax[i]) * halfStep;
+        bodies.vy[i] += (oldAy[i] + bodies.ay[i]) * halfStep;
+        bodies.vz[i] += (oldAz[i] + bodies.az[i]) * halfStep;
+    }
+
+    contacts();
+}
+
+void YoshidaIntegrator::step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) {
+    if (!primed) {
+        evaluateAll(bodies, solver, pool);
+        primed = true;
+    }
+
+    const double cbrt2 = std::cbrt(2.0);
+    const float w1 = static_cast<float>(1.0 / (2.0 - cbrt2));
+    const float w0 = static_cast<float>(-cbrt2 / (2.0 - cbrt2));
+    const float weights[3] = { w1, w0, w1 };
+
+    for (float w : weights) {
+        float dt = w * timeStep;
+        kickAll(bodies, 0.5f * dt);
+        driftAll(bodies, dt);
+        evaluateAll(bodies, solver, pool);
+        kickAll(bodies, 0.5f * dt);
+    }
+
+    contacts();
+}
+
+std::unique_ptr<Integrator> createIntegrator(const IntegratorConfig& config) {
+    if (!(config.timeStep > 0.0f)) return nullptr;
+    if (config.blockLevels < 0 || config.blockLevels > LeapfrogIntegrator::kMaxLevels) return nullptr;
+    if (config.blockLevels > 0 && config.name != "leapfrog") return nullptr;
+
+    if (config.precision != "float") {
+        if (config.name != "leapfrog" || config.blockLevels > 0) return nullptr;
+        if (config.precision == "double") {
+            return std::unique_ptr<Integrator>(new PrecisionLeapfrogIntegrator<DoublePrecision>(config.timeStep));
+        }
+        if (config.precision == "kahan") {
+            return std::unique_ptr<Integrator>(new PrecisionLeapfrogIntegrator<KahanPrecision>(config.timeStep));
+        }
+        if (config.precision == "mixed") {
+            return std::unique_ptr<Integrator>(new PrecisionLeapfrogIntegrator<MixedPrecision>(config.timeStep));
+        }
+        return nullptr;
+    }
+
+    if (config.name == "euler") {
+        return std::unique_ptr<Integrator>(new EulerIntegrator());
+    }
+    if (config.name == "leapfrog") {
+        return std::unique_ptr<Integrator>(new LeapfrogIntegrator(config.timeStep, config.blockLevels, config.eta));
+    }
+    if (config.name == "verlet") {
+        return std::unique_ptr<Integrator>(new VelocityVerletIntegrator(config.timeStep));
+    }
+    if (config.name == "yoshida4") {
+        return std::unique_ptr<Integrator>(new YoshidaIntegrator(config.timeStep));
+    }
+    return nullptr;
+}
@@ -0,0 +1,116 @@
+#include "Octree.hpp"
+#include <algorithm>
+
+namespace {
+    inline int octantOf(const BodySystem& bodies, uint32_t i, float cx, float cy, float cz) {
+        return (bodies.x[i] >= cx ? 1 : 0) | (bodies.y[i] >= cy ? 2 : 0) | (bodies.z[i] >= cz ? 4 : 0);
+    }
+}
+
+void Octree::build(const BodySystem& bodies, size_t leafCapacity) {
+    const size_t n = bodies.size();
+    nodes.clear();
+    bodyOrder.resize(n);
+    scratchOrder.resize(n);
+    if (n == 0) return;
+    if (leafCapacity == 0) leafCapacity = 1;
+    for (size_t i = 0; i < n; ++i) bodyOrder[i] = static_cast<uint32_t>(i);
+
+    float minX = bodies.x[0], maxX = bodies.x[0];
+    float minY = bodies.y[0], maxY = bodies.y[0];
+    float minZ = bodies.z[0], maxZ = bodies.z[0];
+    for (size_t i = 1; i < n; ++i) {
+        minX = std::min(minX, bodies.x[i]); maxX = std::max(maxX, bodies.x[i]);
+        minY = std::min(minY, bodies.y[i]); maxY = std::max(maxY, bodies.y[i]);
+        minZ = std::min(minZ, bodies.z[i]); maxZ = std::max(maxZ, bodies.z[i]);
+    }
+
+    Node root;
+    root.centerX = 0.5f * (minX + maxX);
+    root.centerY = 0.5f * (minY + maxY);
+    root.centerZ = 0.5f * (minZ + maxZ);
+    root.halfSize = 0.5f * std::max(maxX - minX, std::max(maxY - minY, maxZ - minZ)) * 1.0001f + 1e-3f;
+    root.begin = 0;
+    root.end = static_cast<uint32_t>(n);
+    nodes.reserve(2 * n / leafCapacity + 1);
+    nodes.push_back(root);
+
+    buildNode(bodies, leafCapacity, 0);
+}
+
+void Octree::buildNode(const BodySystem& bodies, size_t leafCapacity, uint32_t nodeIndex) {
+    // Copy: nodes may reallocate while children are appended.
+    Node node = nodes[nodeIndex];
+    const uint32_t count = node.end - node.begin;
+
+    if (count <= leafCapacity || node.depth >= kMaxDepth) {
+        float m = 0.0f, cx = 0.0f, cy = 0.0f, cz = 0.0f;
+        for (uint32_t k = node.begin; k < node.end; ++k) {
+            uint32_t i = bodyOrder[k];
+            m += bodies.mass[i];
+            cx += bodies.mass[i] * bodies.x[i];
+            cy += bodies.mass[i] * bodies.y[i];
+            cz += bodies.mass[i] * bodies.z[i];
+        }
+        Node& leaf = nodes[nodeIndex];
+        leaf.mass = m;
+        leaf.comX = m > 0.0f ? cx / m : node.centerX;
+        leaf.comY = m > 0.0f ? cy / m : node.centerY;
+        leaf.comZ = m > 0.0f ? cz / m : node.centerZ;
+        return;
+    }
+
+    uint32_t counts[8] = { 0 };
+    for (uint32_t k = node.begin; k < node.end; ++k) {
+        ++counts[octantOf(bodies, bodyOrder[k], node.centerX, node.centerY, node.centerZ)];
+    }
+    uint32_t offsets[8];
+    uint32_t running = node.begin;
+    for (int o = 0; o < 8; ++o) {
+        offsets[o] = running;
+        running += counts[o];
+    }
+    uint32_t cursor[8];
+    std::copy(offsets, offsets + 8, cursor);
+    for (uint32_t k = node.begin; k < node.end; ++k) {
+        uint32_t i = bodyOrder[k];
+        scratchOrder[cursor[octantOf(bodies, i, node.centerX, node.centerY, node.centerZ)]++] = i;
+    }
+    std::copy(scratchOrder.begin() + node.begin, scratchOrder.begin() + node.end, bodyOrder.begin() + node.begin);
+
+    const int32_t firstChild = static_cast<int32_t>(nodes.size());
+    const float childHalf = 0.5f * node.halfSize;
+    uint8_t childCount = 0;
+    for (int o = 0; o < 8; ++o) {
+        if (counts[o] == 0) continue;
+        Node child;
+        child.centerX = node.centerX + ((o & 1) ? childHalf : -childHalf);
+        child.centerY = node.centerY + ((o & 2) ? childHalf : -childHalf);
+        child.centerZ = node.centerZ + ((o & 4) ? childHalf : -childHalf);
+        child.halfSize = childHalf;
+        child.begin = offsets[o];
+        child.end = offsets[o] + counts[o];
+        child.depth = static_cast<uint8_t>(node.depth + 1);
+        nodes.push_back(child);
+        ++childCount;
+    }
+
+    float m = 0.0f, cx = 0.0f, cy = 0.0f, cz = 0.0f;
+    for (uint8_t c = 0; c < childCount; ++c) {
+        uint32_t childIndex = static_cast<uint32_t>(firstChild + c);
+        buildNode(bodies, leafCapacity, childIndex);
+        const Node& child = nodes[childIndex];
+        m += child.mass;
+        cx += child.mass * child.comX;
+        cy += child.mass * child.comY;
+        cz += child.mass * child.comZ;
+    }
+
+    Node& inner = nodes[nodeIndex];
+    inner.firstChild = firstChild;
+    inner.childCount = childCount;
+    inner.mass = m;
+    inner.comX = m > 0.0f ? cx / m : node.centerX;
+    inner.comY = m > 0.0f ? cy / m : node.centerY;
+    inner.comZ = m > 0.0f ? cz / m : node.centerZ;
+}
@@ -0,0 +1,68 @@
+#include "Physics.hpp"
+#include <cmath>
+
+namespace Physics {
+    double inverseDistance(double dist, const DirectKernels::Softening& softening) {
+        using DirectKernels::SofteningLaw;
+        const double eps = softening.length;
+        if (softening.law == SofteningLaw::Plummer) return 1.0 / std::sqrt(dist * dist + eps * eps);
+        if (softening.law == SofteningLaw::Spline) {
+            const double h = DirectKernels::SofteningCoefficients::kSplineSupport * eps;
+            const double u = dist / h;
+            if (u >= 1.0) return 1.0 / dist;
+            // Spline potential (Springel 2001) in units of 1/h.
+            const double u2 = u * u;
+            if (u < 0.5) return (14.0 / 5.0 - u2 * (16.0 / 3.0 - u2 * (48.0 / 5.0 - 32.0 / 5.0 * u))) / h;
+            return (16.0 / 5.0 - 1.0 / (15.0 * u)
+                    - u2 * (32.0 / 3.0 - u * (16.0 - u * (48.0 / 5.0 - 32.0 / 15.0 * u)))) / h;
+        }
+        return dist > Constants::MIN_DISTANCE ? 1.0 / dist : 0.0;
+    }
+
+    float visualRadius(float mass, float density, float sizeRatio) {
+        float physical_radius = std::pow(((3.0f * mass / density) / (4.0f * Constants::PI)), (1.0f / 3.0f));
+        float radius = physical_radius / sizeRatio;
+        if (radius <= 0) {
+            radius = (0.1f / sizeRatio);
+        }
+        return radius;
+    }
+
+    void kick(BodySystem& bodies, float timeStepRatio) {
+        const size_t n = bodies.size();
+        for (size_t i = 0; i < n; ++i) {
+            bodies.vx[i] += bodies.ax[i] / timeStepRatio;
+            bodies.vy[i] += bodies.ay[i] / timeStepRatio;
+            bodies.vz[i] += bodies.az[i] / timeStepRatio;
+        }
+    }
+
+    void drift(BodySystem& bodies, float timeStepRatio) {
+        const size_t n = bodies.size();
+        for (size_t i = 0; i < n; ++i) {
+            bodies.x[i] += bodies.vx[i] / timeStepRatio;
+            bodies.y[i] += bodies.vy[i] / timeStepRatio;
+            bodies.z[i] += bodies.vz[i] / timeStepRatio;
+        }
+    }
+
+    double totalEnergy(const BodySystem& bodies, const DirectKernels::Softening& softening) {
+        const size_t n = bodies.size();
+        double kinetic = 0.0, potential = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            double v2 = static_cast<double>(bodies.vx[i]) * bodies.vx[i]
+                      + static_cast<double>(bodies.vy[i]) * bodies.vy[i]
+                      + static_cast<double>(bodies.vz[i]) * bodies.vz[i];
+            kinetic += 0.5 * bodies.mass[i] * v2;
+            for (size_t j = i + 1; j < n; ++j) {
+                double dx = static_cast<double>(bodies.x[j]) - bodies.x[i];
+                double dy = static_cast<double>(bodies.y[j]) - bodies.y[i];
+                double dz = static_cast<double>(bodies.z[j]) - bodies.z[i];
+                double dist = std::sqrt(dx * dx + dy * dy + dz * dz);
+                potential -= static_cast<double>(Constants::G_UNITS) * bodies.mass[i] * bodies.mass[j]
+                           * inverseDistance(dist, softening);
+            }
+        }
+        return kinetic + potential;
+    }
+}
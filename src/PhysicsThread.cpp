@@ -0,0 +1,152 @@
+#include "PhysicsThread.hpp"
+#include "Profiler.hpp"
+#include <chrono>
+#include <iostream>
+
+namespace {
+    const uint32_t kNoBody = 0xFFFFFFFFu;
+}
+
+PhysicsThread::PhysicsThread(double ticksPerSecond, size_t workerThreads)
+    : world(workerThreads), interval(ticksPerSecond > 0.0 ? 1.0 / ticksPerSecond : Constants::TIME_STEP) {}
+
+PhysicsThread::~PhysicsThread() {
+    stop();
+}
+
+double PhysicsThread::clockSeconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void PhysicsThread::start() {
+    if (running.exchange(true)) return;
+    thread = std::thread(&PhysicsThread::loop, this);
+}
+
+void PhysicsThread::stop() {
+    if (!running.exchange(false)) return;
+    thread.join();
+}
+
+bool PhysicsThread::send(const PhysicsCommand& command) {
+    if (!commands.push(command)) {
+        std::cerr << "Physics command queue is full, command dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void PhysicsThread::loop() {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::duration tick = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval));
+    Clock::time_point nextTick = Clock::now();
+
+    PROFILE_THREAD("physics");
+    publish();
+    while (running.load(std::memory_order_acquire)) {
+        bool changed = applyCommands();
+
+        Clock::time_point now = Clock::now();
+        if (now - nextTick > tick * static_cast<int>(kMaxCatchUpTicks)) {
+            nextTick = now;
+        }
+        while (nextTick <= now) {
+            if (!paused) {
+                world.step();
+                applyEdits();
+                changed = true;
+            }
+            nextTick += tick;
+        }
+
+        if (changed) publish();
+        std::this_thread::sleep_until(nextTick);
+    }
+}
+
+bool PhysicsThread::applyCommands() {
+    bool applied = false;
+    PhysicsCommand command;
+    while (commands.pop(command)) {
+        applied = true;
+        ++commandsApplied;
+        switch (command.type) {
+            case PhysicsCommand::Type::AddBody:
+                world.bodies.add(command.x, command.y, command.z, command.vx, command.vy, command.vz,
+                                 command.mass, command.radius);
+                if (command.id.index >= bodyOfSlot.size()) bodyOfSlot.resize(command.id.index + 1, kNoBody);
+                bodyOfSlot[command.id.index] = static_cast<uint32_t>(ids.size());
+                ids.push_back(command.id);
+                world.bodiesChanged();
+                break;
+            case PhysicsCommand::Type::RemoveBody: {
+                if (command.id.index >= bodyOfSlot.size()) break;
+                const uint32_t body = bodyOfSlot[command.id.index];
+                if (body == kNoBody || ids[body] != command.id) break;
+                world.bodies.swapRemove(body);
+                ids[body] = ids.back();
+                ids.pop_back();
+                if (body < ids.size()) setBodyOf(ids[body], body);
+                bodyOfSlot[command.id.index] = kNoBody;
+                world.bodiesChanged();
+                break;
+            }
+            case PhysicsCommand::Type::SetPaused:
+                paused = command.paused;
+                break;
+            case PhysicsCommand::Type::SetSolver:
+                if (!world.setSolver(command.solver)) {
+                    std::cerr << "Unknown solver or kernel: " << command.solver.name << "/" << command.solver.kernel << std::endl;
+                }
+                break;
+            case PhysicsCommand::Type::SetIntegrator:
+                if (!world.setIntegrator(command.integrator)) {
+                    std::cerr << "Invalid integrator settings: " << command.integrator.name << std::endl;
+                }
+                break;
+            case PhysicsCommand::Type::SetCollisions:
+                if (!world.setCollisions(command.collisions)) {
+                    std::cerr << "Invalid collision settings: " << command.collisions.response << std::endl;
+                }
+                break;
+        }
+    }
+    return applied;
+}
+
+void PhysicsThread::setBodyOf(SlotHandle id, uint32_t body) {
+    if ((id.index & kSpawnedBit) == 0) bodyOfSlot[id.index] = body;
+}
+
+void PhysicsThread::applyEdits() {
+    const BodyEdits& edits = world.lastEdits();
+    for (size_t k = 0; k < edits.spawnedFrom.size(); ++k) {
+        SlotHandle id;
+        id.index = kSpawnedBit | (spawnedCount++ & ~kSpawnedBit);
+        id.generation = 1;
+        ids.push_back(id);
+    }
+    for (uint32_t body : edits.removed) {
+        const SlotHandle gone = ids[body];
+        ids[body] = ids.back();
+        ids.pop_back();
+        if (body < ids.size()) setBodyOf(ids[body], body);
+        setBodyOf(gone, kNoBody);
+    }
+}
+
+void PhysicsThread::publish() {
+    BodySnapshot& out = snapshots.back();
+    const BodySystem& bodies = world.bodies;
+    out.stepCount = world.stepCount;
+    out.commandsApplied = commandsApplied;
+    out.paused = paused;
+    out.ids = ids;
+    out.x.assign(bodies.x.begin(), bodies.x.end());
+    out.y.assign(bodies.y.begin(), bodies.y.end());
+    out.z.assign(bodies.z.begin(), bodies.z.end());
+    out.mass.assign(bodies.mass.begin(), bodies.mass.end());
+    out.radius.assign(bodies.radius.begin(), bodies.radius.end());
+    out.publishedAt = clockSeconds();
+    snapshots.publish();
+}
@@ -0,0 +1,82 @@
+#include "PhysicsWorld.hpp"
+#include "Profiler.hpp"
+
+PhysicsWorld::PhysicsWorld(size_t threadCount)
+    : solver(createForceSolver(config)), timeIntegrator(createIntegrator(integratorCfg)),
+      pool(new ThreadPool(threadCount)) {}
+
+void PhysicsWorld::setThreadCount(size_t threadCount) {
+    pool.reset(new ThreadPool(threadCount));
+}
+
+bool PhysicsWorld::setSolver(const SolverConfig& newConfig) {
+    std::unique_ptr<ForceSolver> created = createForceSolver(newConfig);
+    if (!created) return false;
+    solver = std::move(created);
+    config = newConfig;
+    timeIntegrator->reset();
+    return true;
+}
+
+bool PhysicsWorld::setIntegrator(const IntegratorConfig& newConfig) {
+    std::unique_ptr<Integrator> created = createIntegrator(newConfig);
+    if (!created) return false;
+    timeIntegrator = std::move(created);
+    integratorCfg = newConfig;
+    return true;
+}
+
+bool PhysicsWorld::setCollisions(const CollisionConfig& newConfig) {
+    if (!resolver.configure(newConfig)) return false;
+    collisionCfg = newConfig;
+    return true;
+}
+
+void PhysicsWorld::markSweepStart() {
+    sweepX.assign(bodies.x.begin(), bodies.x.end());
+    sweepY.assign(bodies.y.begin(), bodies.y.end());
+    sweepZ.assign(bodies.z.begin(), bodies.z.end());
+}
+
+bool PhysicsWorld::sweepStart(const float*& startX, const float*& startY, const float*& startZ) const {
+    if (bodies.empty() || sweepX.size() != bodies.size()) return false;
+    startX = sweepX.data();
+    startY = sweepY.data();
+    startZ = sweepZ.data();
+    return true;
+}
+
+void PhysicsWorld::restoreSweepStart(const float* startX, const float* startY, const float* startZ) {
+    const size_t n = bodies.size();
+    sweepX.assign(startX, startX + n);
+    sweepY.assign(startY, startY + n);
+    sweepZ.assign(startZ, startZ + n);
+}
+
+void PhysicsWorld::step() {
+    PROFILE_ZONE("physics.step");
+    edits.clear();
+    if (!bodies.empty()) {
+        if (bodies.size() != integratedBodies) {
+            timeIntegrator->reset();
+            integratedBodies = bodies.size();
+        }
+        // Without an earlier contact stage to sweep from, sweep from here.
+        if (sweepX.size() != bodies.size()) markSweepStart();
+        timeIntegrator->step(bodies, *solver, *pool, [this]() {
+            PROFILE_ZONE("physics.collisions");
+            collisionDetector.findContacts(bodies, sweepX.data(), sweepY.data(), sweepZ.data(), *pool, contacts);
+            resolver.resolve(bodies, sweepX.data(), sweepY.data(), sweepZ.data(), contacts);
+            markSweepStart();
+        });
+        // Merges and fragments change the body count only between steps.
+        if (resolver.hasEdits()) {
+            resolver.applyEdits(bodies, edits);
+            timeIntegrator->reset();
+            integratedBodies = bodies.size();
+            markSweepStart();
+        }
+    }
+    ++stepCount;
+    simulationTime += integratorCfg.timeStep;
+}
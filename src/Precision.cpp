@@ -0,0 +1,184 @@
+#include "Precision.hpp"
+#include "Profiler.hpp"
+#include "constants.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    const size_t kRowChunk = 64;
+
+    // Kahan update: carry holds what the last add to value rounded away.
+    template <typename T>
+    inline void compensatedAdd(T& value, T& carry, T delta) {
+        T corrected = delta - carry;
+        T total = value + corrected;
+        carry = (total - value) - corrected;
+        value = total;
+    }
+}
+
+namespace PrecisionKernels {
+    template <class Policy>
+    void accumulateRows(const typename Policy::Position* x, const typename Policy::Position* y,
+                        const typename Policy::Position* z, const float* mass, size_t n,
+                        size_t begin, size_t end, float* ax, float* ay, float* az) {
+        typedef typename Policy::Real Real;
+        const Real minDist2 = static_cast<Real>(Constants::MIN_DISTANCE) * static_cast<Real>(Constants::MIN_DISTANCE);
+        const Real g = static_cast<Real>(Constants::G_UNITS);
+
+        for (size_t i = begin; i < end; ++i) {
+            const typename Policy::Position xi = x[i], yi = y[i], zi = z[i];
+            typename Policy::Sum sumX, sumY, sumZ;
+            for (size_t j = 0; j < n; ++j) {
+                // Subtract in the position type, then round to the math type.
+                Real dx = static_cast<Real>(x[j] - xi);
+                Real dy = static_cast<Real>(y[j] - yi);
+                Real dz = static_cast<Real>(z[j] - zi);
+                Real r2 = dx * dx + dy * dy + dz * dz;
+                if (r2 > minDist2) {
+                    Real invR = Real(1) / std::sqrt(r2);
+                    Real s = static_cast<Real>(mass[j]) * invR * invR * invR;
+                    sumX.add(dx * s);
+                    sumY.add(dy * s);
+                    sumZ.add(dz * s);
+                }
+            }
+            ax[i] = static_cast<float>(g * sumX.value());
+            ay[i] = static_cast<float>(g * sumY.value());
+            az[i] = static_cast<float>(g * sumZ.value());
+        }
+    }
+}
+
+template <class Policy>
+void PrecisionLeapfrogIntegrator<Policy>::seed(const BodySystem& bodies) {
+    x.assign(bodies.x.begin(), bodies.x.end());
+    y.assign(bodies.y.begin(), bodies.y.end());
+    z.assign(bodies.z.begin(), bodies.z.end());
+    vx.assign(bodies.vx.begin(), bodies.vx.end());
+    vy.assign(bodies.vy.begin(), bodies.vy.end());
+    vz.assign(bodies.vz.begin(), bodies.vz.end());
+    if constexpr (Policy::kCompensated) {
+        const size_t n = bodies.size();
+        carryX.assign(n, Position(0));
+        carryY.assign(n, Position(0));
+        carryZ.assign(n, Position(0));
+        carryVx.assign(n, Position(0));
+        carryVy.assign(n, Position(0));
+        carryVz.assign(n, Position(0));
+    }
+}
+
+template <class Policy>
+void PrecisionLeapfrogIntegrator<Policy>::evaluate(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool) {
+    PROFILE_ZONE("physics.forces");
+    const size_t n = bodies.size();
+    const DirectSumSolver* direct = dynamic_cast<const DirectSumSolver*>(&solver);
+    if (direct && direct->softening.law == DirectKernels::SofteningLaw::None) {
+        pool.parallelFor((n + kRowChunk - 1) / kRowChunk, [&](size_t chunk, size_t) {
+            PrecisionKernels::accumulateRows<Policy>(x.data(), y.data(), z.data(), bodies.mass.data(), n,
+                                                     chunk * kRowChunk, std::min(n, (chunk + 1) * kRowChunk),
+                                                     bodies.ax.data(), bodies.ay.data(), bodies.az.data());
+        });
+    } else {
+        solver.computeAccelerations(bodies, pool);
+    }
+    bodyEvaluations += n;
+}
+
+template <class Policy>
+void PrecisionLeapfrogIntegrator<Policy>::kick(const BodySystem& bodies, Position dt) {
+    const size_t n = vx.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Position dvx = static_cast<Position>(bodies.ax[i]) * dt;
+        const Position dvy = static_cast<Position>(bodies.ay[i]) * dt;
+        const Position dvz = static_cast<Position>(bodies.az[i]) * dt;
+        if constexpr (Policy::kCompensated) {
+            compensatedAdd(vx[i], carryVx[i], dvx);
+            compensatedAdd(vy[i], carryVy[i], dvy);
+            compensatedAdd(vz[i], carryVz[i], dvz);
+        } else {
+            vx[i] += dvx;
+            vy[i] += dvy;
+            vz[i] += dvz;
+        }
+    }
+}
+
+template <class Policy>
+void PrecisionLeapfrogIntegrator<Policy>::drift(Position dt) {
+    const size_t n = x.size();
+    for (size_t i = 0; i < n; ++i) {
+        if constexpr (Policy::kCompensated) {
+            compensatedAdd(x[i], carryX[i], vx[i] * dt);
+            compensatedAdd(y[i], carryY[i], vy[i] * dt);
+            compensatedAdd(z[i], carryZ[i], vz[i] * dt);
+        } else {
+            x[i] += vx[i] * dt;
+            y[i] += vy[i] * dt;
+            z[i] += vz[i] * dt;
+        }
+    }
+}
+
+template <class Policy>
+void PrecisionLeapfrogIntegrator<Policy>::step(BodySystem& bodies, ForceSolver& solver, ThreadPool& pool, const ContactStage& contacts) {
+    const size_t n = bodies.size();
+    if (!primed || x.size() != n) {
+        seed(bodies);
+        evaluate(bodies, solver, pool);
+        primed = true;
+    }
+
+    const Position halfStep = Position(0.5) * static_cast<Position>(timeStep);
+    kick(bodies, halfStep);
+    drift(static_cast<Position>(timeStep));
+    for (size_t i = 0; i < n; ++i) {
+        bodies.x[i] = static_cast<float>(x[i]);
+        bodies.y[i] = static_cast<float>(y[i]);
+        bodies.z[i] = static_cast<float>(z[i]);
+    }
+    evaluate(bodies, solver, pool);
+    kick(bodies, halfStep);
+    for (size_t i = 0; i < n; ++i) {
+        bodies.vx[i] = static_cast<float>(vx[i]);
+        bodies.vy[i] = static_cast<float>(vy[i]);
+        bodies.vz[i] = static_cast<float>(vz[i]);
+    }
+
+    contacts();
+
+    // A position or velocity the contact stage rewrote no longer matches our
+    // rounding of it.
+    for (size_t i = 0; i < n; ++i) {
+        if (bodies.x[i] != static_cast<float>(x[i]) || bodies.y[i] != static_cast<float>(y[i]) ||
+            bodies.z[i] != static_cast<float>(z[i])) {
+            x[i] = bodies.x[i];
+            y[i] = bodies.y[i];
+            z[i] = bodies.z[i];
+            if constexpr (Policy::kCompensated) {
+                carryX[i] = carryY[i] = carryZ[i] = Position(0);
+            }
+        }
+        if (bodies.vx[i] != static_cast<float>(vx[i]) || bodies.vy[i] != static_cast<float>(vy[i]) ||
+            bodies.vz[i] != static_cast<float>(vz[i])) {
+            vx[i] = bodies.vx[i];
+            vy[i] = bodies.vy[i];
+            vz[i] = bodies.vz[i];
+            if constexpr (Policy::kCompensated) {
+                carryVx[i] = carryVy[i] = carryVz[i] = Position(0);
+            }
+        }
+    }
+}
+
+#define GRAVITY_INSTANTIATE_PRECISION(Policy)                                                              \
+    template void PrecisionKernels::accumulateRows<Policy>(                                                \
+        const Policy::Position*, const Policy::Position*, const Policy::Position*, const float*, size_t,   \
+        size_t, size_t, float*, float*, float*);                                                           \
+    template class PrecisionLeapfrogIntegrator<Policy>;
+
+GRAVITY_INSTANTIATE_PRECISION(FloatPrecision)
+GRAVITY_INSTANTIATE_PRECISION(DoublePrecision)
+GRAVITY_INSTANTIATE_PRECISION(KahanPrecision)
+GRAVITY_INSTANTIATE_PRECISION(MixedPrecision)
@@ -0,0 +1,194 @@
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+
+namespace {
+    // One per live thread that has recorded a zone. The owner writes an event
+    // and then publishes it by bumping `written`; readers copy under the
+    // registry lock and drop whatever the owner may have overwritten meanwhile.
+    struct Ring {
+        std::unique_ptr<ProfileEvent[]> events{ new ProfileEvent[Profiler::kRingSize] };
+        std::atomic<uint64_t> written{0};
+        std::string threadName;
+        uint32_t threadId = 0;
+        bool owned = false;
+    };
+
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<Ring>> rings;
+    };
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    // Hands the ring back when its thread exits, so pools that are recreated
+    // reuse rings instead of growing the registry.
+    struct RingHandle {
+        Ring* ring = nullptr;
+        ~RingHandle() {
+            if (!ring) return;
+            std::lock_guard<std::mutex> lock(registry().mutex);
+            ring->owned = false;
+        }
+    };
+
+    thread_local RingHandle localRing;
+
+    Ring& threadRing() {
+        if (localRing.ring) return *localRing.ring;
+
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        Ring* ring = nullptr;
+        for (auto& candidate : reg.rings) {
+            if (!candidate->owned) {
+                ring = candidate.get();
+                break;
+            }
+        }
+        if (!ring) {
+            reg.rings.emplace_back(new Ring());
+            ring = reg.rings.back().get();
+            ring->threadId = static_cast<uint32_t>(reg.rings.size());
+        }
+        ring->written.store(0, std::memory_order_relaxed);
+        ring->threadName = "thread " + std::to_string(ring->threadId);
+        ring->owned = true;
+        localRing.ring = ring;
+        return *ring;
+    }
+}
+
+uint64_t Profiler::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    Ring& ring = threadRing();
+    uint64_t index = ring.written.load(std::memory_order_relaxed);
+    ProfileEvent& event = ring.events[index & (kRingSize - 1)];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+    ring.written.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name) {
+    Ring& ring = threadRing();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.threadName = name;
+}
+
+void Profiler::collect(std::vector<ThreadEvents>& threads) {
+    static_assert((kRingSize & (kRingSize - 1)) == 0, "kRingSize must be a power of two");
+
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    threads.clear();
+    for (auto& ring : reg.rings) {
+        uint64_t end = ring->written.load(std::memory_order_acquire);
+        uint64_t begin = end > kRingSize ? end - kRingSize : 0;
+
+        ThreadEvents copy;
+        copy.threadName = ring->threadName;
+        copy.threadId = ring->threadId;
+        copy.events.reserve(static_cast<size_t>(end - begin));
+        for (uint64_t i = begin; i < end; ++i) copy.events.push_back(ring->events[i & (kRingSize - 1)]);
+
+        // Events the owner wrote while we copied may have replaced the oldest ones.
+        uint64_t after = ring->written.load(std::memory_order_acquire);
+        uint64_t valid = after > kRingSize ? after - kRingSize : 0;
+        if (valid > begin) {
+            size_t stale = static_cast<size_t>(std::min(valid - begin, end - begin));
+            copy.events.erase(copy.events.begin(), copy.events.begin() + stale);
+        }
+        threads.push_back(std::move(copy));
+    }
+}
+
+ProfileStats Profiler::stats(const char* name, size_t window) {
+    std::vector<ThreadEvents> threads;
+    collect(threads);
+
+    std::vector<ProfileEvent> matching;
+    for (const ThreadEvents& thread : threads) {
+        for (const ProfileEvent& event : thread.events) {
+            if (event.name == name || std::strcmp(event.name, name) == 0) matching.push_back(event);
+        }
+    }
+
+    ProfileStats result;
+    if (matching.empty()) return result;
+    if (matching.size() > window) {
+        std::nth_element(matching.begin(), matching.begin() + (matching.size() - window), matching.end(),
+                         [](const ProfileEvent& a, const ProfileEvent& b) { return a.end < b.end; });
+        matching.erase(matching.begin(), matching.begin() + (matching.size() - window));
+    }
+
+    std::vector<double> durations;
+    durations.reserve(matching.size());
+    double total = 0.0;
+    for (const ProfileEvent& event : matching) {
+        double ms = static_cast<double>(event.end - event.start) * 1e-6;
+        durations.push_back(ms);
+        total += ms;
+    }
+    std::sort(durations.begin(), durations.end());
+
+    result.count = durations.size();
+    result.mean = total / static_cast<double>(durations.size());
+    result.p50 = durations[(durations.size() - 1) / 2];
+    result.p99 = durations[(durations.size() - 1) * 99 / 100];
+    return result;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) {
+    std::vector<ThreadEvents> threads;
+    collect(threads);
+
+    uint64_t epoch = UINT64_MAX;
+    for (const ThreadEvents& thread : threads) {
+        for (const ProfileEvent& event : thread.events) epoch = std::min(epoch, event.start);
+    }
+
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Failed to open trace file: " << path << std::endl;
+        return false;
+    }
+    out.setf(std::ios::fixed);
+    out.precision(3);
+
+    // Complete ("X") events with microsecond timestamps, plus one metadata
+    // event per thread so viewers show the thread names.
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const ThreadEvents& thread : threads) {
+        out << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.threadId
+            << ",\"args\":{\"name\":\"" << thread.threadName << "\"}}";
+        first = false;
+        for (const ProfileEvent& event : thread.events) {
+            out << ",\n{\"name\":\"" << event.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread.threadId
+                << ",\"ts\":" << static_cast<double>(event.start - epoch) * 1e-3
+                << ",\"dur\":" << static_cast<double>(event.end - event.start) * 1e-3 << "}";
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    if (!out) {
+        std::cerr << "Failed to write trace file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
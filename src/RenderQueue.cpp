@@ -0,0 +1,84 @@
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <tuple>
+
+RenderQueue::~RenderQueue() {
+    if (frameBuffer != 0) glDeleteBuffers(1, &frameBuffer);
+}
+
+void RenderQueue::setupOpenGLResources() {
+    if (frameBuffer != 0) return;
+    glGenBuffers(1, &frameBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, 2 * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, Shader::kFrameBinding, frameBuffer);
+}
+
+void RenderQueue::setFrame(const glm::mat4& view, const glm::mat4& projection) {
+    if (frameBuffer == 0) return;
+    // std140: two column-major mat4, no padding.
+    glBindBuffer(GL_UNIFORM_BUFFER, frameBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(glm::mat4), &view[0][0]);
+    glBufferSubData(GL_UNIFORM_BUFFER, sizeof(glm::mat4), sizeof(glm::mat4), &projection[0][0]);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+void RenderQueue::submit(DrawCall call) {
+    if (!call.shader || call.vao == 0 || call.count == 0 || call.instances == 0) return;
+    calls.push_back(std::move(call));
+}
+
+void RenderQueue::flush() {
+    order.resize(calls.size());
+    for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+    // Stable so draws with equal state keep submission order.
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        const DrawCall& x = calls[a];
+        const DrawCall& y = calls[b];
+        return std::make_tuple(x.blend, x.shader->ID, x.vao, x.bufferTexture) <
+               std::make_tuple(y.blend, y.shader->ID, y.vao, y.bufferTexture);
+    });
+
+    programChanges = 0;
+    vaoChanges = 0;
+    GLuint program = 0, vao = 0, texture = 0;
+    bool blending = true;
+    glEnable(GL_BLEND);
+
+    for (uint32_t index : order) {
+        const DrawCall& call = calls[index];
+        bool wantBlend = call.blend == BlendMode::Alpha;
+        if (wantBlend != blending) {
+            if (wantBlend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
+            blending = wantBlend;
+        }
+        if (call.shader->ID != program) {
+            call.shader->use();
+            program = call.shader->ID;
+            ++programChanges;
+        }
+        if (call.vao != vao) {
+            glBindVertexArray(call.vao);
+            vao = call.vao;
+            ++vaoChanges;
+        }
+        if (call.bufferTexture != texture) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_BUFFER, call.bufferTexture);
+            texture = call.bufferTexture;
+        }
+        if (call.uniforms) call.uniforms();
+
+        if (call.indexed) {
+            glDrawElementsInstanced(call.primitive, call.count, GL_UNSIGNED_INT, nullptr, call.instances);
+        } else {
+            glDrawArraysInstanced(call.primitive, 0, call.count, call.instances);
+        }
+    }
+
+    glBindVertexArray(0);
+    if (texture != 0) glBindTexture(GL_TEXTURE_BUFFER, 0);
+    if (!blending) glEnable(GL_BLEND);
+    calls.clear();
+}
@@ -0,0 +1,210 @@
+#include "Scenarios.hpp"
+#include "Physics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+namespace {
+    const size_t kBlockSize = 4096;
+
+    uint64_t splitMix64(uint64_t& state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // xoshiro256** seeded through splitmix64. Hand-rolled, together with the
+    // transforms below, because the standard distributions are allowed to
+    // differ between library implementations.
+    class Rng {
+    public:
+        Rng(uint64_t seed, uint64_t stream) {
+            uint64_t state = seed ^ (stream * 0xd1b54a32d192ed03ull);
+            for (uint64_t& word : s) word = splitMix64(state);
+        }
+
+        uint64_t next() {
+            const uint64_t result = rotl(s[1] * 5, 7) * 9;
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0]; s[3] ^= s[1]; s[1] ^= s[2]; s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        // In (0, 1): never exactly 0, so logs and powers stay finite.
+        double uniform() { return (static_cast<double>(next() >> 11) + 0.5) * (1.0 / 9007199254740992.0); }
+        double uniform(double low, double high) { return low + (high - low) * uniform(); }
+
+        double normal() {
+            // Box-Muller, one value per call.
+            return std::sqrt(-2.0 * std::log(uniform())) * std::cos(2.0 * M_PI * uniform());
+        }
+
+        // Uniformly distributed direction scaled to length.
+        void onSphere(double length, double& x, double& y, double& z) {
+            double cosTheta = uniform(-1.0, 1.0);
+            double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+            double phi = uniform(0.0, 2.0 * M_PI);
+            x = length * sinTheta * std::cos(phi);
+            y = length * cosTheta;
+            z = length * sinTheta * std::sin(phi);
+        }
+
+    private:
+        uint64_t s[4];
+        static uint64_t rotl(uint64_t v, int k) { return (v << k) | (v >> (64 - k)); }
+    };
+
+    typedef std::function<void(Rng&, size_t)> BodyGenerator;
+
+    // Runs generate(rng, i) for i in [first, last), one stream per block.
+    void fillBlocks(size_t first, size_t last, uint64_t seed, ThreadPool& pool, const BodyGenerator& generate) {
+        if (last <= first) return;
+        const size_t blocks = (last - first + kBlockSize - 1) / kBlockSize;
+        pool.parallelFor(blocks, [&](size_t block, size_t) {
+            Rng rng(seed, block);
+            size_t begin = first + block * kBlockSize;
+            size_t end = std::min(last, begin + kBlockSize);
+            for (size_t i = begin; i < end; ++i) generate(rng, i);
+        });
+    }
+
+    void setBody(BodySystem& bodies, size_t i, double px, double py, double pz,
+                 double velX, double velY, double velZ, float m, float r) {
+        bodies.x[i] = static_cast<float>(px);
+        bodies.y[i] = static_cast<float>(py);
+        bodies.z[i] = static_cast<float>(pz);
+        bodies.vx[i] = static_cast<float>(velX);
+        bodies.vy[i] = static_cast<float>(velY);
+        bodies.vz[i] = static_cast<float>(velZ);
+        bodies.mass[i] = m;
+        bodies.radius[i] = r;
+    }
+
+    // Plummer sphere of bodies [first, last) with total mass clusterMass,
+    // centred on (cx, cy, cz) and moving with (cvx, cvy, cvz).
+    void fillPlummer(BodySystem& bodies, size_t first, size_t last, uint64_t seed, ThreadPool& pool,
+                     double a, double clusterMass, float density,
+                     double cx, double cy, double cz, double cvx, double cvy, double cvz) {
+        const float m = static_cast<float>(clusterMass / static_cast<double>(last - first));
+        const float r = Physics::visualRadius(m, density);
+        const double gm = static_cast<double>(Constants::G_UNITS) * clusterMass;
+        fillBlocks(first, last, seed, pool, [&](Rng& rng, size_t i) {
+            double radius;
+            do {
+                radius = a / std::sqrt(std::pow(rng.uniform(), -2.0 / 3.0) - 1.0);
+            } while (radius > 10.0 * a);
+            double px, py, pz;
+            rng.onSphere(radius, px, py, pz);
+
+            // Speed as a fraction q of escape speed, q drawn from q^2 (1 - q^2)^3.5.
+            double q, g;
+            do {
+                q = rng.uniform();
+                g = 0.1 * rng.uniform();
+            } while (g > q * q * std::pow(1.0 - q * q, 3.5));
+            double escape = std::sqrt(2.0 * gm) * std::pow(radius * radius + a * a, -0.25);
+            double velX, velY, velZ;
+            rng.onSphere(q * escape, velX, velY, velZ);
+
+            setBody(bodies, i, cx + px, cy + py, cz + pz, cvx + velX, cvy + velY, cvz + velZ, m, r);
+        });
+    }
+}
+
+namespace Scenarios {
+    void loadDefault(BodySystem& bodies) {
+        bodies.clear();
+        bodies.add(-5000, 650, -350, 0, 0, -500, 5.97219e22f, Physics::visualRadius(5.97219e22f, 5515));
+        bodies.add(5000, 650, -350, 0, 0, 500, 5.97219e22f, Physics::visualRadius(5.97219e22f, 5515));
+        bodies.add(0, 0, -350, 0, 0, 0, 1.989e25f, Physics::visualRadius(1.989e25f, 5515));
+    }
+
+    bool generate(const ScenarioConfig& config, BodySystem& bodies, ThreadPool& pool) {
+        const std::string& name = config.name;
+        if (name == "default") {
+            loadDefault(bodies);
+            return true;
+        }
+        if (name != "plummer" && name != "disk" && name != "cube" && name != "clusters" && name != "planetary") {
+            return false;
+        }
+
+        const size_t n = std::max<size_t>(config.bodyCount, name == "clusters" ? 2 : 1);
+        const double scale = config.scale;
+        const double totalMass = config.totalMass;
+        const double g = Constants::G_UNITS;
+        bodies.clear();
+        bodies.resize(n);
+
+        if (name == "plummer") {
+            fillPlummer(bodies, 0, n, config.seed, pool, scale, totalMass, config.density, 0, 0, 0, 0, 0, 0);
+        } else if (name == "clusters") {
+            // Each cluster gets its own streams; the pair falls in at half the
+            // speed that would just unbind it.
+            const size_t half = n / 2;
+            const double separation = 6.0 * scale;
+            const double approach = 0.5 * std::sqrt(2.0 * g * totalMass / separation);
+            fillPlummer(bodies, 0, half, config.seed, pool, scale, totalMass * half / n, config.density,
+                        -0.5 * separation, 0, 0, 0.5 * approach, 0, 0);
+            fillPlummer(bodies, half, n, config.seed ^ 0x5bd1e995ull, pool, scale, totalMass * (n - half) / n,
+                        config.density, 0.5 * separation, 0, 0, -0.5 * approach, 0, 0);
+        } else if (name == "cube") {
+            const float m = static_cast<float>(totalMass / n);
+            const float r = Physics::visualRadius(m, config.density);
+            fillBlocks(0, n, config.seed, pool, [&](Rng& rng, size_t i) {
+                setBody(bodies, i, rng.uniform(-scale, scale), rng.uniform(-scale, scale), rng.uniform(-scale, scale),
+                        0, 0, 0, m, r);
+            });
+        } else if (name == "disk") {
+            const double bulgeMass = 0.2 * totalMass;
+            const double diskMass = totalMass - bulgeMass;
+            setBody(bodies, 0, 0, 0, 0, 0, 0, 0, static_cast<float>(bulgeMass),
+                    Physics::visualRadius(static_cast<float>(bulgeMass), config.density));
+            if (n > 1) {
+                const float m = static_cast<float>(diskMass / (n - 1));
+                const float r = Physics::visualRadius(m, config.density);
+                const double height = 0.05 * scale;
+                fillBlocks(1, n, config.seed, pool, [&](Rng& rng, size_t i) {
+                    // Surface density exp(-R / scale): R follows a gamma(2) law.
+                    double radius = -scale * std::log(rng.uniform() * rng.uniform());
+                    double phi = rng.uniform(0.0, 2.0 * M_PI);
+                    double enclosed = bulgeMass + diskMass * (1.0 - (1.0 + radius / scale) * std::exp(-radius / scale));
+                    double speed = std::sqrt(g * enclosed / radius);
+                    double dispersion = 0.05 * speed;
+                    setBody(bodies, i,
+                            radius * std::cos(phi), height * rng.normal(), radius * std::sin(phi),
+                            -speed * std::sin(phi) + dispersion * rng.normal(), dispersion * rng.normal(),
+                            speed * std::cos(phi) + dispersion * rng.normal(), m, r);
+                });
+            }
+        } else {
+            // Planetesimals carry a millionth of the star's mass between them.
+            const double starMass = totalMass / (1.0 + 1e-6);
+            setBody(bodies, 0, 0, 0, 0, 0, 0, 0, static_cast<float>(starMass),
+                    Physics::visualRadius(static_cast<float>(starMass), config.density));
+            if (n > 1) {
+                const float m = static_cast<float>((totalMass - starMass) / (n - 1));
+                const float r = Physics::visualRadius(m, config.density);
+                fillBlocks(1, n, config.seed, pool, [&](Rng& rng, size_t i) {
+                    // Uniform in semi-major axis; start at a random anomaly
+                    // with the vis-viva speed for eccentricity up to 0.05.
+                    double semiMajor = rng.uniform(0.2 * scale, scale);
+                    double eccentricity = 0.05 * rng.uniform();
+                    double anomaly = rng.uniform(0.0, 2.0 * M_PI);
+                    double radius = semiMajor * (1.0 - eccentricity * std::cos(anomaly));
+                    double phi = rng.uniform(0.0, 2.0 * M_PI);
+                    double inclination = 0.02 * rng.normal();
+                    double speed = std::sqrt(g * starMass * (2.0 / radius - 1.0 / semiMajor));
+                    double c = std::cos(phi), s = std::sin(phi);
+                    setBody(bodies, i,
+                            radius * c, radius * s * inclination, radius * s,
+                            -speed * s, speed * c * inclination, speed * c, m, r);
+                });
+            }
+        }
+        return true;
+    }
+}
@@ -8,6 +8,10 @@ Shader::Shader(const char* vertexSource, const char* fragmentSource) {
     linkProgram(vertexShader, fragmentShader);
     glDeleteShader(vertexShader);
     glDeleteShader(fragmentShader);
+    cacheUniformLocations();
+
+    GLuint frameBlock = glGetUniformBlockIndex(ID, "Frame");
+    if (frameBlock != GL_INVALID_INDEX) glUniformBlockBinding(ID, frameBlock, kFrameBinding);
 }
 
 Shader::~Shader() {
@@ -18,23 +22,67 @@ void Shader::use() const {
     glUseProgram(ID);
 }
 
+GLint Shader::uniformLocation(const std::string& name) const {
+    auto it = uniformLocations.find(name);
+    return it != uniformLocations.end() ? it->second : -1;
+}
+
 void Shader::setBool(const std::string& name, bool value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+    setBool(uniformLocation(name), value);
 }
 void Shader::setInt(const std::string& name, int value) const {
-    glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+    setInt(uniformLocation(name), value);
 }
 void Shader::setFloat(const std::string& name, float value) const {
-    glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+    setFloat(uniformLocation(name), value);
 }
 void Shader::setVec3(const std::string& name, const glm::vec3& value) const {
-    glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    setVec3(uniformLocation(name), value);
 }
 void Shader::setVec4(const std::string& name, const glm::vec4& value) const {
-    glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+    setVec4(uniformLocation(name), value);
 }
 void Shader::setMat4(const std::string& name, const glm::mat4& mat) const {
-    glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+    setMat4(uniformLocation(name), mat);
+}
+
+void Shader::setBool(GLint location, bool value) const {
+    glUniform1i(location, (int)value);
+}
+void Shader::setInt(GLint location, int value) const {
+    glUniform1i(location, value);
+}
+void Shader::setFloat(GLint location, float value) const {
+    glUniform1f(location, value);
+}
+void Shader::setVec3(GLint location, const glm::vec3& value) const {
+    glUniform3fv(location, 1, &value[0]);
+}
+void Shader::setVec4(GLint location, const glm::vec4& value) const {
+    glUniform4fv(location, 1, &value[0]);
+}
+void Shader::setMat4(GLint location, const glm::mat4& mat) const {
+    glUniformMatrix4fv(location, 1, GL_FALSE, &mat[0][0]);
+}
+
+void Shader::cacheUniformLocations() {
+    GLint count = 0, maxLength = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::string name(maxLength > 0 ? maxLength : 1, '\0');
+    for (GLint i = 0; i < count; ++i) {
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, static_cast<GLuint>(i), maxLength, &length, &size, &type, &name[0]);
+        std::string uniform(name.data(), length);
+        GLint location = glGetUniformLocation(ID, uniform.c_str());
+        if (location < 0) continue; // member of a uniform block
+        uniformLocations[uniform] = location;
+        // Arrays are reported as "name[0]"; accept the bare name too.
+        if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+            uniformLocations[uniform.substr(0, uniform.size() - 3)] = location;
+    }
 }
 
 GLuint Shader::compileShader(GLenum type, const char* source) {
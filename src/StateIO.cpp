@@ -0,0 +1,51 @@
+#include "StateIO.hpp"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <limits>
+
+namespace StateIO {
+    bool load(const std::string& path, BodySystem& bodies) {
+        std::ifstream in(path);
+        if (!in) {
+            std::cerr << "Failed to open state file: " << path << std::endl;
+            return false;
+        }
+
+        bodies.clear();
+        std::string line;
+        size_t lineNumber = 0;
+        while (std::getline(in, line)) {
+            ++lineNumber;
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos || line[first] == '#') continue;
+
+            std::istringstream fields(line);
+            float px, py, pz, velX, velY, velZ, m, r;
+            if (!(fields >> px >> py >> pz >> velX >> velY >> velZ >> m >> r)) {
+                std::cerr << "Malformed body at " << path << ":" << lineNumber << std::endl;
+                return false;
+            }
+            bodies.add(px, py, pz, velX, velY, velZ, m, r);
+        }
+        return true;
+    }
+
+    bool save(const std::string& path, const BodySystem& bodies, unsigned long long stepCount) {
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Failed to open state file for writing: " << path << std::endl;
+            return false;
+        }
+
+        out.precision(std::numeric_limits<float>::max_digits10);
+        out << "# step " << stepCount << "\n";
+        out << "# x y z vx vy vz mass radius\n";
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            out << bodies.x[i] << ' ' << bodies.y[i] << ' ' << bodies.z[i] << ' '
+                << bodies.vx[i] << ' ' << bodies.vy[i] << ' ' << bodies.vz[i] << ' '
+                << bodies.mass[i] << ' ' << bodies.radius[i] << '\n';
+        }
+        return static_cast<bool>(out);
+    }
+}
@@ -0,0 +1,116 @@
+#include "ThreadPool.hpp"
+#include "Profiler.hpp"
+
+namespace {
+    inline uint64_t packRange(uint32_t begin, uint32_t end) {
+        return (static_cast<uint64_t>(end) << 32) | begin;
+    }
+    inline uint32_t rangeBegin(uint64_t range) { return static_cast<uint32_t>(range); }
+    inline uint32_t rangeEnd(uint64_t range) { return static_cast<uint32_t>(range >> 32); }
+}
+
+ThreadPool::ThreadPool(size_t threadCount) {
+    if (threadCount == 0) threadCount = std::thread::hardware_concurrency();
+    workerCount = threadCount > 0 ? threadCount : 1;
+    ranges.reset(new WorkRange[workerCount]);
+
+    for (size_t w = 1; w < workerCount; ++w) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, w);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void ThreadPool::parallelFor(size_t taskCount, const std::function<void(size_t, size_t)>& body) {
+    if (taskCount == 0) return;
+    if (workerCount == 1 || taskCount == 1) {
+        for (size_t task = 0; task < taskCount; ++task) body(task, 0);
+        return;
+    }
+
+    for (size_t w = 0; w < workerCount; ++w) {
+        uint32_t begin = static_cast<uint32_t>(taskCount * w / workerCount);
+        uint32_t end = static_cast<uint32_t>(taskCount * (w + 1) / workerCount);
+        ranges[w].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = &body;
+        activeWorkers = workerCount - 1;
+        ++generation;
+    }
+    wake.notify_all();
+
+    runTasks(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return activeWorkers == 0; });
+    job = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t worker) {
+    PROFILE_THREAD("pool worker");
+    uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) return;
+            seenGeneration = generation;
+        }
+
+        runTasks(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--activeWorkers == 0) done.notify_one();
+    }
+}
+
+void ThreadPool::runTasks(size_t worker) {
+    PROFILE_ZONE("pool.tasks");
+    const std::function<void(size_t, size_t)>& body = *job;
+    uint32_t task;
+    for (;;) {
+        while (popTask(worker, task)) body(task, worker);
+        if (!stealTasks(worker)) return;
+    }
+}
+
+bool ThreadPool::popTask(size_t worker, uint32_t& task) {
+    std::atomic<uint64_t>& own = ranges[worker].range;
+    uint64_t current = own.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t begin = rangeBegin(current), end = rangeEnd(current);
+        if (begin >= end) return false;
+        if (own.compare_exchange_weak(current, packRange(begin + 1, end), std::memory_order_acq_rel)) {
+            task = begin;
+            return true;
+        }
+    }
+}
+
+bool ThreadPool::stealTasks(size_t worker) {
+    for (size_t offset = 1; offset < workerCount; ++offset) {
+        std::atomic<uint64_t>& victim = ranges[(worker + offset) % workerCount].range;
+        uint64_t current = victim.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t begin = rangeBegin(current), end = rangeEnd(current);
+            if (begin >= end) break;
+            // Take the upper half; the victim keeps popping from the front.
+            uint32_t split = begin + (end - begin) / 2;
+            if (victim.compare_exchange_weak(current, packRange(begin, split), std::memory_order_acq_rel)) {
+                ranges[worker].range.store(packRange(split, end), std::memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
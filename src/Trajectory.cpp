@@ -0,0 +1,304 @@
+#include "Trajectory.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char kMagic[8] = { 'G', 'R', 'A', 'V', 'T', 'R', 'A', 'J' };
+    const uint32_t kVersion = 1;
+    const uint32_t kByteOrderMark = 0x01020304u;
+    const uint32_t kChunkMagic = 0x4b4e4843u; // "CHNK"
+    const float kQuantizationLevels = 65535.0f;
+
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t stepStride;
+        uint32_t reserved;
+    };
+
+    struct ChunkHeader {
+        uint32_t magic;
+        uint32_t frameCount;
+        uint64_t bodyCount;
+        uint64_t byteSize; // including this header
+        float origin[3];   // per axis: value = origin + q * scale
+        float scale[3];
+    };
+
+    size_t alignUp(size_t value) {
+        return (value + 7) / 8 * 8;
+    }
+
+    // Byte offsets of a chunk's columns from the start of its header.
+    struct ChunkLayout {
+        size_t steps, times, mass, radius, axes[3], size;
+
+        ChunkLayout(size_t frameCount, size_t bodyCount) {
+            steps = sizeof(ChunkHeader);
+            times = steps + frameCount * sizeof(uint64_t);
+            mass = times + frameCount * sizeof(double);
+            radius = mass + bodyCount * sizeof(float);
+            axes[0] = alignUp(radius + bodyCount * sizeof(float));
+            size_t column = frameCount * bodyCount * sizeof(uint16_t);
+            axes[1] = axes[0] + column;
+            axes[2] = axes[1] + column;
+            size = alignUp(axes[2] + column);
+        }
+    };
+}
+
+bool TrajectoryRecorder::open(const std::string& path, uint32_t stepStride) {
+    close();
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Failed to open trajectory file for writing: " << path << std::endl;
+        return false;
+    }
+    FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrder = kByteOrderMark;
+    header.stepStride = stepStride;
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    dropped = 0;
+    failed.store(false);
+    stopping.store(false);
+    writer = std::thread(&TrajectoryRecorder::writerLoop, this);
+    return true;
+}
+
+void TrajectoryRecorder::record(const BodySystem& bodies, unsigned long long step, double time) {
+    if (!writer.joinable()) return;
+
+    FramePtr frame;
+    if (!spare.pop(frame)) frame.reset(new TrajectoryFrame());
+    frame->step = step;
+    frame->time = time;
+    frame->x.assign(bodies.x.begin(), bodies.x.end());
+    frame->y.assign(bodies.y.begin(), bodies.y.end());
+    frame->z.assign(bodies.z.begin(), bodies.z.end());
+    frame->mass.assign(bodies.mass.begin(), bodies.mass.end());
+    frame->radius.assign(bodies.radius.begin(), bodies.radius.end());
+    if (!pending.push(std::move(frame))) ++dropped;
+}
+
+bool TrajectoryRecorder::close() {
+    if (!writer.joinable()) return !failed.load();
+    stopping.store(true, std::memory_order_release);
+    writer.join();
+    out.close();
+    if (dropped > 0) {
+        std::cerr << "Trajectory writer fell behind; dropped " << dropped << " frames" << std::endl;
+    }
+    return !failed.load();
+}
+
+void TrajectoryRecorder::writerLoop() {
+    PROFILE_THREAD("trajectory writer");
+    for (;;) {
+        // Read the flag first so frames pushed before close() are drained.
+        bool last = stopping.load(std::memory_order_acquire);
+        FramePtr frame;
+        bool gotFrame = false;
+        while (pending.pop(frame)) {
+            gotFrame = true;
+            if (!chunk.empty() && chunk.front()->x.size() != frame->x.size()) flushChunk();
+            chunk.push_back(std::move(frame));
+            if (chunk.size() == kFramesPerChunk) flushChunk();
+        }
+        if (last) break;
+        if (!gotFrame) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    flushChunk();
+    out.flush();
+    if (!out) failed.store(true);
+}
+
+void TrajectoryRecorder::flushChunk() {
+    if (chunk.empty()) return;
+    PROFILE_ZONE("trajectory.chunk");
+
+    const size_t frameCount = chunk.size();
+    const size_t n = chunk.front()->x.size();
+    const ChunkLayout layout(frameCount, n);
+    encoded.assign(layout.size, 0);
+
+    ChunkHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kChunkMagic;
+    header.frameCount = static_cast<uint32_t>(frameCount);
+    header.bodyCount = n;
+    header.byteSize = layout.size;
+
+    for (size_t f = 0; f < frameCount; ++f) {
+        uint64_t step = chunk[f]->step;
+        std::memcpy(&encoded[layout.steps + f * sizeof(uint64_t)], &step, sizeof(step));
+        std::memcpy(&encoded[layout.times + f * sizeof(double)], &chunk[f]->time, sizeof(double));
+    }
+    if (n > 0) {
+        std::memcpy(&encoded[layout.mass], chunk.front()->mass.data(), n * sizeof(float));
+        std::memcpy(&encoded[layout.radius], chunk.front()->radius.data(), n * sizeof(float));
+    }
+
+    for (int axis = 0; axis < 3; ++axis) {
+        float low = 0.0f, high = 0.0f;
+        bool first = true;
+        for (const FramePtr& frame : chunk) {
+            const std::vector<float>& values = axis == 0 ? frame->x : axis == 1 ? frame->y : frame->z;
+            for (float v : values) {
+                if (!std::isfinite(v)) continue;
+                if (first) { low = high = v; first = false; }
+                low = std::min(low, v);
+                high = std::max(high, v);
+            }
+        }
+        float scale = high > low ? (high - low) / kQuantizationLevels : 1.0f;
+        header.origin[axis] = low;
+        header.scale[axis] = scale;
+
+        uint16_t* column = reinterpret_cast<uint16_t*>(&encoded[layout.axes[axis]]);
+        for (size_t f = 0; f < frameCount; ++f) {
+            const std::vector<float>& values = axis == 0 ? chunk[f]->x : axis == 1 ? chunk[f]->y : chunk[f]->z;
+            for (size_t i = 0; i < n; ++i) {
+                float q = std::isfinite(values[i]) ? std::round((values[i] - low) / scale) : 0.0f;
+                column[f * n + i] = static_cast<uint16_t>(std::min(std::max(q, 0.0f), kQuantizationLevels));
+            }
+        }
+    }
+    std::memcpy(encoded.data(), &header, sizeof(header));
+
+    out.write(encoded.data(), static_cast<std::streamsize>(encoded.size()));
+    if (!out) failed.store(true);
+
+    for (FramePtr& frame : chunk) {
+        spare.push(std::move(frame)); // dropped if the recorder already has plenty
+    }
+    chunk.clear();
+}
+
+bool TrajectoryReader::open(const std::string& path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Failed to open trajectory file: " << path << std::endl;
+        return false;
+    }
+    struct stat info;
+    if (::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(FileHeader)) {
+        std::cerr << "Not a trajectory file: " << path << std::endl;
+        ::close(fd);
+        return false;
+    }
+    mappedSize = static_cast<size_t>(info.st_size);
+    void* mapped = ::mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Failed to map trajectory file: " << path << std::endl;
+        mappedSize = 0;
+        return false;
+    }
+    mapping = static_cast<const char*>(mapped);
+
+    FileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.version != kVersion ||
+        header.byteOrder != kByteOrderMark) {
+        std::cerr << "Not a trajectory file, or another version or byte order: " << path << std::endl;
+        close();
+        return false;
+    }
+    stride = header.stepStride;
+
+    // A partial chunk at the end is what an interrupted recording leaves.
+    size_t offset = sizeof(FileHeader);
+    while (offset + sizeof(ChunkHeader) <= mappedSize) {
+        ChunkHeader chunkHeader;
+        std::memcpy(&chunkHeader, mapping + offset, sizeof(chunkHeader));
+        if (chunkHeader.magic != kChunkMagic || chunkHeader.frameCount == 0) break;
+        ChunkLayout layout(chunkHeader.frameCount, chunkHeader.bodyCount);
+        if (chunkHeader.byteSize != layout.size || layout.size > mappedSize - offset) break;
+
+        ChunkView view;
+        view.base = mapping + offset;
+        view.frameCount = chunkHeader.frameCount;
+        view.bodyCount = chunkHeader.bodyCount;
+        std::memcpy(view.origin, chunkHeader.origin, sizeof(view.origin));
+        std::memcpy(view.scale, chunkHeader.scale, sizeof(view.scale));
+        for (uint32_t f = 0; f < view.frameCount; ++f) {
+            frames.push_back(FrameRef{ static_cast<uint32_t>(chunks.size()), f });
+        }
+        chunks.push_back(view);
+        offset += layout.size;
+    }
+    if (frames.empty()) {
+        std::cerr << "Trajectory file has no complete frames: " << path << std::endl;
+        close();
+        return false;
+    }
+    ::madvise(const_cast<char*>(mapping), mappedSize, MADV_RANDOM);
+    return true;
+}
+
+void TrajectoryReader::close() {
+    if (mapping) ::munmap(const_cast<char*>(mapping), mappedSize);
+    mapping = nullptr;
+    mappedSize = 0;
+    chunks.clear();
+    frames.clear();
+}
+
+size_t TrajectoryReader::bodyCount(size_t frame) const {
+    return chunks[frames[frame].chunk].bodyCount;
+}
+
+unsigned long long TrajectoryReader::step(size_t frame) const {
+    const ChunkView& chunk = chunks[frames[frame].chunk];
+    uint64_t value;
+    std::memcpy(&value, chunk.base + ChunkLayout(chunk.frameCount, chunk.bodyCount).steps +
+                        frames[frame].index * sizeof(uint64_t), sizeof(value));
+    return value;
+}
+
+double TrajectoryReader::time(size_t frame) const {
+    const ChunkView& chunk = chunks[frames[frame].chunk];
+    double value;
+    std::memcpy(&value, chunk.base + ChunkLayout(chunk.frameCount, chunk.bodyCount).times +
+                        frames[frame].index * sizeof(double), sizeof(value));
+    return value;
+}
+
+const float* TrajectoryReader::mass(size_t frame) const {
+    const ChunkView& chunk = chunks[frames[frame].chunk];
+    return reinterpret_cast<const float*>(chunk.base + ChunkLayout(chunk.frameCount, chunk.bodyCount).mass);
+}
+
+const float* TrajectoryReader::radius(size_t frame) const {
+    const ChunkView& chunk = chunks[frames[frame].chunk];
+    return reinterpret_cast<const float*>(chunk.base + ChunkLayout(chunk.frameCount, chunk.bodyCount).radius);
+}
+
+void TrajectoryReader::positions(size_t frame, std::vector<float>& x, std::vector<float>& y, std::vector<float>& z) const {
+    const ChunkView& chunk = chunks[frames[frame].chunk];
+    const ChunkLayout layout(chunk.frameCount, chunk.bodyCount);
+    const size_t n = chunk.bodyCount;
+    std::vector<float>* targets[3] = { &x, &y, &z };
+    for (int axis = 0; axis < 3; ++axis) {
+        const uint16_t* column = reinterpret_cast<const uint16_t*>(chunk.base + layout.axes[axis]) +
+                                 static_cast<size_t>(frames[frame].index) * n;
+        std::vector<float>& values = *targets[axis];
+        values.resize(n);
+        const float origin = chunk.origin[axis], scale = chunk.scale[axis];
+        for (size_t i = 0; i < n; ++i) values[i] = origin + static_cast<float>(column[i]) * scale;
+    }
+}
@@ -0,0 +1,429 @@
+#include "Transport.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <poll.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    typedef std::chrono::steady_clock Clock;
+
+    // Every message travels as an 8-byte length followed by the payload;
+    // these track how much of one has gone through so far.
+    struct OutgoingFrame {
+        uint64_t length = 0;
+        const char* payload = nullptr;
+        size_t done = 0;
+
+        bool finished() const { return done == sizeof(length) + length; }
+        // Next contiguous bytes still to send.
+        const char* next(size_t& bytes) const {
+            if (done < sizeof(length)) {
+                bytes = sizeof(length) - done;
+                return reinterpret_cast<const char*>(&length) + done;
+            }
+            bytes = sizeof(length) + length - done;
+            return payload + (done - sizeof(length));
+        }
+    };
+
+    struct IncomingFrame {
+        uint64_t length = 0;
+        std::vector<char>* payload = nullptr;
+        size_t done = 0;
+
+        bool finished() const { return done >= sizeof(length) && done == sizeof(length) + length; }
+        char* next(size_t& bytes) {
+            if (done < sizeof(length)) {
+                bytes = sizeof(length) - done;
+                return reinterpret_cast<char*>(&length) + done;
+            }
+            bytes = sizeof(length) + length - done;
+            return payload->data() + (done - sizeof(length));
+        }
+        void advance(size_t bytes) {
+            done += bytes;
+            if (done == sizeof(length)) payload->resize(length);
+        }
+    };
+
+    // Prepares the frames of one exchange; returns how many are unfinished.
+    size_t startExchange(int self, int count, const std::vector<std::vector<char>>& outgoing,
+                         std::vector<std::vector<char>>& incoming,
+                         std::vector<OutgoingFrame>& out, std::vector<IncomingFrame>& in) {
+        incoming.resize(count);
+        incoming[self] = outgoing[self];
+        out.assign(count, OutgoingFrame());
+        in.assign(count, IncomingFrame());
+        for (int p = 0; p < count; ++p) {
+            if (p == self) continue;
+            out[p].length = outgoing[p].size();
+            out[p].payload = outgoing[p].data();
+            incoming[p].clear();
+            in[p].payload = &incoming[p];
+        }
+        return 2 * static_cast<size_t>(count - 1);
+    }
+
+    bool fillAddress(const std::string& path, sockaddr_un& address) {
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.data(), path.size());
+        return true;
+    }
+
+    std::string socketPath(const std::string& prefix, int rank) {
+        return prefix + "." + std::to_string(rank) + ".sock";
+    }
+
+    // Blocking transfer of a small fixed-size value during connection setup.
+    bool sendAll(int fd, const void* data, size_t bytes) {
+        const char* at = static_cast<const char*>(data);
+        while (bytes > 0) {
+            ssize_t sent = ::send(fd, at, bytes, MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            at += sent;
+            bytes -= static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    bool receiveAll(int fd, void* data, size_t bytes) {
+        char* at = static_cast<char*>(data);
+        while (bytes > 0) {
+            ssize_t got = ::recv(fd, at, bytes, 0);
+            if (got < 0 && errno == EINTR) continue;
+            if (got <= 0) return false;
+            at += got;
+            bytes -= static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    // Start of the shared segment; the process id table, the channels and
+    // the rings follow at kHeaderBytes.
+    struct SegmentHeader {
+        std::atomic<uint32_t> ready;    // set by rank 0 once the fields below are valid
+        std::atomic<uint32_t> attached; // processes other than rank 0 that mapped the segment
+        uint32_t size;
+        uint64_t ringBytes;
+    };
+    const size_t kHeaderBytes = 64;
+    const uint32_t kReady = 0x47525659u;
+
+    // Bytes of the per-rank process id table after the header, padded to a cache line.
+    size_t processIdBytes(int count) {
+        return (count * sizeof(int32_t) + 63) / 64 * 64;
+    }
+}
+
+bool Transport::allGather(const std::vector<char>& mine, std::vector<std::vector<char>>& all) {
+    std::vector<std::vector<char>> outgoing(count, mine);
+    return exchange(outgoing, all);
+}
+
+SocketTransport::~SocketTransport() {
+    for (int fd : peers) {
+        if (fd >= 0) ::close(fd);
+    }
+}
+
+bool SocketTransport::connect(const TransportConfig& config) {
+    self = config.rank;
+    count = config.size;
+    peers.assign(count, -1);
+    if (count == 1) return true;
+
+    const std::string ownPath = socketPath(config.address, self);
+    sockaddr_un address;
+    if (!fillAddress(ownPath, address)) {
+        std::cerr << "Socket path too long: " << ownPath << std::endl;
+        return false;
+    }
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ::unlink(ownPath.c_str());
+    if (listener < 0 || ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        ::listen(listener, count) != 0) {
+        std::cerr << "Failed to listen on " << ownPath << std::endl;
+        if (listener >= 0) ::close(listener);
+        return false;
+    }
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config.timeoutSeconds));
+    bool ok = true;
+    // Lower ranks may not be listening yet; keep trying until the deadline.
+    for (int peer = 0; peer < self && ok; ++peer) {
+        sockaddr_un peerAddress;
+        fillAddress(socketPath(config.address, peer), peerAddress);
+        while (true) {
+            int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd >= 0 && ::connect(fd, reinterpret_cast<sockaddr*>(&peerAddress), sizeof(peerAddress)) == 0) {
+                int32_t rank = self;
+                peers[peer] = fd;
+                ok = sendAll(fd, &rank, sizeof(rank));
+                break;
+            }
+            if (fd >= 0) ::close(fd);
+            if (Clock::now() > deadline) {
+                ok = false;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    for (int accepted = self + 1; accepted < count && ok; ++accepted) {
+        int waitMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count());
+        pollfd waiting = { listener, POLLIN, 0 };
+        int fd = waitMs > 0 && ::poll(&waiting, 1, waitMs) == 1 ? ::accept(listener, nullptr, nullptr) : -1;
+        int32_t rank = -1;
+        if (fd < 0 || !receiveAll(fd, &rank, sizeof(rank)) || rank <= self || rank >= count || peers[rank] >= 0) {
+            if (fd >= 0) ::close(fd);
+            ok = false;
+            break;
+        }
+        peers[rank] = fd;
+    }
+    ::close(listener);
+    ::unlink(ownPath.c_str());
+    if (!ok) std::cerr << "Rank " << self << ": timed out connecting to the other processes" << std::endl;
+    return ok;
+}
+
+bool SocketTransport::exchange(const std::vector<std::vector<char>>& outgoing, std::vector<std::vector<char>>& incoming) {
+    std::vector<OutgoingFrame> out;
+    std::vector<IncomingFrame> in;
+    size_t pending = startExchange(self, count, outgoing, incoming, out, in);
+    std::vector<pollfd> waiting;
+    std::vector<int> peerOf;
+
+    while (pending > 0) {
+        waiting.clear();
+        peerOf.clear();
+        for (int p = 0; p < count; ++p) {
+            if (p == self) continue;
+            short events = (out[p].finished() ? 0 : POLLOUT) | (in[p].finished() ? 0 : POLLIN);
+            if (events == 0) continue;
+            waiting.push_back(pollfd{ peers[p], events, 0 });
+            peerOf.push_back(p);
+        }
+        if (::poll(waiting.data(), waiting.size(), -1) < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        for (size_t k = 0; k < waiting.size(); ++k) {
+            const int p = peerOf[k];
+            const short events = waiting[k].revents;
+            while ((events & POLLOUT) && !out[p].finished()) {
+                size_t bytes;
+                const char* data = out[p].next(bytes);
+                ssize_t sent = ::send(peers[p], data, bytes, MSG_NOSIGNAL | MSG_DONTWAIT);
+                if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+                if (sent <= 0) return false;
+                out[p].done += static_cast<size_t>(sent);
+                if (out[p].finished()) --pending;
+            }
+            while ((events & (POLLIN | POLLHUP | POLLERR)) && !in[p].finished()) {
+                size_t bytes;
+                char* data = in[p].next(bytes);
+                ssize_t got = ::recv(peers[p], data, bytes, MSG_DONTWAIT);
+                if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) break;
+                if (got <= 0) return false; // peer closed mid-run
+                in[p].advance(static_cast<size_t>(got));
+                if (in[p].finished()) --pending;
+            }
+        }
+    }
+    return true;
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    if (mapping) ::munmap(mapping, mappingBytes);
+}
+
+int32_t* SharedMemoryTransport::processIds() const {
+    return reinterpret_cast<int32_t*>(static_cast<char*>(mapping) + kHeaderBytes);
+}
+
+SharedMemoryTransport::Channel& SharedMemoryTransport::channel(int from, int to) const {
+    Channel* channels = reinterpret_cast<Channel*>(static_cast<char*>(mapping) + kHeaderBytes + processIdBytes(count));
+    return channels[from * count + to];
+}
+
+char* SharedMemoryTransport::ring(int from, int to) const {
+    char* rings = static_cast<char*>(mapping) + kHeaderBytes + processIdBytes(count) + sizeof(Channel) * count * count;
+    return rings + (static_cast<size_t>(from) * count + to) * ringBytes;
+}
+
+bool SharedMemoryTransport::connect(const TransportConfig& config) {
+    static_assert(sizeof(SegmentHeader) <= kHeaderBytes, "segment header outgrew its slot");
+    self = config.rank;
+    count = config.size;
+    ringBytes = std::max<size_t>(config.channelBytes, 4096);
+    mappingBytes = kHeaderBytes + processIdBytes(count) + (sizeof(Channel) + ringBytes) * count * count;
+    if (count == 1) return true;
+
+    const Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(config.timeoutSeconds));
+    const char* name = config.address.c_str();
+    int fd = -1;
+    if (self == 0) {
+        ::shm_unlink(name); // left over from a crashed run
+        fd = ::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd >= 0 && ::ftruncate(fd, static_cast<off_t>(mappingBytes)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    } else {
+        // Wait for rank 0 to create and size the segment.
+        struct stat info;
+        while ((fd = ::shm_open(name, O_RDWR, 0600)) < 0 ||
+               ::fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < mappingBytes) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+            if (Clock::now() > deadline) break;
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+    if (fd < 0) {
+        std::cerr << "Rank " << self << ": failed to open shared memory segment " << config.address << std::endl;
+        if (self == 0) ::shm_unlink(name);
+        return false;
+    }
+    mapping = ::mmap(nullptr, mappingBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        std::cerr << "Rank " << self << ": failed to map shared memory segment " << config.address << std::endl;
+        if (self == 0) ::shm_unlink(name);
+        return false;
+    }
+
+    // The segment starts zeroed, which is a valid empty state for every atomic.
+    SegmentHeader* header = static_cast<SegmentHeader*>(mapping);
+    processIds()[self] = static_cast<int32_t>(::getpid());
+    bool ok = true;
+    if (self == 0) {
+        header->size = static_cast<uint32_t>(count);
+        header->ringBytes = ringBytes;
+        header->ready.store(kReady, std::memory_order_release);
+        while (header->attached.load(std::memory_order_acquire) != static_cast<uint32_t>(count - 1)) {
+            if (Clock::now() > deadline) {
+                ok = false;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ::shm_unlink(name);
+    } else {
+        while (header->ready.load(std::memory_order_acquire) != kReady) {
+            if (Clock::now() > deadline) {
+                ok = false;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        ok = ok && header->size == static_cast<uint32_t>(count) && header->ringBytes == ringBytes;
+        if (ok) header->attached.fetch_add(1, std::memory_order_acq_rel);
+    }
+    if (!ok) std::cerr << "Rank " << self << ": timed out waiting for the other processes" << std::endl;
+    return ok;
+}
+
+bool SharedMemoryTransport::exchange(const std::vector<std::vector<char>>& outgoing, std::vector<std::vector<char>>& incoming) {
+    std::vector<OutgoingFrame> out;
+    std::vector<IncomingFrame> in;
+    size_t pending = startExchange(self, count, outgoing, incoming, out, in);
+    unsigned idleRounds = 0;
+    Clock::time_point lastCheck = Clock::now();
+
+    while (pending > 0) {
+        bool moved = false;
+        for (int p = 0; p < count; ++p) {
+            if (p == self) continue;
+            if (!out[p].finished()) {
+                Channel& c = channel(self, p);
+                char* data = ring(self, p);
+                uint64_t written = c.written.load(std::memory_order_relaxed);
+                size_t space = ringBytes - static_cast<size_t>(written - c.read.load(std::memory_order_acquire));
+                while (space > 0 && !out[p].finished()) {
+                    size_t bytes;
+                    const char* from = out[p].next(bytes);
+                    const size_t at = static_cast<size_t>(written % ringBytes);
+                    const size_t chunk = std::min(std::min(bytes, space), ringBytes - at);
+                    std::memcpy(data + at, from, chunk);
+                    written += chunk;
+                    space -= chunk;
+                    out[p].done += chunk;
+                    moved = true;
+                }
+                c.written.store(written, std::memory_order_release);
+                if (out[p].finished()) --pending;
+            }
+            if (!in[p].finished()) {
+                Channel& c = channel(p, self);
+                const char* data = ring(p, self);
+                uint64_t read = c.read.load(std::memory_order_relaxed);
+                size_t available = static_cast<size_t>(c.written.load(std::memory_order_acquire) - read);
+                while (available > 0 && !in[p].finished()) {
+                    size_t bytes;
+                    char* to = in[p].next(bytes);
+                    const size_t at = static_cast<size_t>(read % ringBytes);
+                    const size_t chunk = std::min(std::min(bytes, available), ringBytes - at);
+                    std::memcpy(to, data + at, chunk);
+                    read += chunk;
+                    available -= chunk;
+                    in[p].advance(chunk);
+                    moved = true;
+                }
+                c.read.store(read, std::memory_order_release);
+                if (in[p].finished()) --pending;
+            }
+        }
+        // Spin briefly, then yield the core to the processes we wait for.
+        if (moved) {
+            idleRounds = 0;
+            continue;
+        }
+        if (++idleRounds <= 64) continue;
+        sched_yield();
+        if (Clock::now() - lastCheck < std::chrono::seconds(1)) continue;
+        lastCheck = Clock::now();
+        for (int p = 0; p < count; ++p) {
+            if (p == self || (out[p].finished() && in[p].finished())) continue;
+            if (::kill(processIds()[p], 0) != 0 && errno == ESRCH) {
+                std::cerr << "Rank " << self << ": process of rank " << p << " exited" << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<Transport> createTransport(const TransportConfig& config) {
+    if (config.size < 1 || config.rank < 0 || config.rank >= config.size) return nullptr;
+    if (config.name == "socket") {
+        std::unique_ptr<SocketTransport> transport(new SocketTransport());
+        if (!transport->connect(config)) return nullptr;
+        return std::unique_ptr<Transport>(transport.release());
+    }
+    if (config.name == "shm") {
+        std::unique_ptr<SharedMemoryTransport> transport(new SharedMemoryTransport());
+        if (!transport->connect(config)) return nullptr;
+        return std::unique_ptr<Transport>(transport.release());
+    }
+    return nullptr;
+}
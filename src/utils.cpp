@@ -1,4 +1,5 @@
 #include "utils.hpp" 
+#include "constants.hpp"
 #include <cmath>     
 
 namespace Utils {
@@ -9,6 +10,44 @@ namespace Utils {
         return glm::vec3(x, y, z);
     }
 
+    void buildUnitSphere(int stacks, int sectors, std::vector<float>& vertices, std::vector<GLuint>& indices) {
+        vertices.clear();
+        indices.clear();
+
+        std::vector<float> cosPhi(sectors), sinPhi(sectors);
+        for (int j = 0; j < sectors; ++j) {
+            float phi = static_cast<float>(j) / sectors * 2.0f * Constants::PI;
+            cosPhi[j] = std::cos(phi);
+            sinPhi[j] = std::sin(phi);
+        }
+
+        vertices.insert(vertices.end(), { 0.0f, 1.0f, 0.0f });
+        for (int i = 1; i < stacks; ++i) {
+            float theta = static_cast<float>(i) / stacks * Constants::PI;
+            float ringRadius = std::sin(theta);
+            float y = std::cos(theta);
+            for (int j = 0; j < sectors; ++j) {
+                vertices.insert(vertices.end(), { ringRadius * cosPhi[j], y, ringRadius * sinPhi[j] });
+            }
+        }
+        vertices.insert(vertices.end(), { 0.0f, -1.0f, 0.0f });
+
+        const GLuint south = static_cast<GLuint>(vertices.size() / 3 - 1);
+        auto ring = [sectors](int i, int j) { return static_cast<GLuint>(1 + (i - 1) * sectors + j % sectors); };
+        for (int j = 0; j < sectors; ++j) {
+            indices.insert(indices.end(), { 0, ring(1, j + 1), ring(1, j) });
+        }
+        for (int i = 1; i < stacks - 1; ++i) {
+            for (int j = 0; j < sectors; ++j) {
+                GLuint a = ring(i, j), b = ring(i, j + 1), c = ring(i + 1, j), d = ring(i + 1, j + 1);
+                indices.insert(indices.end(), { a, b, c, b, d, c });
+            }
+        }
+        for (int j = 0; j < sectors; ++j) {
+            indices.insert(indices.end(), { south, ring(stacks - 1, j), ring(stacks - 1, j + 1) });
+        }
+    }
+
     void createVBOVAO(GLuint& VAO, GLuint& VBO, const float* vertices, size_t vertexCount, GLenum usage) {
         glGenVertexArrays(1, &VAO);
         glGenBuffers(1, &VBO);
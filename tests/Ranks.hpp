@@ -0,0 +1,50 @@
+#ifndef TEST_RANKS_HPP
+#define TEST_RANKS_HPP
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "TestSupport.hpp"
+#include "Transport.hpp"
+
+// Runs body(rank) in size processes forked from this one, the caller being
+// rank 0, and returns true if every one returned 0. Call before creating
+// any thread pool: only the forking thread survives in the children.
+inline bool runRanks(int size, const std::function<int(int)>& body) {
+    std::fflush(nullptr);
+    std::vector<pid_t> children;
+    for (int rank = 1; rank < size; ++rank) {
+        pid_t child = fork();
+        if (child == 0) {
+            int result = body(rank);
+            std::fflush(nullptr);
+            _exit(result == 0 && TestSupport::failures() == 0 ? 0 : 1);
+        }
+        if (child < 0) return false;
+        children.push_back(child);
+    }
+    bool ok = body(0) == 0;
+    for (pid_t child : children) {
+        int status = 0;
+        if (waitpid(child, &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok;
+}
+
+// Transport settings unique to this process and call.
+inline TransportConfig transportFor(const std::string& name, int rank, int size) {
+    static int runs = 0;
+    TransportConfig config;
+    config.name = name;
+    config.rank = rank;
+    config.size = size;
+    config.timeoutSeconds = 10.0;
+    config.address = std::string(name == "socket" ? "/tmp" : "") + "/gravity-test-" + std::to_string(getpid()) + "-" +
+                     std::to_string(runs++);
+    return config;
+}
+
+#endif
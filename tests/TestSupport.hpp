@@ -0,0 +1,64 @@
+#ifndef TEST_SUPPORT_HPP
+#define TEST_SUPPORT_HPP
+
+#include <cmath>
+#include <iostream>
+#include "BodySystem.hpp"
+#include "Scenarios.hpp"
+#include "ThreadPool.hpp"
+
+// Minimal checks for the ctest programs: a failed CHECK prints where and
+// what, and TEST_RESULT() turns any failure into a nonzero exit code.
+namespace TestSupport {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const char* expression) {
+        std::cerr << file << ":" << line << ": check failed: " << expression << std::endl;
+        ++failures();
+    }
+
+    // Plummer sphere of n bodies, the same for every call with the same seed.
+    inline void plummer(size_t n, uint64_t seed, BodySystem& bodies) {
+        ThreadPool pool(1);
+        ScenarioConfig config;
+        config.name = "plummer";
+        config.bodyCount = n;
+        config.seed = seed;
+        Scenarios::generate(config, bodies, pool);
+    }
+
+    // RMS of the acceleration error over the RMS acceleration of reference.
+    inline double accelerationError(const BodySystem& bodies, const BodySystem& reference) {
+        double error = 0.0, norm = 0.0;
+        for (size_t i = 0; i < reference.size(); ++i) {
+            const double dx = bodies.ax[i] - reference.ax[i];
+            const double dy = bodies.ay[i] - reference.ay[i];
+            const double dz = bodies.az[i] - reference.az[i];
+            error += dx * dx + dy * dy + dz * dz;
+            norm += static_cast<double>(reference.ax[i]) * reference.ax[i] +
+                    static_cast<double>(reference.ay[i]) * reference.ay[i] +
+                    static_cast<double>(reference.az[i]) * reference.az[i];
+        }
+        return norm > 0.0 ? std::sqrt(error / norm) : std::sqrt(error);
+    }
+}
+
+#define CHECK(condition) \
+    do { if (!(condition)) TestSupport::fail(__FILE__, __LINE__, #condition); } while (0)
+
+// |actual - expected| <= tolerance, printing both values on failure.
+#define CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        const double checkActual = (actual), checkExpected = (expected); \
+        if (!(std::fabs(checkActual - checkExpected) <= (tolerance))) { \
+            TestSupport::fail(__FILE__, __LINE__, #actual " ~ " #expected); \
+            std::cerr << "  " << checkActual << " vs " << checkExpected << std::endl; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() (TestSupport::failures() == 0 ? 0 : 1)
+
+#endif
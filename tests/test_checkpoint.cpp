@@ -0,0 +1,110 @@
+#include "Checkpoint.hpp"
+#include "TestSupport.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+static bool sameBodies(const BodySystem& a, const BodySystem& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.x[i] != b.x[i] || a.y[i] != b.y[i] || a.z[i] != b.z[i] || a.vx[i] != b.vx[i] || a.vy[i] != b.vy[i] ||
+            a.vz[i] != b.vz[i] || a.mass[i] != b.mass[i] || a.radius[i] != b.radius[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Block-timestep leapfrog with merging collisions, so the checkpoint has to
+// carry integrator levels and the collision sweep to continue exactly.
+static void configure(PhysicsWorld& world) {
+    IntegratorConfig integrator;
+    integrator.name = "leapfrog";
+    integrator.timeStep = 20.0f;
+    integrator.blockLevels = 3;
+    CHECK(world.setIntegrator(integrator));
+    CollisionConfig collisions;
+    collisions.response = "merge";
+    CHECK(world.setCollisions(collisions));
+}
+
+// A restored world steps on bit for bit like the one that was saved.
+static void restoreContinuesExactly() {
+    PhysicsWorld original(1);
+    configure(original);
+    TestSupport::plummer(500, 8, original.bodies);
+    for (int s = 0; s < 10; ++s) original.step();
+    const std::string path = "test_checkpoint_round_trip.bin";
+    CHECK(Checkpoint::save(path, original));
+
+    PhysicsWorld restored(1);
+    CHECK(Checkpoint::load(path, restored));
+    std::remove(path.c_str());
+    CHECK(restored.stepCount == original.stepCount);
+    CHECK(restored.simulationTime == original.simulationTime);
+    CHECK(restored.integratorConfig().blockLevels == 3);
+    CHECK(restored.collisionConfig().response == "merge");
+    CHECK(sameBodies(restored.bodies, original.bodies));
+    for (int s = 0; s < 10; ++s) {
+        original.step();
+        restored.step();
+    }
+    CHECK(sameBodies(restored.bodies, original.bodies));
+}
+
+// A cut-off file is refused and leaves the world alone.
+static void rejectsTruncatedFile() {
+    PhysicsWorld world(1);
+    TestSupport::plummer(100, 2, world.bodies);
+    const std::string path = "test_checkpoint_truncated.bin";
+    CHECK(Checkpoint::save(path, world));
+    std::string bytes;
+    {
+        std::ifstream in(path, std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+    }
+    PhysicsWorld other(1);
+    other.bodies.add(1, 2, 3, 0, 0, 0, 1e20f, 1.0f);
+    CHECK(!Checkpoint::load(path, other));
+    std::remove(path.c_str());
+    CHECK(other.bodies.size() == 1 && other.bodies.x[0] == 1.0f);
+}
+
+// Saves in quick succession never wait for the disk; once the writer is
+// drained the file holds the last snapshot.
+static void writerKeepsLatestSnapshot() {
+    PhysicsWorld world(1);
+    configure(world);
+    TestSupport::plummer(20000, 3, world.bodies);
+    const std::string path = "test_checkpoint_background.bin";
+    CheckpointWriter writer;
+    for (int s = 0; s < 20; ++s) {
+        world.stepCount = static_cast<unsigned long long>(s + 1);
+        writer.save(path, world);
+    }
+    CHECK(writer.wait());
+    CHECK(!writer.busy());
+    PhysicsWorld restored(1);
+    CHECK(Checkpoint::load(path, restored));
+    std::remove(path.c_str());
+    CHECK(restored.stepCount == 20);
+    CHECK(sameBodies(restored.bodies, world.bodies));
+    CHECK(writer.droppedSnapshots() < 20);
+
+    // A failed write is reported once.
+    writer.save("/nonexistent-directory/checkpoint.bin", world);
+    CHECK(!writer.wait());
+    CHECK(writer.wait());
+}
+
+int main() {
+    restoreContinuesExactly();
+    rejectsTruncatedFile();
+    writerKeepsLatestSnapshot();
+    return TEST_RESULT();
+}
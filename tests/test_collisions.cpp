@@ -0,0 +1,175 @@
+#include "CollisionDetector.hpp"
+#include "ContactResponse.hpp"
+#include "TestSupport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<uint32_t, uint32_t>> PairList;
+
+static PairList sortedPairs(const std::vector<ContactPair>& contacts) {
+    PairList pairs;
+    for (const ContactPair& contact : contacts) pairs.emplace_back(contact.a, contact.b);
+    std::sort(pairs.begin(), pairs.end());
+    return pairs;
+}
+
+static PairList bruteForce(const BodySystem& bodies) {
+    PairList pairs;
+    for (uint32_t i = 0; i < bodies.size(); ++i) {
+        for (uint32_t j = i + 1; j < bodies.size(); ++j) {
+            const float dx = bodies.x[j] - bodies.x[i], dy = bodies.y[j] - bodies.y[i], dz = bodies.z[j] - bodies.z[i];
+            const float reach = bodies.radius[i] + bodies.radius[j];
+            if (dx * dx + dy * dy + dz * dz <= reach * reach) pairs.emplace_back(i, j);
+        }
+    }
+    return pairs;
+}
+
+// A dense cloud of small bodies with a few giants spanning many cells: the
+// hash finds exactly the overlapping pairs, whatever the worker count.
+static void broadphaseMatchesBruteForce() {
+    std::mt19937 rng(17);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f), size(0.5f, 4.0f);
+    BodySystem bodies;
+    for (int i = 0; i < 3000; ++i) bodies.add(position(rng), position(rng), position(rng), 0, 0, 0, 1e20f, size(rng));
+    bodies.add(0, 0, 0, 0, 0, 0, 1e24f, 60.0f);
+    bodies.add(80, -80, 0, 0, 0, 0, 1e24f, 30.0f);
+    const PairList expected = bruteForce(bodies);
+    CHECK(expected.size() > 100);
+
+    CollisionDetector detector;
+    std::vector<ContactPair> contacts;
+    const size_t threads[] = { 1, 4 };
+    for (size_t count : threads) {
+        ThreadPool pool(count);
+        detector.findContacts(bodies, pool, contacts);
+        CHECK(sortedPairs(contacts) == expected);
+        // Far fewer candidates than pairs.
+        CHECK(detector.candidateCount() < bodies.size() * bodies.size() / 20);
+    }
+}
+
+// Two bodies that swap places within one sweep never overlap at either
+// end, but the swept test catches them at the right moment.
+static void sweepCatchesTunnelling() {
+    BodySystem bodies;
+    bodies.add(100, 0, 0, 0, 0, 0, 1e20f, 1.0f);
+    bodies.add(-100, 0.5f, 0, 0, 0, 0, 1e20f, 1.0f);
+    bodies.add(0, 50, 0, 0, 0, 0, 1e20f, 1.0f); // still
+    const float startX[] = { -100, 100, 0 }, startY[] = { 0, 0.5f, 50 }, startZ[] = { 0, 0, 0 };
+    ThreadPool pool(1);
+    CollisionDetector detector;
+    std::vector<ContactPair> contacts;
+    detector.findContacts(bodies, pool, contacts);
+    CHECK(contacts.empty());
+    detector.findContacts(bodies, startX, startY, startZ, pool, contacts);
+    CHECK(contacts.size() == 1);
+    if (contacts.size() != 1) return;
+    CHECK(contacts[0].a == 0 && contacts[0].b == 1);
+    // Centres 200 apart close at 400 per sweep until they are sqrt(4 - 0.25) apart.
+    CHECK_NEAR(contacts[0].toi, (200.0 - std::sqrt(3.75)) / 400.0, 1e-4);
+}
+
+struct Totals {
+    double mass = 0, px = 0, py = 0, pz = 0, volume = 0;
+};
+
+// Momentum in units of the total mass, so nothing overflows.
+static Totals totals(const BodySystem& bodies) {
+    Totals t;
+    for (size_t i = 0; i < bodies.size(); ++i) t.mass += bodies.mass[i];
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const double share = bodies.mass[i] / t.mass;
+        t.px += share * bodies.vx[i]; t.py += share * bodies.vy[i]; t.pz += share * bodies.vz[i];
+        t.volume += static_cast<double>(bodies.radius[i]) * bodies.radius[i] * bodies.radius[i];
+    }
+    return t;
+}
+
+static void resolveAll(const std::string& response, BodySystem& bodies, BodyEdits& edits) {
+    CollisionConfig config;
+    config.response = response;
+    config.restitution = 0.5f;
+    ContactResolver resolver;
+    CHECK(resolver.configure(config));
+    ThreadPool pool(1);
+    CollisionDetector detector;
+    std::vector<ContactPair> contacts;
+    detector.findContacts(bodies, pool, contacts);
+    CHECK(!contacts.empty());
+    edits.clear();
+    resolver.resolve(bodies, nullptr, nullptr, nullptr, contacts);
+    resolver.applyEdits(bodies, edits);
+}
+
+// Bounce keeps momentum and scales the closing speed by the restitution;
+// merge keeps mass, momentum and volume; a fast impact shatters the
+// lighter body into pieces carrying its mass.
+static void responsesConserve() {
+    BodySystem bodies;
+    bodies.add(0, 0, 0, 3, 0, 0, 3e22f, 10.0f);
+    bodies.add(15, 0, 0, -1, 0, 0, 1e22f, 6.0f);
+    BodyEdits edits;
+    Totals before = totals(bodies);
+    resolveAll("bounce", bodies, edits);
+    Totals after = totals(bodies);
+    CHECK(edits.empty() && bodies.size() == 2);
+    CHECK_NEAR(after.px, before.px, 1e-5);
+    CHECK_NEAR(bodies.vx[1] - bodies.vx[0], 0.5 * 4.0, 1e-4);
+    CHECK(bodies.x[1] - bodies.x[0] >= 16.0f - 1e-3f);
+
+    bodies.clear();
+    bodies.add(0, 0, 0, 3, 1, 0, 3e22f, 10.0f);
+    bodies.add(15, 0, 0, -1, 0, 2, 1e22f, 6.0f);
+    before = totals(bodies);
+    resolveAll("merge", bodies, edits);
+    after = totals(bodies);
+    CHECK(bodies.size() == 1 && edits.removed.size() == 1 && edits.removed[0] == 1);
+    CHECK_NEAR(after.mass / before.mass, 1.0, 1e-6);
+    CHECK_NEAR(after.px, before.px, 1e-5);
+    CHECK_NEAR(after.py, before.py, 1e-5);
+    CHECK_NEAR(after.pz, before.pz, 1e-5);
+    CHECK_NEAR(after.volume / before.volume, 1.0, 1e-5);
+
+    // Far above the mutual escape speed of these light bodies.
+    bodies.clear();
+    bodies.add(0, 0, 0, 0, 0, 0, 3e22f, 10.0f);
+    bodies.add(15, 0, 0, -3000, 0, 0, 1e22f, 6.0f);
+    before = totals(bodies);
+    resolveAll("fragment", bodies, edits);
+    after = totals(bodies);
+    CHECK(bodies.size() == 1 + 4 && edits.spawnedFrom.size() == 4);
+    CHECK_NEAR(after.mass / before.mass, 1.0, 1e-6);
+    CHECK_NEAR(after.px, before.px, 1e-4);
+    CHECK_NEAR(after.py, before.py, 1e-4);
+    // The pieces start clear of each other and of the survivor.
+    std::vector<ContactPair> contacts;
+    ThreadPool pool(1);
+    CollisionDetector detector;
+    detector.findContacts(bodies, pool, contacts);
+    CHECK(contacts.empty());
+}
+
+static void rejectsUnknownResponse() {
+    ContactResolver resolver;
+    CollisionConfig config;
+    config.response = "stick";
+    CHECK(!resolver.configure(config));
+    config.response = "fragment";
+    config.fragmentCount = 9;
+    CHECK(!resolver.configure(config));
+}
+
+int main() {
+    broadphaseMatchesBruteForce();
+    sweepCatchesTunnelling();
+    responsesConserve();
+    rejectsUnknownResponse();
+    return TEST_RESULT();
+}
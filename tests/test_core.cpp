@@ -0,0 +1,84 @@
+#include "PhysicsWorld.hpp"
+#include "Scenarios.hpp"
+#include "StateIO.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Total momentum over total mass times the RMS speed: zero for an exactly
+// conserved momentum starting from rest, whatever the units.
+static double momentumDrift(const BodySystem& bodies) {
+    double px = 0.0, py = 0.0, pz = 0.0, total = 0.0, speed2 = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const double m = bodies.mass[i];
+        px += m * bodies.vx[i]; py += m * bodies.vy[i]; pz += m * bodies.vz[i];
+        total += m;
+        speed2 += static_cast<double>(bodies.vx[i]) * bodies.vx[i] + static_cast<double>(bodies.vy[i]) * bodies.vy[i] +
+                  static_cast<double>(bodies.vz[i]) * bodies.vz[i];
+    }
+    return std::sqrt(px * px + py * py + pz * pz) / (total * std::sqrt(speed2 / bodies.size()));
+}
+
+static void stepsDefaultScene() {
+    PhysicsWorld world(2);
+    Scenarios::loadDefault(world.bodies);
+    const double before = momentumDrift(world.bodies);
+    for (int s = 0; s < 500; ++s) world.step();
+    CHECK(world.stepCount == 500);
+    CHECK_NEAR(world.simulationTime, 500.0 * world.integratorConfig().timeStep, 1e-6);
+    CHECK(world.bodies.size() == 3);
+    for (size_t i = 0; i < world.bodies.size(); ++i) {
+        CHECK(std::isfinite(world.bodies.x[i]) && std::isfinite(world.bodies.vx[i]));
+    }
+    // Pair forces are applied to both bodies at once.
+    CHECK_NEAR(momentumDrift(world.bodies), before, 1e-5);
+}
+
+static void rejectsUnknownSettings() {
+    PhysicsWorld world(1);
+    SolverConfig solver;
+    solver.name = "no-such-solver";
+    CHECK(!world.setSolver(solver));
+    CHECK(std::string(world.forceSolver().name()) == "direct");
+    IntegratorConfig integrator;
+    integrator.timeStep = -1.0f;
+    CHECK(!world.setIntegrator(integrator));
+}
+
+static void stateRoundTrip() {
+    BodySystem bodies;
+    TestSupport::plummer(100, 7, bodies);
+    const std::string path = "test_core_state.txt";
+    CHECK(StateIO::save(path, bodies, 42));
+    BodySystem loaded;
+    CHECK(StateIO::load(path, loaded));
+    std::remove(path.c_str());
+    CHECK(loaded.size() == bodies.size());
+    bool same = loaded.size() == bodies.size();
+    for (size_t i = 0; same && i < bodies.size(); ++i) {
+        same = loaded.x[i] == bodies.x[i] && loaded.y[i] == bodies.y[i] && loaded.z[i] == bodies.z[i] &&
+               loaded.vx[i] == bodies.vx[i] && loaded.vy[i] == bodies.vy[i] && loaded.vz[i] == bodies.vz[i] &&
+               loaded.mass[i] == bodies.mass[i] && loaded.radius[i] == bodies.radius[i];
+    }
+    CHECK(same);
+}
+
+static void swapRemoveMovesLast() {
+    BodySystem bodies;
+    for (int i = 0; i < 4; ++i) bodies.add(static_cast<float>(i), 0, 0, 0, 0, 0, 1.0f + i, 1.0f);
+    bodies.swapRemove(1);
+    CHECK(bodies.size() == 3);
+    CHECK(bodies.x[1] == 3.0f && bodies.mass[1] == 4.0f);
+    bodies.swapRemove(2);
+    CHECK(bodies.size() == 2 && bodies.x[0] == 0.0f && bodies.x[1] == 3.0f);
+}
+
+int main() {
+    stepsDefaultScene();
+    rejectsUnknownSettings();
+    stateRoundTrip();
+    swapRemoveMovesLast();
+    return TEST_RESULT();
+}
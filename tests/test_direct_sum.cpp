@@ -0,0 +1,83 @@
+#include "ForceSolver.hpp"
+#include "TestSupport.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Upper-triangle tiles of the interaction matrix, diagonal ones included,
+// summed with the third-law kernel must give the one-sided result.
+static void tilesMatchRange() {
+    BodySystem reference;
+    TestSupport::plummer(1000, 9, reference);
+    const DirectKernels::Softening softening;
+    DirectKernels::computeRange(DirectKernels::Isa::Scalar, softening, reference, 0, reference.size());
+
+    const DirectKernels::Isa isas[] = { DirectKernels::Isa::Scalar, DirectKernels::Isa::Avx2, DirectKernels::Isa::Avx512 };
+    const size_t n = reference.size(), tile = 96;
+    for (DirectKernels::Isa isa : isas) {
+        std::vector<float> accX(n, 0.0f), accY(n, 0.0f), accZ(n, 0.0f);
+        for (size_t i = 0; i < n; i += tile) {
+            for (size_t j = i; j < n; j += tile) {
+                DirectKernels::accumulateTile(isa, softening, reference, i, std::min(i + tile, n), j, std::min(j + tile, n),
+                                              accX.data(), accY.data(), accZ.data());
+            }
+        }
+        BodySystem bodies = reference;
+        for (size_t i = 0; i < n; ++i) {
+            bodies.ax[i] = Constants::G_UNITS * accX[i];
+            bodies.ay[i] = Constants::G_UNITS * accY[i];
+            bodies.az[i] = Constants::G_UNITS * accZ[i];
+        }
+        CHECK(TestSupport::accelerationError(bodies, reference) < 1e-5);
+    }
+}
+
+// Net force over the sum of force magnitudes, in mass fractions so the
+// products stay within float range.
+static double netForce(const BodySystem& bodies) {
+    double total = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) total += bodies.mass[i];
+    double fx = 0.0, fy = 0.0, fz = 0.0, magnitude = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        const double m = bodies.mass[i] / total;
+        fx += m * bodies.ax[i]; fy += m * bodies.ay[i]; fz += m * bodies.az[i];
+        magnitude += m * std::sqrt(static_cast<double>(bodies.ax[i]) * bodies.ax[i] +
+                                   static_cast<double>(bodies.ay[i]) * bodies.ay[i] +
+                                   static_cast<double>(bodies.az[i]) * bodies.az[i]);
+    }
+    return std::sqrt(fx * fx + fy * fy + fz * fz) / magnitude;
+}
+
+// The pooled solver gives the same result for any worker count, and a
+// target list refreshes at least the listed bodies.
+static void solverMatchesRange() {
+    BodySystem reference;
+    TestSupport::plummer(3001, 13, reference);
+    DirectKernels::computeRange(DirectKernels::Isa::Scalar, DirectKernels::Softening(), reference, 0, reference.size());
+    const size_t threads[] = { 1, 3, 4 };
+    for (size_t count : threads) {
+        ThreadPool pool(count);
+        DirectSumSolver solver;
+        BodySystem bodies = reference;
+        solver.computeAccelerations(bodies, pool);
+        CHECK(TestSupport::accelerationError(bodies, reference) < 1e-5);
+        CHECK(netForce(bodies) < 1e-5);
+
+        std::vector<uint32_t> targets;
+        BodySystem some = reference;
+        for (uint32_t i = 0; i < some.size(); i += 7) {
+            targets.push_back(i);
+            some.ax[i] = some.ay[i] = some.az[i] = 0.0f;
+        }
+        solver.computeAccelerationsFor(some, pool, targets);
+        CHECK(TestSupport::accelerationError(some, reference) < 1e-5);
+    }
+}
+
+int main() {
+    tilesMatchRange();
+    solverMatchesRange();
+    return TEST_RESULT();
+}
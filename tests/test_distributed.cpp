@@ -0,0 +1,174 @@
+#include "Distributed.hpp"
+#include "Ranks.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Byte j of the message from one process to another, unique to the round.
+static char patternByte(int round, int from, int to, size_t j) {
+    return static_cast<char>((round * 131 + from * 31 + to * 7 + j) & 0xFF);
+}
+
+static size_t patternSize(int round, int from, int to) {
+    // Some messages are empty, some several times the shm ring.
+    return ((round + from + 2 * to) % 3) * (3u << 20) / 2 + static_cast<size_t>(from);
+}
+
+static int exchangeRank(const std::string& name, const TransportConfig& base, int rank, int size) {
+    TransportConfig config = base;
+    config.rank = rank;
+    std::unique_ptr<Transport> transport = createTransport(config);
+    CHECK(transport != nullptr);
+    if (!transport) return 1;
+    CHECK(std::string(transport->name()) == name);
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::vector<char>> outgoing(size), incoming;
+        for (int to = 0; to < size; ++to) {
+            outgoing[to].resize(patternSize(round, rank, to));
+            for (size_t j = 0; j < outgoing[to].size(); ++j) outgoing[to][j] = patternByte(round, rank, to, j);
+        }
+        CHECK(transport->exchange(outgoing, incoming));
+        CHECK(incoming.size() == static_cast<size_t>(size));
+        for (int from = 0; from < size && from < static_cast<int>(incoming.size()); ++from) {
+            bool same = incoming[from].size() == patternSize(round, from, rank);
+            for (size_t j = 0; same && j < incoming[from].size(); ++j) same = incoming[from][j] == patternByte(round, from, rank, j);
+            CHECK(same);
+        }
+    }
+    std::vector<char> mine(1, static_cast<char>('a' + rank));
+    std::vector<std::vector<char>> all;
+    CHECK(transport->allGather(mine, all));
+    for (int p = 0; p < size && p < static_cast<int>(all.size()); ++p) {
+        CHECK(all[p].size() == 1 && all[p][0] == static_cast<char>('a' + p));
+    }
+    return 0;
+}
+
+static void transportsExchange() {
+    for (const char* name : { "shm", "socket" }) {
+        const TransportConfig config = transportFor(name, 0, 3);
+        CHECK(runRanks(3, [&](int rank) { return exchangeRank(name, config, rank, 3); }));
+    }
+}
+
+// Runs the system on size processes and leaves the gathered result in out
+// (rank 0 only; the other ranks just check that every step succeeded).
+static int simulateRank(const TransportConfig& base, int rank, const BodySystem& input, const IntegratorConfig& integrator,
+                        unsigned steps, BodySystem& out) {
+    TransportConfig config = base;
+    config.rank = rank;
+    std::unique_ptr<Transport> transport = createTransport(config);
+    if (!transport) return 1;
+    DistributedWorld world(*transport, 1);
+    SolverConfig solver;
+    solver.theta = 0.0f;
+    solver.softening = "plummer";
+    solver.softeningLength = 1e-3f;
+    if (!world.setSolver(solver) || !world.setIntegrator(integrator)) return 1;
+    // Cut the curve again every few steps, whatever the measured times.
+    world.rebalanceInterval = 5;
+    world.imbalanceTolerance = -1.0f;
+    BodySystem empty;
+    if (!world.distribute(rank == 0 ? input : empty)) return 1;
+    for (unsigned s = 0; s < steps; ++s) {
+        if (!world.step()) return 1;
+    }
+    CHECK(world.rebalances > 0);
+    return world.gather(out) ? 0 : 1;
+}
+
+static double positionDifference(const BodySystem& a, const BodySystem& b) {
+    double error = 0.0, norm = 0.0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        const double dx = a.x[i] - b.x[i], dy = a.y[i] - b.y[i], dz = a.z[i] - b.z[i];
+        error += dx * dx + dy * dy + dz * dz;
+        norm += static_cast<double>(b.x[i]) * b.x[i] + static_cast<double>(b.y[i]) * b.y[i] +
+                static_cast<double>(b.z[i]) * b.z[i];
+    }
+    return norm > 0.0 ? std::sqrt(error / norm) : std::sqrt(error);
+}
+
+// theta 0 ships every body, so the split run is the direct sum on the
+// whole system up to the order of the additions.
+static void ranksAgreeAtThetaZero() {
+    BodySystem input;
+    TestSupport::plummer(300, 11, input);
+    IntegratorConfig integrator;
+    integrator.name = "leapfrog";
+    for (const char* name : { "shm", "socket" }) {
+        BodySystem single, split;
+        const TransportConfig one = transportFor(name, 0, 1);
+        CHECK(runRanks(1, [&](int rank) { return simulateRank(one, rank, input, integrator, 20, single); }));
+        const TransportConfig three = transportFor(name, 0, 3);
+        CHECK(runRanks(3, [&](int rank) { return simulateRank(three, rank, input, integrator, 20, split); }));
+        CHECK(single.size() == input.size() && split.size() == input.size());
+        if (single.size() != split.size()) continue;
+        CHECK(positionDifference(split, single) < 1e-5);
+        double moved = positionDifference(single, input);
+        CHECK(moved > 1e-4);
+    }
+}
+
+static int refuseRank(const TransportConfig& base, int rank, const BodySystem& input) {
+    TransportConfig config = base;
+    config.rank = rank;
+    std::unique_ptr<Transport> transport = createTransport(config);
+    if (!transport) return 1;
+    DistributedWorld world(*transport, 1);
+    BodySystem empty;
+    // Every rank has to refuse, not only the one that would be empty.
+    return world.distribute(rank == 0 ? input : empty) ? 1 : 0;
+}
+
+static void rejectsMoreRanksThanBodies() {
+    BodySystem input;
+    input.add(0, 0, 0, 0, 0, 0, 1e22f, 1.0f);
+    input.add(10, 0, 0, 0, 0, 0, 1e22f, 1.0f);
+    const TransportConfig config = transportFor("shm", 0, 3);
+    CHECK(runRanks(3, [&](int rank) { return refuseRank(config, rank, input); }));
+}
+
+static int emptyRank(const TransportConfig& base, int rank, const BodySystem& input, BodySystem& out) {
+    TransportConfig config = base;
+    config.rank = rank;
+    std::unique_ptr<Transport> transport = createTransport(config);
+    if (!transport) return 1;
+    DistributedWorld world(*transport, 1);
+    SolverConfig solver;
+    solver.softening = "plummer";
+    solver.softeningLength = 1.0f;
+    IntegratorConfig integrator;
+    integrator.name = "leapfrog";
+    if (!world.setSolver(solver) || !world.setIntegrator(integrator)) return 1;
+    world.rebalanceInterval = 0;
+    BodySystem empty;
+    if (!world.distribute(rank == 0 ? input : empty)) return 1;
+    if (rank == 0) CHECK(world.bodies.empty());
+    for (int s = 0; s < 5; ++s) {
+        if (!world.step()) return 1;
+    }
+    return world.gather(out) ? 0 : 1;
+}
+
+// Coincident bodies share one Morton key, so the decomposition leaves
+// every body on the last rank; the empty rank must still take part in
+// every force evaluation of the leapfrog step.
+static void emptyRankKeepsStepping() {
+    BodySystem input;
+    for (int i = 0; i < 4; ++i) input.add(0, 0, 0, static_cast<float>(i), 0, 0, 1e22f, 1.0f);
+    const TransportConfig config = transportFor("shm", 0, 2);
+    BodySystem out;
+    CHECK(runRanks(2, [&](int rank) { return emptyRank(config, rank, input, out); }));
+    CHECK(out.size() == input.size());
+}
+
+int main() {
+    transportsExchange();
+    ranksAgreeAtThetaZero();
+    rejectsMoreRanksThanBodies();
+    emptyRankKeepsStepping();
+    return TEST_RESULT();
+}
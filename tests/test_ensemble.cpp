@@ -0,0 +1,182 @@
+#include "Ensemble.hpp"
+#include "Integrator.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <string>
+
+static void planetary(BodySystem& bodies) {
+    ThreadPool pool(1);
+    ScenarioConfig config;
+    config.name = "planetary";
+    config.bodyCount = 9;
+    config.seed = 3;
+    Scenarios::generate(config, bodies, pool);
+}
+
+// RMS position difference over the RMS distance from the origin.
+static double positionError(const BodySystem& bodies, const BodySystem& reference) {
+    double error = 0.0, norm = 0.0;
+    for (size_t i = 0; i < reference.size(); ++i) {
+        const double dx = bodies.x[i] - reference.x[i], dy = bodies.y[i] - reference.y[i], dz = bodies.z[i] - reference.z[i];
+        error += dx * dx + dy * dy + dz * dz;
+        norm += static_cast<double>(reference.x[i]) * reference.x[i] + static_cast<double>(reference.y[i]) * reference.y[i] +
+                static_cast<double>(reference.z[i]) * reference.z[i];
+    }
+    return std::sqrt(error / norm);
+}
+
+// The unperturbed member follows a standalone leapfrog run of the same
+// system, and every kernel steps the lanes alike.
+static void laneZeroMatchesLeapfrog() {
+    const float dt = 0.02f; // the innermost orbit takes about 6 s
+    BodySystem base, standalone;
+    planetary(base);
+    standalone = base;
+    IntegratorConfig integratorConfig;
+    integratorConfig.name = "leapfrog";
+    integratorConfig.timeStep = dt;
+    std::unique_ptr<Integrator> integrator = createIntegrator(integratorConfig);
+    ThreadPool pool(1);
+    DirectSumSolver solver(DirectKernels::Isa::Scalar);
+    for (int s = 0; s < 300; ++s) integrator->step(standalone, solver, pool, []() {});
+    CHECK(positionError(standalone, base) > 1e-2);
+
+    const char* kernels[] = { "scalar", "avx2", "avx512" };
+    BodySystem scalarMember;
+    for (const char* kernel : kernels) {
+        Ensemble ensemble(2);
+        EnsembleConfig config;
+        config.members = 40;
+        config.timeStep = dt;
+        config.kernel = kernel;
+        CHECK(ensemble.configure(config));
+        ensemble.populate(base);
+        for (int s = 0; s < 300; ++s) ensemble.step();
+        CHECK(ensemble.stepCount == 300);
+        BodySystem lane;
+        ensemble.member(0, lane);
+        CHECK(positionError(lane, standalone) < 1e-4);
+        // A perturbed member drifts off, but every kernel steps it alike.
+        BodySystem member;
+        ensemble.member(37, member);
+        CHECK(positionError(member, standalone) > 1e-5);
+        if (std::string(kernel) == "scalar") scalarMember = member;
+        else CHECK(positionError(member, scalarMember) < 1e-4);
+    }
+}
+
+// A member's perturbation depends only on the seed and its number, not on
+// how many members run beside it or on the thread count.
+static void membersIndependentOfLayout() {
+    BodySystem base;
+    planetary(base);
+    BodySystem small, large;
+    {
+        Ensemble ensemble(1);
+        EnsembleConfig config;
+        config.members = 10;
+        config.timeStep = 0.02f;
+        CHECK(ensemble.configure(config));
+        ensemble.populate(base);
+        for (int s = 0; s < 50; ++s) ensemble.step();
+        ensemble.member(9, small);
+    }
+    {
+        Ensemble ensemble(3);
+        EnsembleConfig config;
+        config.members = 70;
+        config.timeStep = 0.02f;
+        CHECK(ensemble.configure(config));
+        ensemble.populate(base);
+        for (int s = 0; s < 50; ++s) ensemble.step();
+        ensemble.member(9, large);
+    }
+    bool same = small.size() == large.size();
+    for (size_t i = 0; same && i < small.size(); ++i) same = small.x[i] == large.x[i] && small.vz[i] == large.vz[i];
+    CHECK(same);
+}
+
+static void summaryTracksEnergy() {
+    BodySystem base;
+    planetary(base);
+    Ensemble ensemble(1);
+    EnsembleConfig config;
+    config.members = 17;
+    config.timeStep = 0.02f;
+    CHECK(ensemble.configure(config));
+    ensemble.populate(base);
+    for (int s = 0; s < 100; ++s) ensemble.step();
+    std::vector<MemberSummary> summaries;
+    ensemble.summarize(summaries);
+    CHECK(summaries.size() == 17);
+    bool bounded = true;
+    for (const MemberSummary& s : summaries) {
+        bounded = bounded && std::fabs((s.finalEnergy - s.initialEnergy) / s.initialEnergy) < 1e-2 && s.closestApproach > 1.0f;
+    }
+    CHECK(bounded);
+
+    EnsembleConfig bad = config;
+    bad.members = 0;
+    CHECK(!ensemble.configure(bad));
+    bad = config;
+    bad.kernel = "neon";
+    CHECK(!ensemble.configure(bad));
+}
+
+// Two bodies that start overlapping and fly apart never overlap after a step.
+static void initialOverlapNotCounted() {
+    BodySystem base;
+    base.resize(2);
+    base.mass[0] = base.mass[1] = 1.0f;
+    base.radius[0] = base.radius[1] = 1.0f;
+    base.x[1] = 1.0f;
+    base.vx[0] = -10.0f;
+    base.vx[1] = 10.0f;
+    Ensemble ensemble(1);
+    EnsembleConfig config;
+    config.members = 1;
+    config.timeStep = 1.0f;
+    CHECK(ensemble.configure(config));
+    ensemble.populate(base);
+    ensemble.step();
+    std::vector<MemberSummary> summaries;
+    ensemble.summarize(summaries);
+    CHECK_NEAR(summaries[0].closestApproach, 10.5, 1e-3);
+}
+
+// A pair closer than the softening length is bound under 1/r but not under
+// the softened potential the energy columns use.
+static void unboundUsesSoftening() {
+    const double m = 1e22, r = 1.0;
+    const float v = static_cast<float>(std::sqrt(Constants::G_UNITS * m / r));
+    BodySystem base;
+    base.resize(2);
+    base.mass[0] = base.mass[1] = static_cast<float>(m);
+    base.radius[0] = base.radius[1] = 0.1f;
+    base.x[1] = static_cast<float>(r);
+    base.vy[0] = -v;
+    base.vy[1] = v;
+    const char* laws[] = { "none", "plummer", "spline" };
+    for (const char* law : laws) {
+        Ensemble ensemble(1);
+        EnsembleConfig config;
+        config.members = 1;
+        config.softening = law;
+        config.softeningLength = 10.0f;
+        CHECK(ensemble.configure(config));
+        ensemble.populate(base);
+        std::vector<MemberSummary> summaries;
+        ensemble.summarize(summaries);
+        CHECK(summaries[0].unbound == (std::string(law) == "none" ? 0u : 2u));
+    }
+}
+
+int main() {
+    laneZeroMatchesLeapfrog();
+    membersIndependentOfLayout();
+    summaryTracksEnergy();
+    initialOverlapNotCounted();
+    unboundUsesSoftening();
+    return TEST_RESULT();
+}
@@ -0,0 +1,47 @@
+#include "FastMultipole.hpp"
+#include "TestSupport.hpp"
+
+// Error against the direct sum for one order and opening angle.
+static double fmmError(const BodySystem& reference, int order, float theta, ThreadPool& pool) {
+    BodySystem bodies = reference;
+    FmmSolver solver(order, theta);
+    solver.computeAccelerations(bodies, pool);
+    return TestSupport::accelerationError(bodies, reference);
+}
+
+// The error stays within bounds and falls with the expansion order.
+static void errorBoundedByOrder() {
+    ThreadPool pool(2);
+    BodySystem reference;
+    TestSupport::plummer(4000, 21, reference);
+    DirectKernels::computeRange(DirectKernels::Isa::Scalar, DirectKernels::Softening(), reference, 0, reference.size());
+
+    const int orders[] = { 2, 4, 6 };
+    const double bounds[] = { 5e-3, 5e-4, 1e-4 };
+    double previous = 1.0;
+    for (int k = 0; k < 3; ++k) {
+        const double error = fmmError(reference, orders[k], 0.5f, pool);
+        CHECK(error < bounds[k]);
+        CHECK(error < previous);
+        previous = error;
+    }
+    CHECK(fmmError(reference, 4, 0.3f, pool) < fmmError(reference, 4, 0.7f, pool));
+}
+
+// Tasks are split by target cell, so the worker count only changes the
+// order of the additions.
+static void sameForAnyWorkerCount() {
+    BodySystem a, b;
+    TestSupport::plummer(2000, 4, a);
+    b = a;
+    ThreadPool one(1), four(4);
+    FmmSolver(4, 0.5f).computeAccelerations(a, one);
+    FmmSolver(4, 0.5f).computeAccelerations(b, four);
+    CHECK(TestSupport::accelerationError(b, a) < 1e-6);
+}
+
+int main() {
+    errorBoundedByOrder();
+    sameForAnyWorkerCount();
+    return TEST_RESULT();
+}
@@ -0,0 +1,87 @@
+#include "GridMesh.hpp"
+#include "GridWarp.hpp"
+#include "TestSupport.hpp"
+#include "constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+// RMS difference over the RMS of reference.
+static double relativeError(const std::vector<float>& values, const std::vector<double>& reference) {
+    double error = 0.0, norm = 0.0;
+    for (size_t v = 0; v < reference.size(); ++v) {
+        error += (values[v] - reference[v]) * (values[v] - reference[v]);
+        norm += reference[v] * reference[v];
+    }
+    return std::sqrt(error / norm);
+}
+
+// Refined around a few hundred sources; the warp with theta 0 is the exact
+// sum for every kernel, and theta 0.5 stays close to it.
+static void warpMatchesExactSum() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> position(-8000.0f, 8000.0f), size(1e3f, 1e5f);
+    std::vector<WarpSource> sources;
+    std::vector<GridAnchor> anchors;
+    for (int s = 0; s < 300; ++s) {
+        WarpSource source;
+        source.x = position(rng);
+        source.z = position(rng);
+        source.rs = size(rng);
+        source.strength = 1e3f * size(rng);
+        sources.push_back(source);
+        if (s % 30 == 0) anchors.push_back({ source.x, source.z });
+    }
+    GridMesh mesh;
+    mesh.build(20000.0f, 64, 3, 2.0f, anchors);
+    CHECK(mesh.vertexCount() > 65 * 65);
+
+    std::vector<double> exact(mesh.vertexCount(), 0.0);
+    for (size_t v = 0; v < mesh.vertexCount(); ++v) {
+        for (const WarpSource& source : sources) {
+            const double dx = source.x - mesh.x[v], dz = source.z - mesh.z[v];
+            const double d = std::max(std::sqrt(dx * dx + dz * dz), 1.0);
+            if (d > source.rs * Constants::UNITS_PER_METER) exact[v] -= source.strength * Constants::UNITS_PER_METER / d;
+        }
+    }
+
+    ThreadPool pool(2);
+    std::vector<float> displacement(mesh.vertexCount());
+    const DirectKernels::Isa isas[] = { DirectKernels::Isa::Scalar, DirectKernels::Isa::Avx2, DirectKernels::Isa::Avx512 };
+    for (DirectKernels::Isa isa : isas) {
+        GridWarper warper(0.0f, isa);
+        warper.setSources(sources);
+        warper.evaluate(mesh.x.data(), mesh.z.data(), mesh.vertexCount(), displacement.data(), pool);
+        CHECK(relativeError(displacement, exact) < 1e-5);
+    }
+    GridWarper approximate(0.5f);
+    approximate.setSources(sources);
+    approximate.evaluate(mesh.x.data(), mesh.z.data(), mesh.vertexCount(), displacement.data(), pool);
+    CHECK(relativeError(displacement, exact) < 1e-2);
+}
+
+// Every segment joins two existing vertices and none is drawn twice.
+static void meshHasNoDuplicateSegments() {
+    GridMesh mesh;
+    mesh.build(1000.0f, 16, 4, 1.5f, { { 0.0f, 0.0f }, { 300.0f, -200.0f } });
+    CHECK(mesh.lines.size() % 2 == 0);
+    std::set<std::pair<uint32_t, uint32_t>> segments;
+    bool inRange = true;
+    for (size_t k = 0; k + 1 < mesh.lines.size(); k += 2) {
+        const uint32_t a = mesh.lines[k], b = mesh.lines[k + 1];
+        inRange = inRange && a < mesh.vertexCount() && b < mesh.vertexCount() && a != b;
+        segments.insert(std::make_pair(std::min(a, b), std::max(a, b)));
+    }
+    CHECK(inRange);
+    CHECK(segments.size() * 2 == mesh.lines.size());
+}
+
+int main() {
+    warpMatchesExactSum();
+    meshHasNoDuplicateSegments();
+    return TEST_RESULT();
+}
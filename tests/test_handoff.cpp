@@ -0,0 +1,128 @@
+#include "PhysicsThread.hpp"
+#include "SpscQueue.hpp"
+#include "TestSupport.hpp"
+#include "TripleBuffer.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+// Everything pushed comes out once and in order, with the queue running
+// full and empty many times over.
+static void queueKeepsOrder() {
+    const uint64_t count = 200000;
+    SpscQueue<uint64_t, 64> queue;
+    std::thread producer([&]() {
+        for (uint64_t v = 1; v <= count; ++v) {
+            while (!queue.push(v)) std::this_thread::yield();
+        }
+    });
+    uint64_t expected = 1;
+    bool ordered = true;
+    while (expected <= count) {
+        uint64_t v = 0;
+        if (!queue.pop(v)) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && v == expected;
+        ++expected;
+    }
+    producer.join();
+    CHECK(ordered);
+    uint64_t extra = 0;
+    CHECK(!queue.pop(extra));
+}
+
+struct Frame {
+    uint64_t sequence = 0;
+    uint64_t payload[32] = {};
+};
+
+// The reader only ever sees whole frames, newer on every acquire, and the
+// last one published.
+static void tripleBufferHandsOverWholeFrames() {
+    const uint64_t count = 100000;
+    TripleBuffer<Frame> buffer;
+    std::thread writer([&]() {
+        for (uint64_t s = 1; s <= count; ++s) {
+            Frame& frame = buffer.back();
+            frame.sequence = s;
+            for (uint64_t& word : frame.payload) word = s * 3;
+            buffer.publish();
+            if (s % 64 == 0) std::this_thread::yield();
+        }
+    });
+    uint64_t last = 0;
+    bool whole = true, newer = true;
+    while (last < count) {
+        if (!buffer.acquire()) {
+            std::this_thread::yield();
+            continue;
+        }
+        const Frame& frame = buffer.front();
+        for (uint64_t word : frame.payload) whole = whole && word == frame.sequence * 3;
+        newer = newer && frame.sequence > last;
+        last = frame.sequence;
+    }
+    writer.join();
+    CHECK(whole);
+    CHECK(newer);
+    CHECK(!buffer.acquire());
+    CHECK(buffer.front().sequence == count);
+}
+
+// Polls snapshots for up to five seconds until done() holds for one.
+static bool waitFor(PhysicsThread& physics, const std::function<bool(const BodySnapshot&)>& done) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (std::chrono::steady_clock::now() < deadline) {
+        if (physics.acquireSnapshot() && done(physics.snapshot())) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return false;
+}
+
+// Commands sent from the owner arrive in order between ticks, and the
+// snapshots that come back reflect them.
+static void physicsThreadAppliesCommands() {
+    PhysicsThread physics(1000.0, 1);
+    physics.start();
+    SlotHandle first, second;
+    first.index = 0; first.generation = 1;
+    second.index = 1; second.generation = 1;
+    PhysicsCommand add;
+    add.type = PhysicsCommand::Type::AddBody;
+    add.mass = 1e22f;
+    add.radius = 1.0f;
+    add.id = first;
+    add.x = -500.0f;
+    CHECK(physics.send(add));
+    add.id = second;
+    add.x = 500.0f;
+    CHECK(physics.send(add));
+    PhysicsCommand resume;
+    resume.type = PhysicsCommand::Type::SetPaused;
+    resume.paused = false;
+    CHECK(physics.send(resume));
+    CHECK(waitFor(physics, [](const BodySnapshot& s) { return s.commandsApplied == 3 && s.stepCount >= 5; }));
+    const BodySnapshot& running = physics.snapshot();
+    CHECK(!running.paused && running.ids.size() == 2);
+    // They fall towards each other.
+    CHECK(running.ids.size() == 2 && running.x[running.ids[0] == first ? 0 : 1] > -500.0f);
+
+    PhysicsCommand remove;
+    remove.type = PhysicsCommand::Type::RemoveBody;
+    remove.id = first;
+    CHECK(physics.send(remove));
+    CHECK(waitFor(physics, [](const BodySnapshot& s) { return s.commandsApplied == 4; }));
+    CHECK(physics.snapshot().ids.size() == 1 && physics.snapshot().ids[0] == second);
+    physics.stop();
+}
+
+int main() {
+    queueKeepsOrder();
+    tripleBufferHandsOverWholeFrames();
+    physicsThreadAppliesCommands();
+    return TEST_RESULT();
+}
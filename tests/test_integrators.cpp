@@ -0,0 +1,117 @@
+#include "Integrator.hpp"
+#include "Physics.hpp"
+#include "TestSupport.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+
+// A light body at distance 1000 from a heavy one, moving sideways at
+// speedFactor times the circular speed, and optionally a third, light body
+// on a circular orbit far out. Returns the period of the inner orbit.
+static double orbit(BodySystem& bodies, float speedFactor, bool withOuter) {
+    const float heavy = 1e24f, radius = 1000.0f;
+    const double gm = static_cast<double>(Constants::G_UNITS) * heavy;
+    const float speed = speedFactor * static_cast<float>(std::sqrt(gm / radius));
+    bodies.clear();
+    bodies.add(0, 0, 0, 0, 0, 0, heavy, 10.0f);
+    bodies.add(radius, 0, 0, 0, speed, 0, 1e18f, 1.0f);
+    if (withOuter) {
+        const float far = 20.0f * radius;
+        bodies.add(-far, 0, 0, 0, -static_cast<float>(std::sqrt(gm / far)), 0, 1e18f, 1.0f);
+    }
+    const double semiMajor = 1.0 / (2.0 / radius - static_cast<double>(speed) * speed / gm);
+    return 2.0 * M_PI * std::sqrt(semiMajor * semiMajor * semiMajor / gm);
+}
+
+static std::unique_ptr<Integrator> makeIntegrator(const std::string& name, double timeStep, int blockLevels = 0) {
+    IntegratorConfig config;
+    config.name = name;
+    config.timeStep = static_cast<float>(timeStep);
+    config.blockLevels = blockLevels;
+    std::unique_ptr<Integrator> integrator = createIntegrator(config);
+    CHECK(integrator != nullptr);
+    return integrator;
+}
+
+static void run(Integrator& integrator, BodySystem& bodies, int frames, ThreadPool& pool) {
+    DirectSumSolver solver(DirectKernels::Isa::Scalar);
+    for (int f = 0; f < frames; ++f) integrator.step(bodies, solver, pool, []() {});
+}
+
+// The symplectic integrators keep the energy of an eccentric orbit within
+// a bound over five periods, the fourth-order one far tighter.
+static void symplecticKeepEnergy() {
+    ThreadPool pool(1);
+    const char* names[] = { "leapfrog", "verlet", "yoshida4" };
+    double worst[3];
+    for (int k = 0; k < 3; ++k) {
+        BodySystem bodies;
+        const double period = orbit(bodies, 0.7f, false);
+        const double before = Physics::totalEnergy(bodies);
+        std::unique_ptr<Integrator> integrator = makeIntegrator(names[k], period / 400.0);
+        if (!integrator) return;
+        worst[k] = 0.0;
+        for (int f = 0; f < 2000; ++f) {
+            run(*integrator, bodies, 1, pool);
+            worst[k] = std::max(worst[k], std::fabs((Physics::totalEnergy(bodies) - before) / before));
+        }
+        CHECK(worst[k] < 2e-3);
+    }
+    CHECK(worst[2] < 0.1 * worst[0]);
+}
+
+// The inner body climbs to a finer level while the outer one stays on the
+// frame step, and the orbit follows plain leapfrog at the finest step.
+static void blockStepsFollowFineLeapfrog() {
+    ThreadPool pool(1);
+    BodySystem block, fine;
+    const double period = orbit(block, 1.0f, true);
+    orbit(fine, 1.0f, true);
+    const double frame = period / 20.0;
+    std::unique_ptr<Integrator> blockIntegrator = makeIntegrator("leapfrog", frame, 4);
+    std::unique_ptr<Integrator> fineIntegrator = makeIntegrator("leapfrog", frame / 16.0);
+    if (!blockIntegrator || !fineIntegrator) return;
+    run(*blockIntegrator, block, 40, pool);
+    run(*fineIntegrator, fine, 40 * 16, pool);
+
+    const LeapfrogIntegrator& leapfrog = static_cast<const LeapfrogIntegrator&>(*blockIntegrator);
+    const std::vector<size_t> histogram = leapfrog.levelHistogram();
+    CHECK(histogram.size() == 5 && histogram[0] >= 1 && histogram[4] >= 1);
+    // The outer body saves most of its evaluations.
+    CHECK(blockIntegrator->bodyEvaluations < fineIntegrator->bodyEvaluations * 3 / 4);
+    const double dx = block.x[1] - fine.x[1], dy = block.y[1] - fine.y[1];
+    CHECK(std::sqrt(dx * dx + dy * dy) < 5.0);
+}
+
+// A restored integrator continues bit for bit where the saved one was.
+static void stateRestoresExactly() {
+    ThreadPool pool(1);
+    BodySystem bodies;
+    const double period = orbit(bodies, 1.0f, true);
+    std::unique_ptr<Integrator> original = makeIntegrator("leapfrog", period / 20.0, 4);
+    std::unique_ptr<Integrator> restored = makeIntegrator("leapfrog", period / 20.0, 4);
+    if (!original || !restored) return;
+    run(*original, bodies, 7, pool);
+    IntegratorState state;
+    original->saveState(state);
+    BodySystem copy = bodies;
+    CHECK(restored->restoreState(state, copy.size()));
+    CHECK(!restored->restoreState(state, copy.size() + 1));
+    CHECK(restored->restoreState(state, copy.size()));
+    run(*original, bodies, 9, pool);
+    run(*restored, copy, 9, pool);
+    bool same = true;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        same = same && bodies.x[i] == copy.x[i] && bodies.y[i] == copy.y[i] && bodies.vx[i] == copy.vx[i] &&
+               bodies.vy[i] == copy.vy[i];
+    }
+    CHECK(same);
+}
+
+int main() {
+    symplecticKeepEnergy();
+    blockStepsFollowFineLeapfrog();
+    stateRestoresExactly();
+    return TEST_RESULT();
+}
@@ -0,0 +1,49 @@
+#include "DirectKernels.hpp"
+#include "TestSupport.hpp"
+
+#include <string>
+
+static void rangeIn(DirectKernels::Isa isa, const DirectKernels::Softening& softening, BodySystem& bodies) {
+    // Uneven cuts leave masked tails for every vector width.
+    const size_t cuts[] = { 0, 7, 300, 517, bodies.size() };
+    for (int k = 0; k + 1 < 5; ++k) DirectKernels::computeRange(isa, softening, bodies, cuts[k], cuts[k + 1]);
+}
+
+// Every SIMD kernel agrees with the scalar one for every softening law.
+static void simdMatchesScalar() {
+    BodySystem base;
+    TestSupport::plummer(1003, 3, base);
+    const DirectKernels::SofteningLaw laws[] = { DirectKernels::SofteningLaw::None, DirectKernels::SofteningLaw::Plummer,
+                                                 DirectKernels::SofteningLaw::Spline };
+    const DirectKernels::Isa isas[] = { DirectKernels::Isa::Avx2, DirectKernels::Isa::Avx512 };
+    for (DirectKernels::SofteningLaw law : laws) {
+        DirectKernels::Softening softening;
+        softening.law = law;
+        softening.length = law == DirectKernels::SofteningLaw::None ? 0.0f : 200.0f;
+        BodySystem reference = base;
+        rangeIn(DirectKernels::Isa::Scalar, softening, reference);
+        for (DirectKernels::Isa isa : isas) {
+            BodySystem bodies = base;
+            rangeIn(isa, softening, bodies);
+            const double error = TestSupport::accelerationError(bodies, reference);
+            if (!(error < 1e-5)) {
+                std::cerr << DirectKernels::isaName(isa) << " / " << DirectKernels::softeningName(law) << ": " << error << std::endl;
+            }
+            CHECK(error < 1e-5);
+        }
+    }
+}
+
+static void parsesKernelNames() {
+    DirectKernels::Isa isa;
+    CHECK(DirectKernels::parseIsa("avx2", isa) && isa == DirectKernels::Isa::Avx2);
+    CHECK(DirectKernels::parseIsa("auto", isa) && isa == DirectKernels::detectIsa());
+    CHECK(!DirectKernels::parseIsa("sse9", isa));
+    CHECK(std::string(DirectKernels::isaName(DirectKernels::Isa::Scalar)) == "scalar");
+}
+
+int main() {
+    simdMatchesScalar();
+    parsesKernelNames();
+    return TEST_RESULT();
+}
@@ -0,0 +1,86 @@
+#include "Precision.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <string>
+
+// The float and double policies give the same one-sided sum as the scalar
+// kernel.
+static void rowsMatchScalarKernel() {
+    BodySystem reference;
+    TestSupport::plummer(700, 12, reference);
+    DirectKernels::computeRange(DirectKernels::Isa::Scalar, DirectKernels::Softening(), reference, 0, reference.size());
+    const size_t n = reference.size();
+
+    BodySystem single = reference;
+    PrecisionKernels::accumulateRows<FloatPrecision>(single.x.data(), single.y.data(), single.z.data(), single.mass.data(),
+                                                     n, 0, n, single.ax.data(), single.ay.data(), single.az.data());
+    CHECK(TestSupport::accelerationError(single, reference) < 1e-5);
+
+    AlignedVector<double> x(reference.x.begin(), reference.x.end()), y(reference.y.begin(), reference.y.end()),
+        z(reference.z.begin(), reference.z.end());
+    BodySystem wide = reference;
+    PrecisionKernels::accumulateRows<DoublePrecision>(x.data(), y.data(), z.data(), wide.mass.data(), n, 0, n,
+                                                      wide.ax.data(), wide.ay.data(), wide.az.data());
+    CHECK(TestSupport::accelerationError(wide, reference) < 1e-5);
+}
+
+// A small orbit far from the origin, where a float position only has a few
+// significant bits for the orbit itself. Returns the light body's distance
+// from where the double-precision run puts it after the same steps.
+static double farOrbitError(const std::string& precision, BodySystem* reference) {
+    const float offset = 2e6f, radius = 100.0f, heavy = 1e24f;
+    const float speed = std::sqrt(Constants::G_UNITS * heavy / radius);
+    BodySystem bodies;
+    bodies.add(offset, 0, 0, 0, 0, 0, heavy, 1.0f);
+    bodies.add(offset + radius, 0, 0, 0, speed, 0, 1e16f, 1.0f);
+    IntegratorConfig config;
+    config.name = "leapfrog";
+    config.precision = precision;
+    config.timeStep = static_cast<float>(2.0 * M_PI * radius / speed / 200.0);
+    std::unique_ptr<Integrator> integrator = createIntegrator(config);
+    CHECK(integrator != nullptr);
+    if (!integrator) return 0.0;
+    ThreadPool pool(1);
+    DirectSumSolver solver;
+    for (int s = 0; s < 1000; ++s) integrator->step(bodies, solver, pool, []() {});
+    if (!reference) return 0.0;
+    if (reference->empty()) {
+        *reference = bodies;
+        return 0.0;
+    }
+    const double dx = static_cast<double>(bodies.x[1]) - reference->x[1];
+    const double dy = static_cast<double>(bodies.y[1]) - reference->y[1];
+    return std::sqrt(dx * dx + dy * dy);
+}
+
+// Far from the origin, float positions drift off the orbit; keeping them in
+// double (mixed) or compensating the updates (kahan) stays much closer to
+// the double-precision run.
+static void widerStateTracksDouble() {
+    BodySystem reference;
+    farOrbitError("double", &reference);
+    const double plain = farOrbitError("float", &reference);
+    const double mixed = farOrbitError("mixed", &reference);
+    const double kahan = farOrbitError("kahan", &reference);
+    CHECK(plain > 1.0);
+    CHECK(mixed < 0.01 * plain);
+    CHECK(kahan < 0.01 * plain);
+}
+
+static void rejectsUnknownPrecision() {
+    IntegratorConfig config;
+    config.name = "leapfrog";
+    config.precision = "quad";
+    CHECK(createIntegrator(config) == nullptr);
+    config.precision = "double";
+    config.blockLevels = 2;
+    CHECK(createIntegrator(config) == nullptr);
+}
+
+int main() {
+    rowsMatchScalarKernel();
+    widerStateTracksDouble();
+    rejectsUnknownPrecision();
+    return TEST_RESULT();
+}
@@ -0,0 +1,60 @@
+#include "Profiler.hpp"
+#include "TestSupport.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+
+// Zones are used directly rather than through PROFILE_ZONE, which only
+// records in profiling builds.
+static void statsCoverEveryThread() {
+    auto sleepy = []() {
+        for (int k = 0; k < 5; ++k) {
+            Profiler::Zone zone("test.sleep");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    };
+    std::thread other([&]() {
+        Profiler::setThreadName("test other");
+        sleepy();
+    });
+    sleepy();
+    other.join();
+    const ProfileStats stats = Profiler::stats("test.sleep", 100);
+    CHECK(stats.count == 10);
+    CHECK(stats.p50 >= 2.0 && stats.p50 < 200.0);
+    CHECK(stats.p99 >= stats.p50);
+    CHECK(Profiler::stats("test.never").count == 0);
+}
+
+// The per-thread ring keeps the latest kRingSize events.
+static void ringKeepsLatest() {
+    for (size_t k = 0; k < Profiler::kRingSize + 100; ++k) Profiler::record("test.tick", 0, 1000000);
+    Profiler::record("test.tick", 0, 3000000);
+    const ProfileStats all = Profiler::stats("test.tick", Profiler::kRingSize * 2);
+    CHECK(all.count <= Profiler::kRingSize);
+    const ProfileStats latest = Profiler::stats("test.tick", 1);
+    CHECK(latest.count == 1);
+    CHECK_NEAR(latest.mean, 3.0, 1e-9);
+}
+
+static void writesChromeTrace() {
+    const std::string path = "test_profiler_trace.json";
+    CHECK(Profiler::writeChromeTrace(path));
+    std::ifstream in(path);
+    const std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    std::remove(path.c_str());
+    CHECK(json.find("test.sleep") != std::string::npos);
+    CHECK(json.find("test other") != std::string::npos);
+    CHECK(!Profiler::writeChromeTrace("/nonexistent-directory/trace.json"));
+}
+
+int main() {
+    statsCoverEveryThread();
+    ringKeepsLatest();
+    writesChromeTrace();
+    return TEST_RESULT();
+}
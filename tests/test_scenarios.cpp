@@ -0,0 +1,85 @@
+#include "Physics.hpp"
+#include "Scenarios.hpp"
+#include "TestSupport.hpp"
+
+#include <cmath>
+#include <string>
+
+static bool identical(const BodySystem& a, const BodySystem& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.x[i] != b.x[i] || a.y[i] != b.y[i] || a.z[i] != b.z[i] || a.vx[i] != b.vx[i] || a.vy[i] != b.vy[i] ||
+            a.vz[i] != b.vz[i] || a.mass[i] != b.mass[i] || a.radius[i] != b.radius[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Every scenario has the asked body count and total mass, finite values,
+// and does not depend on the thread count; another seed changes it.
+static void scenariosAreDeterministic() {
+    const char* names[] = { "plummer", "disk", "cube", "clusters", "planetary" };
+    ThreadPool one(1), three(3);
+    for (const char* name : names) {
+        ScenarioConfig config;
+        config.name = name;
+        config.bodyCount = 10001; // more than two generation blocks, the last one partial
+        config.seed = 99;
+        BodySystem serial, parallel, reseeded;
+        CHECK(Scenarios::generate(config, serial, one));
+        CHECK(Scenarios::generate(config, parallel, three));
+        config.seed = 100;
+        CHECK(Scenarios::generate(config, reseeded, three));
+        CHECK(serial.size() == config.bodyCount);
+        CHECK(identical(serial, parallel));
+        CHECK(!identical(serial, reseeded));
+
+        double mass = 0.0;
+        bool finite = true;
+        for (size_t i = 0; i < serial.size(); ++i) {
+            mass += serial.mass[i];
+            finite = finite && std::isfinite(serial.x[i]) && std::isfinite(serial.vx[i]) && serial.mass[i] > 0.0f &&
+                     serial.radius[i] > 0.0f;
+        }
+        CHECK(finite);
+        CHECK_NEAR(mass / config.totalMass, 1.0, 1e-3);
+    }
+}
+
+// A Plummer sphere starts in virial equilibrium: 2T + W close to zero.
+static void plummerIsVirialised() {
+    ThreadPool pool(2);
+    ScenarioConfig config;
+    config.name = "plummer";
+    config.bodyCount = 4000;
+    BodySystem bodies;
+    CHECK(Scenarios::generate(config, bodies, pool));
+    const double total = Physics::totalEnergy(bodies);
+    double kinetic = 0.0;
+    for (size_t i = 0; i < bodies.size(); ++i) {
+        kinetic += 0.5 * bodies.mass[i] * (static_cast<double>(bodies.vx[i]) * bodies.vx[i] +
+                                           static_cast<double>(bodies.vy[i]) * bodies.vy[i] +
+                                           static_cast<double>(bodies.vz[i]) * bodies.vz[i]);
+    }
+    const double potential = total - kinetic;
+    CHECK(potential < 0.0);
+    CHECK_NEAR(2.0 * kinetic / -potential, 1.0, 0.1);
+}
+
+static void rejectsUnknownScenario() {
+    ThreadPool pool(1);
+    ScenarioConfig config;
+    config.name = "torus";
+    BodySystem bodies;
+    bodies.add(1, 0, 0, 0, 0, 0, 1.0f, 1.0f);
+    CHECK(!Scenarios::generate(config, bodies, pool));
+    CHECK(bodies.size() == 1);
+}
+
+int main() {
+    scenariosAreDeterministic();
+    plummerIsVirialised();
+    rejectsUnknownScenario();
+    return TEST_RESULT();
+}
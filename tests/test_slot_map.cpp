@@ -0,0 +1,77 @@
+#include "SlotMap.hpp"
+#include "TestSupport.hpp"
+
+#include <vector>
+
+// Counts live instances, so erase() and clear() can be seen destroying.
+struct Tracked {
+    static int alive;
+    int value;
+    explicit Tracked(int v) : value(v) { ++alive; }
+    ~Tracked() { --alive; }
+};
+int Tracked::alive = 0;
+
+// A handle to an erased element never resolves again, not even once its
+// slot has been reused.
+static void rejectsStaleGenerations() {
+    SlotMap<Tracked, 4> map;
+    const SlotHandle a = map.insert(1), b = map.insert(2);
+    CHECK(map.contains(a) && map.get(b) && map.get(b)->value == 2);
+    CHECK(map.erase(a));
+    CHECK(!map.contains(a) && map.get(a) == nullptr);
+    CHECK(!map.erase(a));
+    CHECK(Tracked::alive == 1);
+
+    // The parked slot is only reused after compact().
+    const SlotHandle c = map.insert(3);
+    CHECK(c.index != a.index);
+    map.compact();
+    const SlotHandle d = map.insert(4);
+    CHECK(d.index == a.index && d.generation != a.generation);
+    CHECK(map.get(a) == nullptr && map.get(d) && map.get(d)->value == 4);
+    CHECK(!map.contains(SlotHandle()));
+    SlotHandle outside;
+    outside.index = 1000;
+    outside.generation = 1;
+    CHECK(!map.contains(outside));
+}
+
+// Elements never move when pages are added, and after compact() iteration
+// runs in slot order, also when the only change was a reused slot.
+static void keepsAddressesAndOrder() {
+    SlotMap<Tracked, 4> map;
+    std::vector<SlotHandle> handles;
+    for (int k = 0; k < 3; ++k) handles.push_back(map.insert(k));
+    const Tracked* first = map.get(handles[0]);
+    for (int k = 3; k < 40; ++k) handles.push_back(map.insert(k));
+    CHECK(map.get(handles[0]) == first);
+
+    for (int k = 0; k < 40; k += 3) map.erase(handles[k]);
+    map.compact();
+    map.insert(100);
+    map.insert(101);
+    map.compact();
+    uint32_t previous = 0;
+    bool ordered = true, started = false;
+    size_t visited = 0;
+    for (auto it = map.begin(); it != map.end(); ++it) {
+        const uint32_t index = it.handle().index;
+        ordered = ordered && (!started || index > previous);
+        started = true;
+        previous = index;
+        ++visited;
+    }
+    CHECK(ordered);
+    CHECK(visited == map.size() && map.size() == 40 - 14 + 2);
+
+    map.clear();
+    CHECK(map.empty() && Tracked::alive == 0);
+    CHECK(map.get(handles[1]) == nullptr);
+}
+
+int main() {
+    rejectsStaleGenerations();
+    keepsAddressesAndOrder();
+    return TEST_RESULT();
+}
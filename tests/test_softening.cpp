@@ -0,0 +1,80 @@
+#include "ForceSolver.hpp"
+#include "Physics.hpp"
+#include "Softening.hpp"
+#include "TestSupport.hpp"
+#include "constants.hpp"
+
+#include <cmath>
+
+using DirectKernels::SofteningLaw;
+
+// The pair acceleration |a| = G m r f(r) of each law is minus the slope of
+// the potential Physics::totalEnergy uses for it, at distances inside and
+// outside the softening length.
+static void forceIsSlopeOfPotential() {
+    const SofteningLaw laws[] = { SofteningLaw::None, SofteningLaw::Plummer, SofteningLaw::Spline };
+    const float length = 100.0f, mass = 1e22f;
+    for (SofteningLaw law : laws) {
+        DirectKernels::Softening softening;
+        softening.law = law;
+        softening.length = law == SofteningLaw::None ? 0.0f : length;
+        const DirectKernels::SofteningCoefficients c(softening);
+        const float distances[] = { 20.0f, 60.0f, 140.0f, 250.0f, 400.0f };
+        for (float r : distances) {
+            const float h = 0.5f;
+            double energy[2];
+            for (int side = 0; side < 2; ++side) {
+                BodySystem pair;
+                pair.add(0, 0, 0, 0, 0, 0, mass, 1.0f);
+                pair.add(r + (side == 0 ? -h : h), 0, 0, 0, 0, 0, mass, 1.0f);
+                energy[side] = Physics::totalEnergy(pair, softening);
+            }
+            const double slope = (energy[1] - energy[0]) / (2.0 * h) / mass;
+            float f = 0.0f;
+            switch (law) {
+                case SofteningLaw::None: f = DirectKernels::ScalarLaw<SofteningLaw::None>::invCube(r * r, c); break;
+                case SofteningLaw::Plummer: f = DirectKernels::ScalarLaw<SofteningLaw::Plummer>::invCube(r * r, c); break;
+                case SofteningLaw::Spline: f = DirectKernels::ScalarLaw<SofteningLaw::Spline>::invCube(r * r, c); break;
+            }
+            const double acceleration = static_cast<double>(Constants::G_UNITS) * mass * r * f;
+            CHECK_NEAR(slope / acceleration, 1.0, 2e-3);
+        }
+    }
+}
+
+// The spline is continuous where its pieces meet, Newtonian from
+// 2.8 eps on, and finite at zero distance.
+static void splineJoinsNewton() {
+    DirectKernels::Softening softening;
+    softening.law = SofteningLaw::Spline;
+    softening.length = 10.0f;
+    const DirectKernels::SofteningCoefficients c(softening);
+    typedef DirectKernels::ScalarLaw<SofteningLaw::Spline> Spline;
+    const float h = DirectKernels::SofteningCoefficients::kSplineSupport * softening.length;
+    for (float u : { 0.5f, 1.0f }) {
+        const float below = u * h * (1.0f - 1e-4f), above = u * h * (1.0f + 1e-4f);
+        CHECK_NEAR(Spline::invCube(below * below, c) / Spline::invCube(above * above, c), 1.0, 2e-3);
+    }
+    const float far = 1.5f * h;
+    CHECK_NEAR(Spline::invCube(far * far, c) * far * far * far, 1.0, 1e-5);
+    CHECK(std::isfinite(Spline::invCube(0.0f, c)) && Spline::invCube(0.0f, c) > 0.0f);
+}
+
+static void rejectsMissingLength() {
+    SolverConfig config;
+    config.softening = "plummer";
+    DirectKernels::Softening softening;
+    CHECK(!solverSoftening(config, softening));
+    CHECK(createForceSolver(config) == nullptr);
+    config.softeningLength = 5.0f;
+    CHECK(solverSoftening(config, softening) && softening.law == SofteningLaw::Plummer && softening.length == 5.0f);
+    config.softening = "gaussian";
+    CHECK(!solverSoftening(config, softening));
+}
+
+int main() {
+    forceIsSlopeOfPotential();
+    splineJoinsNewton();
+    rejectsMissingLength();
+    return TEST_RESULT();
+}
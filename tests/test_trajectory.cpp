@@ -0,0 +1,77 @@
+#include "PhysicsWorld.hpp"
+#include "TestSupport.hpp"
+#include "Trajectory.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Frames read back carry the recorded steps, times and body counts, with
+// positions within the 16-bit quantization of their chunk's box, also
+// across a change of body count in the middle of a chunk.
+static void replayMatchesRecording() {
+    PhysicsWorld world(1);
+    TestSupport::plummer(300, 6, world.bodies);
+    const std::string path = "test_trajectory.bin";
+    TrajectoryRecorder recorder;
+    CHECK(recorder.open(path, 2));
+
+    std::vector<TrajectoryFrame> expected;
+    float extent = 0.0f;
+    for (int f = 0; f < 150; ++f) {
+        if (f == 100) world.bodies.swapRemove(17);
+        world.step();
+        world.step();
+        recorder.record(world.bodies, world.stepCount, world.simulationTime);
+        TrajectoryFrame frame;
+        frame.step = world.stepCount;
+        frame.time = world.simulationTime;
+        frame.x.assign(world.bodies.x.begin(), world.bodies.x.end());
+        frame.y.assign(world.bodies.y.begin(), world.bodies.y.end());
+        frame.z.assign(world.bodies.z.begin(), world.bodies.z.end());
+        for (const std::vector<float>* axis : { &frame.x, &frame.y, &frame.z }) {
+            auto range = std::minmax_element(axis->begin(), axis->end());
+            extent = std::max(extent, *range.second - *range.first);
+        }
+        expected.push_back(frame);
+    }
+    CHECK(recorder.close());
+    CHECK(recorder.droppedFrames() == 0);
+
+    TrajectoryReader reader;
+    CHECK(reader.open(path));
+    CHECK(reader.stepStride() == 2);
+    CHECK(reader.frameCount() == expected.size());
+    const float tolerance = extent / 131070.0f * 1.01f;
+    bool steps = true, counts = true, close = true;
+    std::vector<float> x, y, z;
+    for (size_t f = 0; f < reader.frameCount() && f < expected.size(); ++f) {
+        const TrajectoryFrame& frame = expected[f];
+        steps = steps && reader.step(f) == frame.step && reader.time(f) == frame.time;
+        counts = counts && reader.bodyCount(f) == frame.x.size();
+        reader.positions(f, x, y, z);
+        for (size_t i = 0; close && i < x.size() && i < frame.x.size(); ++i) {
+            close = std::fabs(x[i] - frame.x[i]) <= tolerance && std::fabs(y[i] - frame.y[i]) <= tolerance &&
+                    std::fabs(z[i] - frame.z[i]) <= tolerance;
+        }
+    }
+    CHECK(steps);
+    CHECK(counts);
+    CHECK(close);
+    reader.close();
+    std::remove(path.c_str());
+}
+
+static void rejectsMissingFile() {
+    TrajectoryReader reader;
+    CHECK(!reader.open("test_trajectory_missing.bin"));
+    CHECK(reader.frameCount() == 0);
+}
+
+int main() {
+    replayMatchesRecording();
+    rejectsMissingFile();
+    return TEST_RESULT();
+}